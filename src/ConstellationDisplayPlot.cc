@@ -48,6 +48,7 @@
 #include <qwt_legend.h>
 #include <QColor>
 #include <iostream>
+#include <volk/volk.h>
 
 #include "ConstellationDisplayPlot.h"
 
@@ -197,8 +198,8 @@ ConstellationDisplayPlot::replot()
 
 
 void
-ConstellationDisplayPlot::plotNewData(const std::vector<double*> &realDataPoints,
-				      const std::vector<double*> &imagDataPoints,
+ConstellationDisplayPlot::plotNewData(const std::vector<float*> &realDataPoints,
+				      const std::vector<float*> &imagDataPoints,
 				      const int64_t numDataPoints,
 				      const double timeInterval)
 {
@@ -222,16 +223,16 @@ ConstellationDisplayPlot::plotNewData(const std::vector<double*> &realDataPoints
       }
 
       for(int i = 0; i < d_nplots; i++) {
-	memcpy(d_real_data[i], realDataPoints[i], numDataPoints*sizeof(double));
-	memcpy(d_imag_data[i], imagDataPoints[i], numDataPoints*sizeof(double));
+	volk_32f_convert_64f(d_real_data[i], realDataPoints[i], numDataPoints);
+	volk_32f_convert_64f(d_imag_data[i], imagDataPoints[i], numDataPoints);
       }
 
       if(d_autoscale_state) {
 	double bottom=1e20, top=-1e20;
 	for(int n = 0; n < d_nplots; n++) {
 	  for(int64_t point = 0; point < numDataPoints; point++) {
-            double b = std::min(realDataPoints[n][point], imagDataPoints[n][point]);
-            double t = std::max(realDataPoints[n][point], imagDataPoints[n][point]);
+            double b = std::min(d_real_data[n][point], d_imag_data[n][point]);
+            double t = std::max(d_real_data[n][point], d_imag_data[n][point]);
 	    if(b < bottom) {
 	      bottom = b;
 	    }
@@ -250,15 +251,15 @@ ConstellationDisplayPlot::plotNewData(const std::vector<double*> &realDataPoints
 }
 
 void
-ConstellationDisplayPlot::plotNewData(const double* realDataPoints,
-				      const double* imagDataPoints,
+ConstellationDisplayPlot::plotNewData(const float* realDataPoints,
+				      const float* imagDataPoints,
 				      const int64_t numDataPoints,
 				      const double timeInterval)
 {
-  std::vector<double*> vecRealDataPoints;
-  std::vector<double*> vecImagDataPoints;
-  vecRealDataPoints.push_back((double*)realDataPoints);
-  vecImagDataPoints.push_back((double*)imagDataPoints);
+  std::vector<float*> vecRealDataPoints;
+  std::vector<float*> vecImagDataPoints;
+  vecRealDataPoints.push_back((float*)realDataPoints);
+  vecImagDataPoints.push_back((float*)imagDataPoints);
   plotNewData(vecRealDataPoints, vecImagDataPoints,
 	      numDataPoints, timeInterval);
 }
@@ -267,8 +268,8 @@ void
 ConstellationDisplayPlot::newData(const QEvent* updateEvent)
 {
   ConstUpdateEvent *tevent = (ConstUpdateEvent*)updateEvent;
-  const std::vector<double*> realDataPoints = tevent->getRealPoints();
-  const std::vector<double*> imagDataPoints = tevent->getImagPoints();
+  const std::vector<float*> &realDataPoints = tevent->getRealPoints();
+  const std::vector<float*> &imagDataPoints = tevent->getImagPoints();
   const uint64_t numDataPoints = tevent->getNumDataPoints();
 
   this->plotNewData(realDataPoints,
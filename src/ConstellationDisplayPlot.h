@@ -62,14 +62,14 @@ public:
   ConstellationDisplayPlot(int nplots, QWidget*);
   virtual ~ConstellationDisplayPlot();
 
-  void plotNewData(const std::vector<double*> &realDataPoints,
-		   const std::vector<double*> &imagDataPoints,
+  void plotNewData(const std::vector<float*> &realDataPoints,
+		   const std::vector<float*> &imagDataPoints,
 		   const int64_t numDataPoints,
 		   const double timeInterval);
 
   // Old method to be removed
-  void plotNewData(const double* realDataPoints,
-		   const double* imagDataPoints,
+  void plotNewData(const float* realDataPoints,
+		   const float* imagDataPoints,
 		   const int64_t numDataPoints,
 		   const double timeInterval);
 
@@ -31,9 +31,15 @@
 #include <QStack>
 #include <qwt_symbol.h>
 #include <boost/make_shared.hpp>
+#include <volk/volk.h>
+
+#include <algorithm>
 
 #define ERROR_VALUE -10000000
 
+/* Bins that are averaged and converted to the magnitude type in one go */
+#define MAGNITUDE_BLOCK_BINS 2048
+
 using namespace adiscope;
 
 class FftDisplayZoomer: public LimitedPlotZoomer
@@ -626,7 +632,7 @@ int64_t FftDisplayPlot::getNumPoints()
     return d_numPoints;
 }
 
-void FftDisplayPlot::plotData(const std::vector<double *> &pts,
+void FftDisplayPlot::plotData(const std::vector<float *> &pts,
 		uint64_t num_points)
 {
 	uint64_t halfNumPoints = num_points / 2;
@@ -699,10 +705,11 @@ void FftDisplayPlot::plotData(const std::vector<double *> &pts,
 		}
 	}
 
-	// We store the received data before touching it
+	// We store the received data before touching it. This is where
+	// the float samples get widened, since averaging needs doubles
 	for (unsigned int i = 0; i < d_nplots; i++) {
-		memcpy(y_original_data[i], pts[i],
-				halfNumPoints * sizeof(double));
+		volk_32f_convert_64f(y_original_data[i], pts[i],
+				halfNumPoints);
 	}
 
 	// When the magnitude type changes, we reset the data that is
@@ -761,93 +768,52 @@ void FftDisplayPlot::plotData(const std::vector<double *> &pts,
 void FftDisplayPlot::averageDataAndComputeMagnitude(std::vector<double *>
 	in_data, std::vector<double *> out_data, uint64_t nb_points)
 {
-	std::vector<double *> source;
-
 	if (d_buffer_idx == 0) {
 		d_ps_avg.resize(d_nplots);
 	}
 	for (unsigned int i = 0; i < d_nplots; i++) {
-		bool needs_dB_avg = false;
-
 		d_current_avg_index[i] += 1;
 		if (averageHistory(i) > 0) {
 			d_current_avg_index[i] %= averageHistory(i);
 		}
 		Q_EMIT currentAverageIndex(i, d_current_avg_index[i]);
 
+		const average_sptr &avg = d_ch_avg_obj[i];
+		bool needs_dB_avg = false;
+
 		switch (d_ch_average_type[i]) {
 		case LINEAR_DB:
 		case EXPONENTIAL_DB:
 			needs_dB_avg = true;
-		case SAMPLE:
-			source = in_data;
 			break;
-		default: // For all the other averaging types do the averaging
-			// before converting to dB
-			d_ch_avg_obj[i]->pushNewData(in_data[i]);
-			d_ch_avg_obj[i]->getAverage(out_data[i], nb_points);
-			source = out_data;
+		default:
 			break;
 		}
 
-
 		if (d_buffer_idx == 0) {
 			d_ps_avg[i].resize(nb_points);
 		}
-		for (int s = 0; s < nb_points; s++) {
-			//dB Full-Scale
-			switch (d_magType) {
-			case DBFS:
-				out_data[i][s] = 10 * log10((source[i][s] /
-					(2048 * 2048)) /
-					(nb_points * nb_points));
-				break;
-			case DBV:
-				out_data[i][s] = 10 * log10(source[i][s]) +
-					20 * log10(y_scale_factor[i]) -
-					20 * log10(nb_points) -
-					20 * log10(sqrt(2));
-				break;
-			case DBU:
-				out_data[i][s] = 10 * log10(source[i][s]) +
-					20 * log10(y_scale_factor[i]) -
-					20 * log10(nb_points) -
-					20 * log10(sqrt(2) * 0.77459667);
-				break;
-			case VPEAK:
-				out_data[i][s] = sqrt(source[i][s]) *
-					y_scale_factor[i] / nb_points;
-				break;
-			case VRMS:
-				/* Another formula for this would be
-				 * sqrt(2 * (sqrt(source[i][s]) * sqrt(source[i][s])) /
-				 * (d_win_coefficient_sum * d_win_coefficient_sum));
-				 * This are equivalent (the only difference is the moment
-				 * when we apply the window compensation (before the FFT, or after.
-				 * With the current version, this is applied before (in calcCoherentPowerGain)
-				 */
-				out_data[i][s] = sqrt(source[i][s]) *
-					y_scale_factor[i] / sqrt(2) / nb_points;
-				break;
-			case VROOTHZ:
-				auto ps_rms = sqrt(source[i][s]) * y_scale_factor[i] /  sqrt(2) / nb_points;
-				d_ps_avg[i][s] = sqrt((d_ps_avg[i][s] * d_ps_avg[i][s]) + (ps_rms * ps_rms));
-
-				if (d_buffer_idx == (d_nb_overlapping_avg - 1)) {
-					d_ps_avg[i][s] = d_ps_avg[i][s] / sqrt(d_nb_overlapping_avg);
-					auto ls_rms = d_ps_avg[i][s];
-					auto enbw = d_sampl_rate * d_win_coefficient_sum_sqr[i] /
-							(d_win_coefficient_sum[i] * d_win_coefficient_sum[i]);
-					auto ls_d_rms = ls_rms / sqrt(enbw);
-					out_data[i][s] = ls_d_rms;
-				}
-				break;
-			};
-		}
 
-		if (needs_dB_avg) {
-			d_ch_avg_obj[i]->pushNewData(out_data[i]);
-			d_ch_avg_obj[i]->getAverage(out_data[i], nb_points);
+		// The bins are averaged and converted a block at a time, so
+		// the second step finds them still in cache. The dB averages
+		// work on the converted values, all the others come before
+		// the conversion.
+		for (uint64_t first = 0; first < nb_points; first += MAGNITUDE_BLOCK_BINS) {
+			const uint64_t count = std::min<uint64_t>(nb_points - first,
+				MAGNITUDE_BLOCK_BINS);
+			const double *in = in_data[i] + first;
+			double *out = out_data[i] + first;
+
+			if (avg && !needs_dB_avg) {
+				avg->pushNewData(in, out, first, count);
+				in = out;
+			}
+
+			computeMagnitude(i, in, out, first, count, nb_points);
+
+			if (avg && needs_dB_avg) {
+				avg->pushNewData(out, out, first, count);
+			}
 		}
 	}
 	if (d_buffer_idx == (d_nb_overlapping_avg - 1)) {
@@ -858,6 +824,21 @@ void FftDisplayPlot::averageDataAndComputeMagnitude(std::vector<double *>
 	}
 }
 
+void FftDisplayPlot::computeMagnitude(unsigned int i, const double *in,
+	double *out, uint64_t first, uint64_t count, uint64_t nb_points)
+{
+	SpectrumMagnitude magnitude(static_cast<SpectrumMagnitude::Type>(d_magType),
+		nb_points, y_scale_factor[i]);
+
+	if (d_magType == VROOTHZ) {
+		magnitude.setDensity(d_sampl_rate, d_win_coefficient_sum[i],
+			d_win_coefficient_sum_sqr[i]);
+	}
+
+	magnitude.convert(in, out, count, d_ps_avg[i].data() + first,
+		d_buffer_idx, d_nb_overlapping_avg);
+}
+
 void FftDisplayPlot::_resetXAxisPoints()
 {
 	double fft_bin_size = (d_stop_frequency - d_start_frequency)
@@ -1082,9 +1063,6 @@ void FftDisplayPlot::findPeaks(int chn)
 {
 	QList<std::shared_ptr<struct marker_data>>& markers = d_peaks[chn];
 	QList<std::shared_ptr<struct marker_data>>& f_sort_mrks = d_freq_asc_sorted_peaks[chn];
-	int marker_count = markers.size();
-	int maxX[marker_count + 1];
-	float maxY[marker_count + 1];
 	double *x = nullptr;
 	double *y = nullptr;
 	unsigned int num_points = 0;
@@ -1102,15 +1080,8 @@ void FftDisplayPlot::findPeaks(int chn)
 		return;
 	}
 
-	for (int i = 0; i <= marker_count; i++) {
-		maxX[i] = 0;
-		maxY[i] = -200.0;
-	}
-
-	maxY[0] = y[0];
-
-	auto start = 3;
-	auto stop = num_points;
+	size_t start = 3;
+	size_t stop = num_points;
 
 	if(m_visiblePeakSearch)
 	{
@@ -1118,44 +1089,32 @@ void FftDisplayPlot::findPeaks(int chn)
 		if (m_sweepStart * coef > 0) {
 			start = m_sweepStart * coef;
 		}
-		stop = m_sweepStop * coef;
-		maxY[0] = y[start];
+		stop = std::max(m_sweepStop * coef, 0.0);
 	}
 
-	for (int i = start; i < stop; i++) {
-		for (int j = 0; j < marker_count; j++ ) {
-			if (i < 2) {
-				continue;
-			}
-			if  ((y[i - 1] > maxY[j]) &&
-					((!((y[i - 2] > y[i - 1]) &&
-					 (y[i - 1] > y[i]))) &&
-					 (!((y[i - 2] < y[i - 1]) &&
-					 (y[i - 1] < y[i]))))) {
-
-				for (int k = marker_count; k > j; k--) {
-					maxY[k] = maxY[k - 1];
-					maxX[k] = maxX[k - 1];
-				}
-				maxY[j] = y[i - 1];
-				maxX[j] = i - 1;
-				break;
-			}
+	const std::vector<Peak> &peaks = d_peakFinder.find(y, num_points,
+		start, stop, markers.size());
+
+	// Markers left without a peak repeat the lowest one found, so both
+	// lists stay sorted
+	for (int i = 0; i < markers.size(); i++) {
+		size_t bin = 0;
+
+		if (!peaks.empty()) {
+			bin = peaks[std::min<size_t>(i, peaks.size() - 1)].bin;
 		}
-	}
 
-	for (int i = 0; i < marker_count; i++) {
-		markers[i]->x = x[maxX[i]];
-		markers[i]->y = y[maxX[i]];
-		markers[i]->bin = maxX[i];
+		markers[i]->x = x[bin];
+		markers[i]->y = y[bin];
+		markers[i]->bin = bin;
 	}
 
 	for (int i = 0; i < markers.size(); i++) {
 		f_sort_mrks[i] = markers[i];
 	}
 	std::sort(f_sort_mrks.begin(), f_sort_mrks.end(),
-		[](const std::shared_ptr<struct marker_data> m1,
-			const std::shared_ptr<struct marker_data> m2) -> bool
+		[](const std::shared_ptr<struct marker_data> &m1,
+			const std::shared_ptr<struct marker_data> &m2) -> bool
 			{
 				return m1->x < m2->x;
 			});
@@ -1235,7 +1194,7 @@ void FftDisplayPlot::remove_marker(int chn, int which)
 }
 
 void FftDisplayPlot::marker_set_pos_source(uint chIdx, uint mkIdx,
-			std::shared_ptr<struct marker_data> &source_sptr)
+			const std::shared_ptr<struct marker_data> &source_sptr)
 {
 	d_markers[chIdx][mkIdx].data = source_sptr;
 	if (d_emitNewMkrData)
@@ -1294,6 +1253,26 @@ void FftDisplayPlot::setPeakCount(uint chIdx, uint count)
 	}
 }
 
+double FftDisplayPlot::peakThreshold() const
+{
+	return d_peakFinder.threshold();
+}
+
+void FftDisplayPlot::setPeakThreshold(double threshold)
+{
+	d_peakFinder.setThreshold(threshold);
+}
+
+uint FftDisplayPlot::peakMinSeparation() const
+{
+	return d_peakFinder.minSeparation();
+}
+
+void FftDisplayPlot::setPeakMinSeparation(uint bins)
+{
+	d_peakFinder.setMinSeparation(bins);
+}
+
 uint FftDisplayPlot::markerCount(uint chIdx) const
 {
 	return d_markers[chIdx].size();
@@ -1486,62 +1465,54 @@ void FftDisplayPlot::marker_to_max_peak(uint chIdx, uint mkIdx)
 
 void FftDisplayPlot::marker_to_next_higher_freq_peak(uint chIdx, uint mkIdx)
 {
-	auto peaks = d_freq_asc_sorted_peaks[chIdx];
+	const auto &peaks = d_freq_asc_sorted_peaks[chIdx];
 	double freq = d_markers[chIdx][mkIdx].ui->value().x();
-	int pos = -1;
 
 	// find the first peak with the freq higher that marker freq pos
-	for (int i = 0; i < peaks.size(); i++) {
-		if (peaks[i]->x > freq) {
-			pos = i;
-			break;
-		}
-	}
+	auto it = std::upper_bound(peaks.begin(), peaks.end(), freq,
+		[](double f, const std::shared_ptr<struct marker_data> &peak) {
+			return f < peak->x;
+		});
 
-	if (pos < 0)
+	if (it == peaks.end())
 		return;
 
-	marker_set_pos_source(chIdx, mkIdx, peaks[pos]);
+	marker_set_pos_source(chIdx, mkIdx, *it);
 }
 
 void FftDisplayPlot::marker_to_next_lower_freq_peak(uint chIdx, uint mkIdx)
 {
-	auto peaks = d_freq_asc_sorted_peaks[chIdx];
+	const auto &peaks = d_freq_asc_sorted_peaks[chIdx];
 	double freq = d_markers[chIdx][mkIdx].ui->value().x();
-	int pos = -1;
 
-	// find the first peak with the freq lower that marker freq pos
-	for (int i = peaks.size() - 1; i >= 0; i--) {
-		if (peaks[i]->x < freq) {
-			pos = i;
-			break;
-		}
-	}
+	// find the last peak with the freq lower that marker freq pos
+	auto it = std::lower_bound(peaks.begin(), peaks.end(), freq,
+		[](const std::shared_ptr<struct marker_data> &peak, double f) {
+			return peak->x < f;
+		});
 
-	if (pos < 0)
+	if (it == peaks.begin())
 		return;
 
-	marker_set_pos_source(chIdx, mkIdx, peaks[pos]);
+	marker_set_pos_source(chIdx, mkIdx, *(it - 1));
 }
 
 void FftDisplayPlot::marker_to_next_higher_mag_peak(uint chIdx, uint mkIdx)
 {
-	auto peaks = d_peaks[chIdx];
+	const auto &peaks = d_peaks[chIdx];
 	double mag = d_markers[chIdx][mkIdx].ui->value().y();
-	int pos = -1;
 
-	// find the first peak with the magnitude higher than the current marker
-	for (int i = peaks.size() - 1; i >= 0; i--) {
-		if (peaks[i]->y > mag) {
-			pos = i;
-			break;
-		}
-	}
+	// find the last peak with the magnitude higher than the current
+	// marker; the peaks are sorted from the highest down
+	auto it = std::partition_point(peaks.begin(), peaks.end(),
+		[mag](const std::shared_ptr<struct marker_data> &peak) {
+			return peak->y > mag;
+		});
 
-	if (pos < 0)
+	if (it == peaks.begin())
 		return;
 
-	marker_set_pos_source(chIdx, mkIdx, peaks[pos]);
+	marker_set_pos_source(chIdx, mkIdx, *(it - 1));
 }
 
 void FftDisplayPlot::setStartStop(double start, double stop)
@@ -1560,22 +1531,19 @@ void FftDisplayPlot::setVisiblePeakSearch(bool enabled)
 
 void FftDisplayPlot::marker_to_next_lower_mag_peak(uint chIdx, uint mkIdx)
 {
-	auto peaks = d_peaks[chIdx];
+	const auto &peaks = d_peaks[chIdx];
 	double mag = d_markers[chIdx][mkIdx].ui->value().y();
-	int pos = -1;
 
 	// find the first peak with the magnitude lower than the current marker
-	for (int i = 0; i < peaks.size(); i++) {
-		if (peaks[i]->y < mag) {
-			pos = i;
-			break;
-		}
-	}
+	auto it = std::partition_point(peaks.begin(), peaks.end(),
+		[mag](const std::shared_ptr<struct marker_data> &peak) {
+			return peak->y >= mag;
+		});
 
-	if (pos < 0)
+	if (it == peaks.end())
 		return;
 
-	marker_set_pos_source(chIdx, mkIdx, peaks[pos]);
+	marker_set_pos_source(chIdx, mkIdx, *it);
 }
 
 int FftDisplayPlot::getMarkerPos(const QList<marker>& marker_list,
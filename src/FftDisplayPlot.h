@@ -27,6 +27,8 @@
 #include "plot_line_handle.h"
 #include "handles_area.hpp"
 #include "gui/cursor_readouts.h"
+#include "peak_finder.h"
+#include "spectrum_magnitude.h"
 #include <boost/shared_ptr.hpp>
 
 namespace adiscope {
@@ -71,12 +73,12 @@ namespace adiscope {
 		};
 
 		enum MagnitudeType {
-			DBFS = 0,
-			DBV = 1,
-			DBU = 2,
-			VPEAK = 3,
-			VRMS = 4,
-			VROOTHZ = 5
+			DBFS = SpectrumMagnitude::DBFS,
+			DBV = SpectrumMagnitude::DBV,
+			DBU = SpectrumMagnitude::DBU,
+			VPEAK = SpectrumMagnitude::VPEAK,
+			VRMS = SpectrumMagnitude::VRMS,
+			VROOTHZ = SpectrumMagnitude::VROOTHZ
 		};
 
 		enum MarkerType {
@@ -126,6 +128,7 @@ namespace adiscope {
 
 		QList<QList<std::shared_ptr<struct marker_data>>> d_peaks;
 		QList<QList<std::shared_ptr<struct marker_data>>> d_freq_asc_sorted_peaks;
+		PeakFinder d_peakFinder;
 		bool d_emitNewMkrData;
 
 		QList<QColor> d_markerColors;
@@ -144,7 +147,7 @@ namespace adiscope {
 		void setupReadouts();
 		void updateHandleAreaPadding();
 
-		void plotData(const std::vector<double *> &pts,
+		void plotData(const std::vector<float *> &pts,
 				uint64_t num_points);
 		void _resetXAxisPoints();
 
@@ -152,13 +155,16 @@ namespace adiscope {
 		void averageDataAndComputeMagnitude(std::vector<double *>
 			in_data, std::vector<double *> out_data,
 			uint64_t nb_points);
+		void computeMagnitude(unsigned int ch, const double *in,
+			double *out, uint64_t first, uint64_t count,
+			uint64_t nb_points);
 		average_sptr getNewAvgObject(enum AverageType avg_type,
 			uint data_width, uint history, bool history_en);
 
 		void add_marker(int chn);
 		void remove_marker(int chn, int which);
 		void marker_set_pos_source(uint chIdx, uint mkIdx,
-			std::shared_ptr<struct marker_data> &source_sptr);
+			const std::shared_ptr<struct marker_data> &source_sptr);
 		void findPeaks(int chn);
 		void calculate_fixed_markers(int chn);
 		int getMarkerPos(const QList<marker>& marker_list,
@@ -215,6 +221,10 @@ namespace adiscope {
 		// Markers
 		uint peakCount(uint chIdx) const;
 		void setPeakCount(uint chIdx, uint count);
+		double peakThreshold() const;
+		void setPeakThreshold(double threshold);
+		uint peakMinSeparation() const;
+		void setPeakMinSeparation(uint bins);
 
 		uint markerCount(uint chIdx) const;
 		void setMarkerCount(uint chIdx, uint count);
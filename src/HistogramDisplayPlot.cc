@@ -470,7 +470,7 @@ HistogramDisplayPlot::replot()
 }
 
 void
-HistogramDisplayPlot::plotNewData(const std::vector<double*> dataPoints,
+HistogramDisplayPlot::plotNewData(const std::vector<float*> &dataPoints,
 				   const int64_t numDataPoints,
 				   const double timeInterval)
 {
@@ -493,8 +493,8 @@ HistogramDisplayPlot::plotNewData(const std::vector<double*> dataPoints,
       double xminTemp = 1e20;
       double xmaxTemp = -1e20;
       for(int n = 0; n < d_nplots; n++) {
-	xminTemp = std::min(xminTemp, *std::min_element(dataPoints[n] + d_minPos, dataPoints[n]+d_maxPos));
-	xmaxTemp = std::max(xmaxTemp, *std::max_element(dataPoints[n] + d_minPos, dataPoints[n]+d_maxPos));
+	xminTemp = std::min(xminTemp, (double)*std::min_element(dataPoints[n] + d_minPos, dataPoints[n]+d_maxPos));
+	xmaxTemp = std::max(xmaxTemp, (double)*std::max_element(dataPoints[n] + d_minPos, dataPoints[n]+d_maxPos));
       }
 
       const double EPS = 0.1;
@@ -577,7 +577,7 @@ void
 HistogramDisplayPlot::newData(const QEvent* updateEvent)
 {
   HistogramUpdateEvent *hevent = (HistogramUpdateEvent*)updateEvent;
-  const std::vector<double*> dataPoints = hevent->getDataPoints();
+  const std::vector<float*> &dataPoints = hevent->getDataPoints();
   const uint64_t numDataPoints = hevent->getNumDataPoints();
 
   plotNewData(dataPoints,
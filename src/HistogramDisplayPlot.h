@@ -91,7 +91,7 @@ public:
   HistogramDisplayPlot(int nplots, QWidget*);
   virtual ~HistogramDisplayPlot();
 
-  void plotNewData(const std::vector<double*> dataPoints,
+  void plotNewData(const std::vector<float*> &dataPoints,
 		   const int64_t numDataPoints, const double timeInterval);
 
   void replot();
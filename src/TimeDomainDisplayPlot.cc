@@ -54,6 +54,7 @@
 #include "osc_scale_engine.h"
 
 #include "smoothcurvefitter.h"
+#include "lod_plot_curve.h"
 
 using namespace adiscope;
 
@@ -283,6 +284,69 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
 				   const int64_t numDataPoints,
 				   const double timeInterval,
 				   const std::vector< std::vector<gr::tag_t> > &tags)
+{
+  _plotNewData(sender, &dataPoints, adiscope::SampleFrame<float>::sptr(),
+	       numDataPoints, timeInterval, tags);
+}
+
+void
+TimeDomainDisplayPlot::plotNewData(const std::string &sender,
+				   const adiscope::SampleFrame<float>::sptr &frame,
+				   const double timeInterval,
+				   const std::vector< std::vector<gr::tag_t> > &tags)
+{
+  _plotNewData(sender, nullptr, frame, frame->numPoints(), timeInterval,
+	       tags);
+}
+
+void
+TimeDomainDisplayPlot::_releaseYData(int idx)
+{
+  if(d_ydata_frames[idx]) {
+    d_ydata_frames[idx].reset();
+    d_ydata_f[idx] = nullptr;
+  }
+  else {
+    delete[] d_ydata[idx];
+    d_ydata[idx] = nullptr;
+  }
+}
+
+void
+TimeDomainDisplayPlot::_yRange(int idx, int64_t numPoints,
+			       double &bottom, double &top) const
+{
+  if(d_ydata_f[idx]) {
+    const float *data = d_ydata_f[idx];
+    for(int64_t point = 0; point < numPoints; point++) {
+      if(data[point] < bottom) {
+	bottom = data[point];
+      }
+      if(data[point] > top) {
+	top = data[point];
+      }
+    }
+  }
+  else {
+    const double *data = d_ydata[idx];
+    for(int64_t point = 0; point < numPoints; point++) {
+      if(data[point] < bottom) {
+	bottom = data[point];
+      }
+      if(data[point] > top) {
+	top = data[point];
+      }
+    }
+  }
+}
+
+void
+TimeDomainDisplayPlot::_plotNewData(const std::string &sender,
+				    const std::vector<double*> *dataPoints,
+				    const adiscope::SampleFrame<float>::sptr &frame,
+				    const int64_t numDataPoints,
+				    const double timeInterval,
+				    const std::vector< std::vector<gr::tag_t> > &tags)
 {
   int sinkIndex = d_sinkManager.indexOfSink(sender);
 
@@ -293,6 +357,8 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
       unsigned int sinkNumChannels = sink->numChannels();
       unsigned long long sinkNumPoints = sink->channelsDataLength();
       bool reset_x_axis_points = d_sink_reset_x_axis_pts[sinkIndex];
+      int ref_offset = countReferenceWaveform(start);
+      bool in_place = frame && !d_semilogy;
 
       if(numDataPoints != sinkNumPoints){
 	sinkNumPoints = numDataPoints;
@@ -301,12 +367,12 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
 	delete[] d_xdata[sinkIndex];
 	d_xdata[sinkIndex] = new double[numDataPoints];
 
-	int ref_offset = countReferenceWaveform(start);
 	for(int i = start; i < start + sinkNumChannels; i++) {
-	  delete[] d_ydata[i];
-	  d_ydata[i] = new double[numDataPoints];
-
-	  d_plot_curve[i + ref_offset]->setRawSamples(d_xdata[sinkIndex], d_ydata[i], numDataPoints);
+	  _releaseYData(i);
+	  if(!in_place) {
+	    d_ydata[i] = new double[numDataPoints];
+	    d_plot_curve[i + ref_offset]->setRawSamples(d_xdata[sinkIndex], d_ydata[i], numDataPoints);
+	  }
 	}
 
 	_resetXAxisPoints(d_xdata[sinkIndex], numDataPoints, d_sample_rate);
@@ -316,12 +382,39 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
       }
 
       for(int i = 0; i < sinkNumChannels; i++) {
-	if(d_semilogy) {
+	int idx = start + i;
+
+	if(in_place) {
+	  // Draw the float samples of the frame as they are and keep
+	  // the frame alive; the previous one goes back to its pool
+	  // once nobody else uses it
+	  _releaseYData(idx);
+	  d_ydata_f[idx] = frame->channel(i);
+	  d_ydata_frames[idx] = frame;
+	  d_plot_curve[idx + ref_offset]->setSamples(
+		new adiscope::FloatSeriesData(d_xdata[sinkIndex],
+					      d_ydata_f[idx],
+					      numDataPoints));
+	  continue;
+	}
+
+	if(!d_ydata[idx]) {
+	  _releaseYData(idx);
+	  d_ydata[idx] = new double[numDataPoints];
+	  d_plot_curve[idx + ref_offset]->setRawSamples(d_xdata[sinkIndex], d_ydata[idx], numDataPoints);
+	}
+
+	if(frame) {
+	  const float *in = frame->channel(i);
+	  for(int n = 0; n < numDataPoints; n++)
+	    d_ydata[idx][n] = fabs(in[n]);
+	}
+	else if(d_semilogy) {
 	  for(int n = 0; n < numDataPoints; n++)
-	    d_ydata[start + i][n] = fabs(dataPoints[i][n]);
+	    d_ydata[idx][n] = fabs((*dataPoints)[i][n]);
 	}
 	else {
-	  memcpy(d_ydata[start + i], dataPoints[i], numDataPoints*sizeof(double));
+	  memcpy(d_ydata[idx], (*dataPoints)[i], numDataPoints*sizeof(double));
 	}
       }
 
@@ -464,14 +557,7 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
 	double bottom=1e20, top=-1e20;
 	for(int n = 0; n < d_nplots; n++) {
 	  if(d_plot_curve[n]->plot()) {
-	    for(int64_t point = 0; point < numDataPoints; point++) {
-	      if(d_ydata[n][point] < bottom) {
-		bottom = d_ydata[n][point];
-	      }
-	      if(d_ydata[n][point] > top) {
-		top = d_ydata[n][point];
-	      }
-	    }
+	    _yRange(n, numDataPoints, bottom, top);
 	  }
 	}
 	_autoScale(bottom, top);
@@ -492,7 +578,6 @@ TimeDomainDisplayPlot::plotNewData(const std::string &sender,
 void TimeDomainDisplayPlot::newData(const QEvent* updateEvent)
 {
 	IdentifiableTimeUpdateEvent *tevent = (IdentifiableTimeUpdateEvent*)updateEvent;
-	const std::vector<double*> dataPoints = tevent->getTimeDomainPoints();
 	const uint64_t numDataPoints = tevent->getNumTimeDomainDataPoints();
 	const std::vector< std::vector<gr::tag_t> > tags = tevent->getTags();
 	const std::string sender = tevent->senderName();
@@ -503,8 +588,7 @@ void TimeDomainDisplayPlot::newData(const QEvent* updateEvent)
 	}
 
 	this->plotNewData(sender,
-			dataPoints,
-			numDataPoints,
+			tevent->getFrame(),
 			0,
 			tags);
 }
@@ -665,14 +749,7 @@ void TimeDomainDisplayPlot::setAutoScale(bool state)
     double bottom=1e20, top=-1e20;
     for(int n = 0; n < d_nplots; n++) {
       if(d_plot_curve[n]->plot()) {
-	for(int64_t point = 0; point < Curve(n)->data()->size(); point++) {
-	  if(d_ydata[n][point] < bottom) {
-	    bottom = d_ydata[n][point];
-	  }
-	  if(d_ydata[n][point] > top) {
-	    top = d_ydata[n][point];
-	  }
-	}
+	_yRange(n, Curve(n)->data()->size(), bottom, top);
       }
     }
     _autoScale(bottom, top);
@@ -1023,6 +1100,11 @@ bool TimeDomainDisplayPlot::isMathWaveform(QwtPlotCurve *curve) const
 	return d_math_curves.values().contains(curve);
 }
 
+const adiscope::SampleFrame<float>::sptr &TimeDomainDisplayPlot::ydataFrame(int idx) const
+{
+	return d_ydata_frames[idx];
+}
+
 
 int TimeDomainDisplayPlot::getCurveNextTo(int pos)
 {
@@ -1283,11 +1365,13 @@ bool TimeDomainDisplayPlot::registerSink(std::string sinkUniqueNme, unsigned int
 		for (size_t i = 0; i < numChannels; i++) {
 			int n = i + numCurves;
 			d_ydata.push_back(new double[channelsDataLength]);
+			d_ydata_f.push_back(nullptr);
+			d_ydata_frames.push_back(adiscope::SampleFrame<float>::sptr());
 			memset(d_ydata[n], 0x0, channelsDataLength * sizeof(double));
 
 			QColor color = getChannelColor();
 
-			QwtPlotCurve *curve = new QwtPlotCurve(QString("Data %1").arg(n));
+			QwtPlotCurve *curve = new LodPlotCurve(QString("Data %1").arg(n));
 			curve->setPen(QPen(color));
 			curve->setRenderHint(QwtPlotItem::RenderAntialiased);
 			d_plot_curve.push_back(curve);
@@ -1346,9 +1430,13 @@ bool TimeDomainDisplayPlot::unregisterSink(std::string sinkName)
 		int numChannels = d_sinkManager.sink(sinkIndex)->numChannels();
 		for (int i = offset; i < offset + numChannels; i++) {
 			cleanUpJustBeforeChannelRemoval(offset);
-			delete [] d_ydata[i];
+			_releaseYData(i);
 		}
 		d_ydata.erase(d_ydata.begin() + offset, d_ydata.begin() + offset + numChannels);
+		d_ydata_frames.erase(d_ydata_frames.begin() + offset,
+				     d_ydata_frames.begin() + offset + numChannels);
+		d_ydata_f.erase(d_ydata_f.begin() + offset,
+				d_ydata_f.begin() + offset + numChannels);
 
 		/* Remove the QwtPlotCurve */
 		int ref_offset = countReferenceWaveform(offset);
@@ -1429,6 +1517,29 @@ long TimeDomainDisplayPlot::dataStartingPoint() const
 	return d_data_starting_point;
 }
 
+adiscope::SampleFrame<float>::sptr TimeDomainDisplayPlot::curveFrame(const QwtPlotCurve *curve) const
+{
+	auto data = dynamic_cast<const adiscope::FloatSeriesData *>(curve->data());
+
+	if (data) {
+		for (size_t i = 0; i < d_ydata_f.size(); i++) {
+			if (d_ydata_f[i] && d_ydata_f[i] == data->yData()) {
+				return d_ydata_frames[i];
+			}
+		}
+	}
+
+	return adiscope::SampleFrame<float>::sptr();
+}
+
+void TimeDomainDisplayPlot::timeAxis(const QwtPlotCurve *curve, long &first, double &step) const
+{
+	// Same arithmetic as _resetXAxisPoints; the starting point is the one
+	// the axis was last reset with, which may differ from the current one
+	step = 1.0 / d_sample_rate;
+	first = curve->data()->size() ? std::lround(curve->data()->sample(0).x() / step) : 0;
+}
+
 void TimeDomainDisplayPlot::resetXaxisOnNextReceivedData()
 {
 	for (size_t i = 0; i < d_sink_reset_x_axis_pts.size(); i++)
@@ -49,6 +49,7 @@
 
 #include "DisplayPlot.h"
 #include "spectrumUpdateEvents.h"
+#include "float_series_data.h"
 
 namespace adiscope {
 
@@ -109,6 +110,15 @@ public:
 		   const int64_t numDataPoints, const double timeInterval,
                    const std::vector< std::vector<gr::tag_t> > &tags \
 		   = std::vector< std::vector<gr::tag_t> >());
+
+  /* Plots the frame in place: the curves draw its float samples directly
+   * and keep a reference to it until the next frame of the same sink
+   * arrives, so no copy or conversion of the data is made */
+  void plotNewData(const std::string &sender,
+		   const adiscope::SampleFrame<float>::sptr &frame,
+		   const double timeInterval,
+		   const std::vector< std::vector<gr::tag_t> > &tags \
+		   = std::vector< std::vector<gr::tag_t> >());
   void replot();
 
   void stemPlot(bool en);
@@ -143,6 +153,13 @@ public:
 
   long dataStartingPoint() const;
 
+  /* Frame holding the samples the curve draws, if it draws one in place.
+   * The samples stay valid for as long as the frame is referenced, after
+   * the plot has moved on to newer data too. */
+  adiscope::SampleFrame<float>::sptr curveFrame(const QwtPlotCurve *curve) const;
+  /* The x values of the channel curves are (first + n) * step */
+  void timeAxis(const QwtPlotCurve *curve, long &first, double &step) const;
+
   void addZoomer(unsigned int zoomerIdx);
   void removeZoomer(unsigned int zoomerIdx);
   void setXAxisNumPoints(unsigned int);
@@ -215,6 +232,7 @@ private Q_SLOTS:
 
 protected:
   std::vector<double*> d_ydata;
+  std::vector<const float*> d_ydata_f;
   std::vector<double*> d_xdata;
   std::vector<double*> d_ref_ydata;
   QVector<QVector<double>> d_preview_xdata;
@@ -223,9 +241,18 @@ protected:
   bool isReferenceWaveform(QwtPlotCurve *curve);
   bool isMathWaveform(QwtPlotCurve *curve) const;
   int countReferenceWaveform(int position);
+  // Frame that d_ydata_f[idx] points into, if any
+  const adiscope::SampleFrame<float>::sptr &ydataFrame(int idx) const;
   QVector<QwtPlotCurve *> d_logic_curves;
 
 private:
+  void _plotNewData(const std::string &sender,
+		    const std::vector<double*> *dataPoints,
+		    const adiscope::SampleFrame<float>::sptr &frame,
+		    const int64_t numDataPoints, const double timeInterval,
+		    const std::vector< std::vector<gr::tag_t> > &tags);
+  void _releaseYData(int idx);
+  void _yRange(int idx, int64_t numPoints, double &bottom, double &top) const;
   void _resetXAxisPoints(double*& xAxis, unsigned long long numPoints, double sampleRate);
   void _autoScale(double bottom, double top);
 
@@ -234,6 +261,10 @@ private:
   long d_data_starting_point;
   std::vector<bool> d_sink_reset_x_axis_pts;
 
+  // Frames currently shown by the curves; when set, d_ydata_f[i] points
+  // inside d_ydata_frames[i] and d_ydata[i] is null
+  std::vector<adiscope::SampleFrame<float>::sptr> d_ydata_frames;
+
   bool d_semilogx;
   bool d_semilogy;
   bool d_autoscale_shot;
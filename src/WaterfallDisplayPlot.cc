@@ -132,8 +132,7 @@ WaterfallDisplayPlot::WaterfallDisplayPlot(int nplots, QWidget* parent)
 					, "Spectrogram"));
 
 #else
-		d_spectrogram.push_back(new QwtPlotSpectrogram("Spectrogram"));
-		d_spectrogram[i]->setData(d_data[i]);
+		d_spectrogram.push_back(new WaterfallSpectrogram(d_data[i], "Spectrogram"));
 		d_spectrogram[i]->setDisplayMode(QwtPlotSpectrogram::ImageMode, true);
 		//		d_spectrogram[i]->setColorMap(new ColorMap_MultiColor());
 		d_spectrogram[i]->setColorMap(new ColorMap_DefaultDark());
@@ -417,6 +416,9 @@ void WaterfallDisplayPlot::resetAxis(bool resetData)
 		if (resetData) {
 			d_data[i]->reset();
 		}
+#if QWT_VERSION >= 0x060000
+		d_spectrogram[i]->invalidateImage();
+#endif
 	}
 
 	setAxisScale(QwtAxis::XBottom, d_start_frequency, d_stop_frequency);
@@ -534,7 +536,8 @@ void WaterfallDisplayPlot::setFlowDirection(WaterfallFlowDirection direction)
 {
 	for (unsigned int i = 0; i < d_nplots; ++i) {
 		d_data[i]->setFlowDirection(direction);
-		d_data[i]->reset();
+		d_spectrogram[i]->invalidateCache();
+		d_spectrogram[i]->itemChanged();
 	}
 }
 
@@ -614,6 +617,9 @@ void WaterfallDisplayPlot::plotNewData(const std::vector<double*> dataPoints,
 
 				d_data[i]->addFFTData(&(dataPoints[i][_in_index]), _npoints_in, droppedFrames);
 				d_data[i]->incrementNumLinesToUpdate();
+#if QWT_VERSION >= 0x060000
+				d_spectrogram[i]->updateRows(std::max(droppedFrames, 0) + 1);
+#endif
 				d_spectrogram[i]->invalidateCache();
 				d_spectrogram[i]->itemChanged();
 			}
@@ -707,6 +713,9 @@ void WaterfallDisplayPlot::clearData()
 {
 	for (unsigned int i = 0; i < d_nplots; ++i) {
 		d_data[i]->reset();
+#if QWT_VERSION >= 0x060000
+		d_spectrogram[i]->invalidateImage();
+#endif
 	}
 }
 
@@ -921,6 +930,9 @@ void WaterfallDisplayPlot::_updateIntensityRangeDisplay()
 		plotLayout()->setAlignCanvasToScales(true);
 
 		// Tell the display to redraw everything
+#if QWT_VERSION >= 0x060000
+		d_spectrogram[i]->invalidateImage();
+#endif
 		d_spectrogram[i]->invalidateCache();
 		d_spectrogram[i]->itemChanged();
 	}
@@ -44,6 +44,7 @@
 #include <gnuradio/qtgui/plot_waterfall.h>
 #else
 #include <QwtLinearColorMap>
+#include "waterfall_spectrogram.h"
 #include <qwt_interval.h>
 
 typedef QPointF QwtDoublePoint;
@@ -206,7 +207,7 @@ private:
 #if QWT_VERSION < 0x060000
 	std::vector<PlotWaterfall*> d_spectrogram;
 #else
-	std::vector<QwtPlotSpectrogram*> d_spectrogram;
+	std::vector<WaterfallSpectrogram*> d_spectrogram;
 #endif
 
 	std::vector<int> d_intensity_color_map_type;
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "adc_conversion.hpp"
+
+#include <libm2k/analog/m2kanalogin.hpp>
+
+using namespace adiscope;
+
+AdcConversion::AdcConversion() :
+	m_gain(0.0),
+	m_offset(0.0)
+{
+}
+
+AdcConversion AdcConversion::fromAdc(libm2k::analog::M2kAnalogIn *adc,
+				     unsigned int chn)
+{
+	// Two samples far apart pin down the line with full precision.
+	// Whatever libm2k folds into the conversion ends up in there.
+	const int span = 2048;
+	const double low = adc->convertRawToVolts(chn, -span);
+	const double high = adc->convertRawToVolts(chn, span);
+	AdcConversion conv;
+
+	conv.m_gain = (high - low) / (2 * span);
+	conv.m_offset = adc->convertRawToVolts(chn, 0);
+
+	return conv;
+}
+
+void AdcConversion::toVolts(const float *in, float *out, size_t count) const
+{
+	const double gain = m_gain;
+	const double offset = m_offset;
+
+	for (size_t i = 0; i < count; i++) {
+		out[i] = static_cast<float>(in[i] * gain + offset);
+	}
+}
+
+double AdcConversion::gain() const
+{
+	return m_gain;
+}
+
+double AdcConversion::offset() const
+{
+	return m_offset;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ADC_CONVERSION_HPP
+#define ADC_CONVERSION_HPP
+
+#include <cstddef>
+
+namespace libm2k {
+namespace analog {
+class M2kAnalogIn;
+}
+}
+
+namespace adiscope {
+
+/*
+ * Raw ADC sample to volts, as libm2k's convertRawToVolts works it out.
+ * That conversion is an affine function of the sample (range gain,
+ * calibration gain, filter compensation and hardware offset), so it is
+ * taken from libm2k once as a slope and an intercept and then applied to
+ * whole buffers.
+ */
+class AdcConversion
+{
+public:
+	AdcConversion();
+
+	/* The conversion libm2k currently applies to the channel */
+	static AdcConversion fromAdc(libm2k::analog::M2kAnalogIn *adc,
+				     unsigned int chn);
+
+	/* Computed in double like libm2k does, so that the results match;
+	 * the loop vectorizes */
+	void toVolts(const float *in, float *out, size_t count) const;
+
+	double gain() const;
+	double offset() const;
+
+private:
+	double m_gain;
+	double m_offset;
+};
+}
+
+#endif /* ADC_CONVERSION_HPP */
@@ -39,7 +39,8 @@ adc_sample_conv::adc_sample_conv(int nconnections,
 			gr::io_signature::make(nconnections, nconnections, sizeof(float))),
 	d_nconnections(nconnections),
 	inverse(inverse),
-	m2k_adc(adc)
+	m2k_adc(adc),
+	d_conv(nconnections)
 {
 }
 
@@ -61,12 +62,29 @@ double adc_sample_conv::conversionWrapper(unsigned int chn_idx, double sample, b
 	}
 }
 
+void adc_sample_conv::updateCoefficients(unsigned int nchannels)
+{
+	if (d_conv.size() < nchannels) {
+		d_conv.resize(nchannels);
+	}
+
+	for (unsigned int i = 0; i < nchannels; i++) {
+		d_conv[i] = AdcConversion::fromAdc(m2k_adc, i);
+	}
+}
+
 int adc_sample_conv::work(int noutput_items,
 		gr_vector_const_void_star &input_items,
 		gr_vector_void_star &output_items)
 {
 	gr::thread::scoped_lock lock(d_setlock);
 
+	// The settings may change at any time from the hardware thread; a
+	// few calls per buffer keep up with them instead of one per sample
+	if (!inverse) {
+		updateCoefficients(input_items.size());
+	}
+
 	for (unsigned int i = 0; i < input_items.size(); i++) {
 		const float* in = static_cast<const float *>(input_items[i]);
 		float *out = static_cast<float *>(output_items[i]);
@@ -76,9 +94,7 @@ int adc_sample_conv::work(int noutput_items,
 				out[j] = m2k_adc->convertVoltsToRaw(i, in[j]);
 			}
 		} else {
-
-			for (int j = 0; j < noutput_items; j++)
-				out[j] = m2k_adc->convertRawToVolts(i, in[j]);
+			d_conv[i].toVolts(in, out, noutput_items);
 		}
 	}
 
@@ -22,7 +22,9 @@
 #define ADC_SAMPLE_CONV_HPP
 
 #include <gnuradio/sync_block.h>
+#include "adc_conversion.hpp"
 #include <memory>
+#include <vector>
 namespace libm2k {
 namespace analog {
 class M2kAnalogIn;
@@ -36,6 +38,11 @@ namespace adiscope {
 		bool inverse;
 		libm2k::analog::M2kAnalogIn* m2k_adc;
 
+		// Raw to volts of each channel, as libm2k computes it
+		std::vector<AdcConversion> d_conv;
+
+		void updateCoefficients(unsigned int nchannels);
+
 	public:
 		explicit adc_sample_conv(int nconnections,
 					 libm2k::analog::M2kAnalogIn* m2k_adc,
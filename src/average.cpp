@@ -19,12 +19,71 @@
  */
 
 #include "average.h"
+#include "simd.h"
+
 #include <algorithm>
-#include <cstring>
-#include <boost/make_shared.hpp>
+#include <cmath>
 
 using namespace adiscope;
 
+namespace {
+	using simd::v4df;
+
+	/*
+	 * Runs op over a block of bins, four at a time while there are
+	 * enough of them: state[i] = op(data[i], state[i]), which is also
+	 * written to out[i]. data and out may be the same buffer.
+	 */
+	template <typename Op>
+	void updateBins(const double *data, double *state, double *out,
+			unsigned int count, const Op &op)
+	{
+		unsigned int i = 0;
+
+		for (; i + simd::LANES <= count; i += simd::LANES) {
+			const v4df v = op(simd::load(data + i), simd::load(state + i));
+
+			simd::store(state + i, v);
+			simd::store(out + i, v);
+		}
+		for (; i < count; i++) {
+			out[i] = state[i] = op(data[i], state[i]);
+		}
+	}
+
+	struct CopyOp {
+		template <typename T> T operator()(T d, T) const { return d; }
+	};
+
+	struct SquareOp {
+		template <typename T> T operator()(T d, T) const { return d * d; }
+	};
+
+	struct MaxOp {
+		template <typename T> T operator()(T d, T s) const { return simd::max(d, s); }
+	};
+
+	struct MinOp {
+		template <typename T> T operator()(T d, T s) const { return simd::min(d, s); }
+	};
+
+	/* (d + (n - 1) * s) / n, or its square version, with the divisions
+	 * folded into the two weights */
+	struct ExponentialOp {
+		double newWeight;
+		double oldWeight;
+		bool squared;
+
+		explicit ExponentialOp(unsigned int n, bool squared) :
+			newWeight(1.0 / n), oldWeight((n - 1.0) / n), squared(squared) {}
+
+		template <typename T> T operator()(T d, T s) const
+		{
+			return (squared ? d * d : d) * newWeight + s * oldWeight;
+		}
+	};
+}
+
 /*
  * class SpectrumAverage
  */
@@ -39,20 +98,27 @@ SpectrumAverage::SpectrumAverage(unsigned int data_width, unsigned int history,
 	if (history < 1)
 		m_history_size = 1;
 
-	m_average = new double[m_data_width];
+	m_average.resize(m_data_width);
 }
 
 SpectrumAverage::~SpectrumAverage()
 {
-	delete[] m_average;
 }
 
-void SpectrumAverage::getAverage(double *out_data,
-	unsigned int num_samples) const
+void SpectrumAverage::pushNewData(const double *data, double *out,
+				  unsigned int first, unsigned int count)
 {
-	unsigned int size = std::min(m_data_width, num_samples);
+	count = std::min(count, m_data_width - std::min(first, m_data_width));
+
+	pushBins(data, out, first, count);
+
+	if (first + count == m_data_width)
+		frameDone();
+}
 
-	std::memcpy(out_data, m_average, size * sizeof(double));
+void SpectrumAverage::pushNewData(const double *data, double *out)
+{
+	pushNewData(data, out, 0, m_data_width);
 }
 
 unsigned int SpectrumAverage::dataWidth() const
@@ -89,19 +155,20 @@ void AverageHistoryOne::reset()
 	m_anyDataPushed = false;
 }
 
+void AverageHistoryOne::frameDone()
+{
+	m_anyDataPushed = true;
+}
+
 /*
  * class AverageHistoryN
  */
 AverageHistoryN::AverageHistoryN(unsigned int data_width, unsigned int history):
-	SpectrumAverage(data_width, history, true), m_insert_index(0),
+	SpectrumAverage(data_width, history, true),
+	m_history(size_t(m_history_size) * m_data_width),
+	m_insert_index(0),
 	m_inserted_count(0)
 {
-	alloc_history(m_data_width, m_history_size);
-}
-
-AverageHistoryN::~AverageHistoryN()
-{
-	free_history();
 }
 
 void AverageHistoryN::reset()
@@ -110,74 +177,52 @@ void AverageHistoryN::reset()
 	m_insert_index = 0;
 }
 
-void AverageHistoryN::alloc_history(unsigned int data_width,
-	unsigned int history_size)
+double *AverageHistoryN::historyRow(unsigned int row)
 {
-	boost::unique_lock<boost::mutex> lock(m_history_mutex);
-	m_history = new double*[history_size];
-	for (unsigned int i = 0; i < history_size; i++)
-		m_history[i] = new double[data_width];
+	return m_history.data() + size_t(row) * m_data_width;
+}
 
+const double *AverageHistoryN::historyRow(unsigned int row) const
+{
+	return m_history.data() + size_t(row) * m_data_width;
 }
 
-void AverageHistoryN::free_history()
+unsigned int AverageHistoryN::keptRow(unsigned int i) const
 {
-	boost::unique_lock<boost::mutex> lock(m_history_mutex);
-	for (unsigned int i = 0; i < m_history_size; i++)
-		delete[] m_history[i];
-	delete[] m_history;
+	if (m_inserted_count < m_history_size)
+		return i;
+
+	return (m_insert_index + i) % m_history_size;
 }
 
 void AverageHistoryN::setHistory(unsigned int history)
 {
-	double **tmp_history;
-	tmp_history = new double*[history];
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
 
-	for (unsigned int i = 0; i < history; i++) {
-		tmp_history[i] = new double[m_data_width];
-	}
+	history = std::max(history, 1u);
 
-	if (history > m_history_size) {
-		for (unsigned int i = 0; i < m_history_size; i++) {
-			std::memcpy(tmp_history[i], m_history[i],
-				    m_data_width * sizeof(double));
-		}
-	} else {
-		int start_index = (m_insert_index > history) ? (m_insert_index - history) : 0;
-		int remaining_samples = std::min(m_inserted_count, history);
-		int tmp_i = 0;
-
-		for (unsigned int i = start_index; i < m_insert_index; i++) {
-			std::memcpy(tmp_history[tmp_i], m_history[i],
-				    m_data_width * sizeof(double));
-			remaining_samples--;
-			tmp_i++;
-		}
+	// The newest frames that fit are moved to the start of the new
+	// ring, oldest first
+	const unsigned int kept = std::min(m_inserted_count, history);
+	std::vector<double> tmp_history(size_t(history) * m_data_width);
 
-		for (unsigned int i = m_history_size - remaining_samples; i < m_history_size; i++) {
-			std::memcpy(tmp_history[tmp_i], m_history[i],
-				    m_data_width * sizeof(double));
-			tmp_i++;
-		}
+	for (unsigned int i = 0; i < kept; i++) {
+		const double *row = historyRow(keptRow(m_inserted_count - kept + i));
 
-		if (m_insert_index > history) {
-			m_insert_index = 0;
-		}
-		m_inserted_count = std::min(m_inserted_count, history);
+		std::copy(row, row + m_data_width,
+			  tmp_history.begin() + size_t(i) * m_data_width);
 	}
 
-	free_history();
-
-	boost::unique_lock<boost::mutex> lock(m_history_mutex);
-	m_history = tmp_history;
+	m_history.swap(tmp_history);
+	m_inserted_count = kept;
+	m_insert_index = kept % history;
 	SpectrumAverage::setHistory(history);
+
+	historyChanged();
 }
 
-void AverageHistoryN::pushNewData(double *data)
+void AverageHistoryN::frameDone()
 {
-	boost::unique_lock<boost::mutex> lock(m_history_mutex);
-	std::memcpy(m_history[m_insert_index], data,
-		m_data_width * sizeof(double));
 	m_insert_index = (m_insert_index + 1) % m_history_size;
 	m_inserted_count = std::min(m_inserted_count + 1, m_history_size);
 }
@@ -190,15 +235,13 @@ PeakHoldContinuous::PeakHoldContinuous(unsigned int data_width,
 {
 }
 
-void PeakHoldContinuous::pushNewData(double *data)
+void PeakHoldContinuous::pushBins(const double *data, double *out,
+				  unsigned int first, unsigned int count)
 {
-	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = std::max(data[i], m_average[i]);
-	} else {
-		std::memcpy(m_average, data, m_data_width * sizeof(double));
-		m_anyDataPushed = true;
-	}
+	if (m_anyDataPushed)
+		updateBins(data, m_average.data() + first, out, count, MaxOp());
+	else
+		updateBins(data, m_average.data() + first, out, count, CopyOp());
 }
 
 /*
@@ -209,15 +252,13 @@ MinHoldContinuous::MinHoldContinuous(unsigned int data_width,
 {
 }
 
-void MinHoldContinuous::pushNewData(double *data)
+void MinHoldContinuous::pushBins(const double *data, double *out,
+				 unsigned int first, unsigned int count)
 {
-	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = std::min(data[i], m_average[i]);
-	} else {
-		std::memcpy(m_average, data, m_data_width * sizeof(double));
-		m_anyDataPushed = true;
-	}
+	if (m_anyDataPushed)
+		updateBins(data, m_average.data() + first, out, count, MinOp());
+	else
+		updateBins(data, m_average.data() + first, out, count, CopyOp());
 }
 
 /*
@@ -228,17 +269,14 @@ ExponentialRMS::ExponentialRMS(unsigned int data_width, unsigned int history):
 {
 }
 
-void ExponentialRMS::pushNewData(double *data)
+void ExponentialRMS::pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count)
 {
-	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = (data[i] * data[i] + (m_history_size - 1)
-				* m_average[i]) / m_history_size;
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = data[i] * data[i];
-		m_anyDataPushed = true;
-	}
+	if (m_anyDataPushed)
+		updateBins(data, m_average.data() + first, out, count,
+			   ExponentialOp(m_history_size, true));
+	else
+		updateBins(data, m_average.data() + first, out, count, SquareOp());
 }
 
 /*
@@ -249,16 +287,14 @@ ExponentialAverage::ExponentialAverage(unsigned int data_width, unsigned int his
 {
 }
 
-void ExponentialAverage::pushNewData(double *data)
+void ExponentialAverage::pushBins(const double *data, double *out,
+				  unsigned int first, unsigned int count)
 {
-	if (m_anyDataPushed) {
-		for (unsigned int i = 0; i < m_data_width; i++)
-			m_average[i] = (data[i] + (m_history_size - 1)
-				* m_average[i]) / m_history_size;
-	} else {
-		std::memcpy(m_average, data, m_data_width * sizeof(double));
-		m_anyDataPushed = true;
-	}
+	if (m_anyDataPushed)
+		updateBins(data, m_average.data() + first, out, count,
+			   ExponentialOp(m_history_size, false));
+	else
+		updateBins(data, m_average.data() + first, out, count, CopyOp());
 }
 
 /*
@@ -269,47 +305,78 @@ PeakHold::PeakHold(unsigned int data_width, unsigned int history):
 {
 }
 
-void PeakHold::pushNewData(double *data)
+void PeakHold::pushBins(const double *data, double *out,
+			unsigned int first, unsigned int count)
 {
-	double *peaks = m_average;
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
+
+	double *peaks = m_average.data() + first;
+	double *row = historyRow(m_insert_index) + first;
 
 	if (m_inserted_count == 0 || m_history_size == 1) {
-		std::memcpy(peaks, data, m_data_width * sizeof(double));
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			if (data[i] > peaks[i])
-				peaks[i] = data[i];
+		updateBins(data, peaks, out, count, CopyOp());
+		std::copy(data, data + count, row);
+		return;
+	}
+
+	const bool full = (m_inserted_count == m_history_size);
+	unsigned int i = 0;
 
-			if (m_inserted_count != m_history_size)
-				continue;
+	for (; i + simd::LANES <= count; i += simd::LANES) {
+		const v4df d = simd::load(data + i);
+		v4df p = simd::max(d, simd::load(peaks + i));
 
-			// If the value that we're about to drop (overwrite) is
-			// currently the peak we need to find a new peak
-			if (m_history[m_insert_index][i] == peaks[i])
-				peaks[i] = getPeakFromHistoryColumn(i);
+		// If the value that we're about to drop (overwrite) is
+		// currently the peak we need to find a new peak
+		if (full && simd::any((simd::v4di)(simd::load(row + i) == p))) {
+			for (unsigned int lane = 0; lane < simd::LANES; lane++) {
+				if (row[i + lane] == p[lane])
+					p[lane] = std::max(d[lane],
+						getPeakFromHistoryColumn(first + i + lane));
+			}
 		}
+
+		simd::store(row + i, d);
+		simd::store(peaks + i, p);
+		simd::store(out + i, p);
 	}
+	for (; i < count; i++) {
+		const double d = data[i];
+		double p = std::max(d, peaks[i]);
+
+		if (full && row[i] == p)
+			p = std::max(d, getPeakFromHistoryColumn(first + i));
 
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+		row[i] = d;
+		out[i] = peaks[i] = p;
+	}
 }
 
-double PeakHold::getPeakFromHistoryColumn(unsigned int col)
+double PeakHold::getPeakFromHistoryColumn(unsigned int col) const
 {
-	if (m_inserted_count < 2)
-		return m_history[0][col];
-
-	unsigned int start = (m_insert_index != 0) ? 0 : 1;
-	double peak = m_history[start][col];
+	// Every kept frame but the one that is being replaced
+	double peak = -INFINITY;
 
-	for (unsigned int i = start + 1; i < m_inserted_count; i++) {
-		if (i != m_insert_index && m_history[i][col] > peak)
-			peak = m_history[i][col];
+	for (unsigned int row = 0; row < m_inserted_count; row++) {
+		if (row != m_insert_index)
+			peak = std::max(peak, historyRow(row)[col]);
 	}
 
 	return peak;
 }
 
+void PeakHold::historyChanged()
+{
+	if (m_inserted_count == 0)
+		return;
+
+	std::copy(historyRow(0), historyRow(0) + m_data_width, m_average.begin());
+	for (unsigned int row = 1; row < m_inserted_count; row++) {
+		updateBins(historyRow(row), m_average.data(), m_average.data(),
+			   m_data_width, MaxOp());
+	}
+}
+
 /*
  * class MinHold
  */
@@ -318,209 +385,320 @@ MinHold::MinHold(unsigned int data_width, unsigned int history):
 {
 }
 
-void MinHold::pushNewData(double *data)
+void MinHold::pushBins(const double *data, double *out,
+		       unsigned int first, unsigned int count)
 {
-	double *mins = m_average;
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
+
+	double *mins = m_average.data() + first;
+	double *row = historyRow(m_insert_index) + first;
 
 	if (m_inserted_count == 0 || m_history_size == 1) {
-		std::memcpy(mins, data, m_data_width * sizeof(double));
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			if (data[i] < mins[i])
-				mins[i] = data[i];
+		updateBins(data, mins, out, count, CopyOp());
+		std::copy(data, data + count, row);
+		return;
+	}
+
+	const bool full = (m_inserted_count == m_history_size);
+	unsigned int i = 0;
 
-			if (m_inserted_count != m_history_size)
-				continue;
+	for (; i + simd::LANES <= count; i += simd::LANES) {
+		const v4df d = simd::load(data + i);
+		v4df m = simd::min(d, simd::load(mins + i));
 
-			// If the value that we're about to drop (overwrite) is
-			// currently the min we need to find a new min
-			if (m_history[m_insert_index][i] == mins[i])
-				mins[i] = getMinFromHistoryColumn(i);
+		// If the value that we're about to drop (overwrite) is
+		// currently the min we need to find a new min
+		if (full && simd::any((simd::v4di)(simd::load(row + i) == m))) {
+			for (unsigned int lane = 0; lane < simd::LANES; lane++) {
+				if (row[i + lane] == m[lane])
+					m[lane] = std::min(d[lane],
+						getMinFromHistoryColumn(first + i + lane));
+			}
 		}
+
+		simd::store(row + i, d);
+		simd::store(mins + i, m);
+		simd::store(out + i, m);
 	}
+	for (; i < count; i++) {
+		const double d = data[i];
+		double m = std::min(d, mins[i]);
+
+		if (full && row[i] == m)
+			m = std::min(d, getMinFromHistoryColumn(first + i));
 
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+		row[i] = d;
+		out[i] = mins[i] = m;
+	}
 }
 
-double MinHold::getMinFromHistoryColumn(unsigned int col)
+double MinHold::getMinFromHistoryColumn(unsigned int col) const
 {
-	if (m_inserted_count < 2)
-		return m_history[0][col];
-
-	unsigned int start = (m_insert_index != 0) ? 0 : 1;
-	double min = m_history[start][col];
+	// Every kept frame but the one that is being replaced
+	double min = INFINITY;
 
-	for (unsigned int i = start + 1; i < m_inserted_count; i++) {
-		if (i != m_insert_index && m_history[i][col] < min)
-			min = m_history[i][col];
+	for (unsigned int row = 0; row < m_inserted_count; row++) {
+		if (row != m_insert_index)
+			min = std::min(min, historyRow(row)[col]);
 	}
 
 	return min;
 }
 
+void MinHold::historyChanged()
+{
+	if (m_inserted_count == 0)
+		return;
+
+	std::copy(historyRow(0), historyRow(0) + m_data_width, m_average.begin());
+	for (unsigned int row = 1; row < m_inserted_count; row++) {
+		updateBins(historyRow(row), m_average.data(), m_average.data(),
+			   m_data_width, MinOp());
+	}
+}
+
 /*
  * class LinearRMSOne
  */
 LinearRMSOne::LinearRMSOne(unsigned int data_width, unsigned int history):
-	AverageHistoryOne(data_width, history)
+	AverageHistoryOne(data_width, history),
+	m_sqr_sums(m_data_width),
+	m_inserted_count(0)
 {
-	m_sqr_sums = new double[m_data_width];
+}
+
+void LinearRMSOne::reset()
+{
+	std::fill(m_sqr_sums.begin(), m_sqr_sums.end(), 0);
 	m_inserted_count = 0;
+	AverageHistoryOne::reset();
 }
 
-LinearRMSOne::~LinearRMSOne()
+void LinearRMSOne::pushBins(const double *data, double *out,
+			    unsigned int first, unsigned int count)
 {
-	delete[] m_sqr_sums;
+	double *avg = m_average.data() + first;
+	double *sqr_sums = m_sqr_sums.data() + first;
+
+	if (!m_anyDataPushed) {
+		updateBins(data, avg, out, count, CopyOp());
+	} else if (m_inserted_count < m_history_size) {
+		for (unsigned int i = 0; i < count; i++)
+			sqr_sums[i] += (data[i] * data[i]);
+		std::copy(avg, avg + count, out);
+	} else {
+		const double scale = 1.0 / m_inserted_count;
+
+		for (unsigned int i = 0; i < count; i++) {
+			out[i] = avg[i] = sqr_sums[i] * scale;
+			sqr_sums[i] = 0;
+		}
+	}
 }
 
-void LinearRMSOne::pushNewData(double *data)
+void LinearRMSOne::frameDone()
 {
 	if (m_anyDataPushed) {
-		if (m_inserted_count < m_history_size) {
-			for (unsigned int i = 0; i < m_data_width; i++) {
-				m_sqr_sums[i] += (data[i] * data[i]);
-			}
+		if (m_inserted_count < m_history_size)
 			m_inserted_count++;
-		} else if (m_inserted_count != 0) {
-			for (unsigned int i = 0; i < m_data_width; i++) {
-				m_average[i] = m_sqr_sums[i] / m_inserted_count;
-				m_sqr_sums[i] = 0;
-			}
+		else
 			m_inserted_count = 0;
-		}
-	} else {
-		std::memcpy(m_average, data, m_data_width * sizeof(double));
-		m_anyDataPushed = true;
 	}
 
+	AverageHistoryOne::frameDone();
 }
 
-
 /*
  * class LinearAverageOne
  */
 LinearAverageOne::LinearAverageOne(unsigned int data_width, unsigned int history):
-	AverageHistoryOne(data_width, history)
+	AverageHistoryOne(data_width, history),
+	m_sums(m_data_width),
+	m_inserted_count(0)
 {
-	m_sums = new double[m_data_width];
+}
+
+void LinearAverageOne::reset()
+{
+	std::fill(m_sums.begin(), m_sums.end(), 0);
 	m_inserted_count = 0;
+	AverageHistoryOne::reset();
 }
 
-LinearAverageOne::~LinearAverageOne()
+void LinearAverageOne::pushBins(const double *data, double *out,
+				unsigned int first, unsigned int count)
 {
-	delete[] m_sums;
+	double *avg = m_average.data() + first;
+	double *sums = m_sums.data() + first;
+
+	if (!m_anyDataPushed) {
+		updateBins(data, avg, out, count, CopyOp());
+	} else if (m_inserted_count < m_history_size) {
+		for (unsigned int i = 0; i < count; i++)
+			sums[i] += data[i];
+		std::copy(avg, avg + count, out);
+	} else {
+		const double scale = 1.0 / m_inserted_count;
+
+		for (unsigned int i = 0; i < count; i++) {
+			out[i] = avg[i] = sums[i] * scale;
+			sums[i] = 0;
+		}
+	}
 }
 
-void LinearAverageOne::pushNewData(double *data)
+void LinearAverageOne::frameDone()
 {
 	if (m_anyDataPushed) {
-		if (m_inserted_count < m_history_size) {
-			for (unsigned int i = 0; i < m_data_width; i++) {
-				m_sums[i] += data[i];
-			}
+		if (m_inserted_count < m_history_size)
 			m_inserted_count++;
-		} else if (m_inserted_count != 0) {
-			for (unsigned int i = 0; i < m_data_width; i++) {
-				m_average[i] = m_sums[i] / m_inserted_count;
-				m_sums[i] = 0;
-			}
+		else
 			m_inserted_count = 0;
-		}
-	} else {
-		std::memcpy(m_average, data, m_data_width * sizeof(double));
-		m_anyDataPushed = true;
 	}
-}
 
+	AverageHistoryOne::frameDone();
+}
 
 /*
  * class LinearRMS
  */
 LinearRMS::LinearRMS(unsigned int data_width, unsigned int history):
-	AverageHistoryN(data_width, history)
+	AverageHistoryN(data_width, history),
+	m_sqr_sums(m_data_width)
 {
-	m_sqr_sums = new double[data_width]();
 }
 
-LinearRMS::~LinearRMS()
+void LinearRMS::pushBins(const double *data, double *out,
+			 unsigned int first, unsigned int count)
 {
-	delete[] m_sqr_sums;
-}
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
 
-void LinearRMS::pushNewData(double *data)
-{
-	if (m_inserted_count != m_history_size) {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sqr_sums[i] += (data[i] * data[i]);
-		}
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sqr_sums[i] -= (m_history[m_insert_index][i] *
-				m_history[m_insert_index][i]);
-			m_sqr_sums[i] += (data[i] * data[i]);
-		}
+	double *sqr_sums = m_sqr_sums.data() + first;
+	double *row = historyRow(m_insert_index) + first;
+
+	// The frame that is replaced, if any, leaves the sums; rounding can
+	// leave the sum of squares slightly negative when it should be zero
+	const bool full = (m_inserted_count == m_history_size);
+	const double scale = 1.0 / std::min(m_inserted_count + 1, m_history_size);
+	unsigned int i = 0;
+
+	for (; i + simd::LANES <= count; i += simd::LANES) {
+		const v4df d = simd::load(data + i);
+		const v4df old = full ? simd::load(row + i) : v4df{};
+		const v4df sum = simd::max((simd::load(sqr_sums + i) - old * old) + d * d,
+					   v4df{});
+
+		simd::store(row + i, d);
+		simd::store(sqr_sums + i, sum);
+		simd::store(out + i, simd::sqrt(sum * scale));
 	}
+	for (; i < count; i++) {
+		const double d = data[i];
+		const double old = full ? row[i] : 0;
 
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+		sqr_sums[i] = simd::max((sqr_sums[i] - old * old) + d * d, 0.0);
+		row[i] = d;
+		out[i] = std::sqrt(sqr_sums[i] * scale);
+	}
+}
+
+void LinearRMS::reset()
+{
+	std::fill(m_sqr_sums.begin(), m_sqr_sums.end(), 0);
+	AverageHistoryN::reset();
 }
 
-void LinearRMS::getAverage(double *out_data, unsigned int num_samples) const
+void LinearRMS::frameDone()
 {
-	unsigned int num = std::min(m_data_width, num_samples);
+	AverageHistoryN::frameDone();
 
-	for (unsigned int i = 0; i < num; i++)
-		out_data[i] = sqrt(m_sqr_sums[i] / m_inserted_count);
+	// Every frame that leaves the running sums leaves some rounding
+	// error behind; they are rebuilt from the ring once per lap
+	if (m_insert_index == 0) {
+		boost::unique_lock<boost::mutex> lock(m_history_mutex);
+		historyChanged();
+	}
 }
 
-void LinearRMS::reset()
+void LinearRMS::historyChanged()
 {
-	std::fill_n(m_sqr_sums, m_data_width, 0);
-	AverageHistoryN::reset();
+	std::fill(m_sqr_sums.begin(), m_sqr_sums.end(), 0);
+
+	for (unsigned int row = 0; row < m_inserted_count; row++) {
+		const double *frame = historyRow(row);
+
+		for (unsigned int i = 0; i < m_data_width; i++)
+			m_sqr_sums[i] += frame[i] * frame[i];
+	}
 }
 
 /*
  * class LinearAverage
  */
 LinearAverage::LinearAverage(unsigned int data_width, unsigned int history):
-	AverageHistoryN(data_width, history)
+	AverageHistoryN(data_width, history),
+	m_sums(m_data_width)
 {
-	m_sums = new double[data_width]();
 }
 
-LinearAverage::~LinearAverage()
+void LinearAverage::pushBins(const double *data, double *out,
+			     unsigned int first, unsigned int count)
 {
-	delete[] m_sums;
-}
+	boost::unique_lock<boost::mutex> lock(m_history_mutex);
 
-void LinearAverage::pushNewData(double *data)
-{
-	if (m_inserted_count != m_history_size) {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sums[i] += data[i];
-		}
-	} else {
-		for (unsigned int i = 0; i < m_data_width; i++) {
-			m_sums[i] -= m_history[m_insert_index][i];
-			m_sums[i] += data[i];
-		}
+	double *sums = m_sums.data() + first;
+	double *row = historyRow(m_insert_index) + first;
+
+	// The frame that is replaced, if any, leaves the sums. The frames
+	// may be in dB, so the sums can rightly be negative.
+	const bool full = (m_inserted_count == m_history_size);
+	const double scale = 1.0 / std::min(m_inserted_count + 1, m_history_size);
+	unsigned int i = 0;
+
+	for (; i + simd::LANES <= count; i += simd::LANES) {
+		const v4df d = simd::load(data + i);
+		const v4df old = full ? simd::load(row + i) : v4df{};
+		const v4df sum = (simd::load(sums + i) - old) + d;
+
+		simd::store(row + i, d);
+		simd::store(sums + i, sum);
+		simd::store(out + i, sum * scale);
 	}
+	for (; i < count; i++) {
+		const double d = data[i];
+
+		sums[i] = (sums[i] - (full ? row[i] : 0)) + d;
+		row[i] = d;
+		out[i] = sums[i] * scale;
+	}
+}
 
-	// Let the base class handle the data storing
-	AverageHistoryN::pushNewData(data);
+void LinearAverage::reset()
+{
+	std::fill(m_sums.begin(), m_sums.end(), 0);
+	AverageHistoryN::reset();
 }
 
-void LinearAverage::getAverage(double *out_data, unsigned int num_samples) const
+void LinearAverage::frameDone()
 {
-	unsigned int num = std::min(m_data_width, num_samples);
+	AverageHistoryN::frameDone();
 
-	for (unsigned int i = 0; i < num; i++)
-		out_data[i] = m_sums[i] / m_inserted_count;
+	// Every frame that leaves the running sums leaves some rounding
+	// error behind; they are rebuilt from the ring once per lap
+	if (m_insert_index == 0) {
+		boost::unique_lock<boost::mutex> lock(m_history_mutex);
+		historyChanged();
+	}
 }
 
-void LinearAverage::reset()
+void LinearAverage::historyChanged()
 {
-	std::fill_n(m_sums, m_data_width, 0);
-	AverageHistoryN::reset();
+	std::fill(m_sums.begin(), m_sums.end(), 0);
+
+	for (unsigned int row = 0; row < m_inserted_count; row++) {
+		const double *frame = historyRow(row);
+
+		for (unsigned int i = 0; i < m_data_width; i++)
+			m_sums[i] += frame[i];
+	}
 }
@@ -23,16 +23,30 @@
 
 #include <boost/thread/mutex.hpp>
 
-namespace adiscope {
+#include <vector>
 
+namespace adiscope {
 
+/*
+ * Average of a stream of frames, computed bin by bin. A frame can be pushed
+ * a block of bins at a time, so that whatever the caller does next with the
+ * averaged bins runs while they are still in cache.
+ */
 class SpectrumAverage {
 public:
 	SpectrumAverage(unsigned int data_width, unsigned int history, bool history_en);
 	virtual ~SpectrumAverage();
-	virtual void pushNewData(double *data) = 0;
-	virtual void getAverage(double *out_data,
-		unsigned int num_samples) const;
+
+	/*
+	 * Adds the bins [first, first + count) of a new frame and writes
+	 * their average to out. data and out point to bin first and may be
+	 * the same buffer. The blocks of a frame are pushed in order; the
+	 * frame is added once its last bin is in.
+	 */
+	void pushNewData(const double *data, double *out,
+			 unsigned int first, unsigned int count);
+	void pushNewData(const double *data, double *out);
+
 	virtual void reset() = 0;
 	unsigned int dataWidth() const;
 	unsigned int history() const;
@@ -40,10 +54,14 @@ public:
 	bool historyEnabled() const;
 
 protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count) = 0;
+	virtual void frameDone() = 0;
+
 	unsigned int m_data_width;
 	unsigned int m_history_size;
 	bool m_history_enabled;
-	double *m_average;
+	std::vector<double> m_average;
 };
 
 class AverageHistoryOne: public SpectrumAverage
@@ -53,26 +71,42 @@ public:
 	virtual void reset();
 
 protected:
+	virtual void frameDone();
+
 	bool m_anyDataPushed;
 };
 
+/*
+ * Keeps the last frames in a ring of history rows stored back to back.
+ * m_insert_index is the row the current frame goes in; once the ring is
+ * full, that is also the oldest frame, which the current one replaces.
+ * Subclasses store the bins of the new frame in that row as they average
+ * them.
+ */
 class AverageHistoryN: public SpectrumAverage
 {
 public:
 	AverageHistoryN(unsigned int data_width, unsigned int history);
-	virtual ~AverageHistoryN();
-	virtual void pushNewData(double *data);
 	virtual void reset();
 
 protected:
-	double **m_history;
+	virtual void frameDone();
+
+	/* Recomputes any running state from the frames kept in the ring
+	 * after the history size changed */
+	virtual void historyChanged() = 0;
+
+	double *historyRow(unsigned int row);
+	const double *historyRow(unsigned int row) const;
+	/* Row of the i-th kept frame, oldest first */
+	unsigned int keptRow(unsigned int i) const;
+
+	std::vector<double> m_history;
 	unsigned int m_insert_index;
 	unsigned int m_inserted_count;
 	boost::mutex m_history_mutex;
 
 private:
-	void alloc_history(unsigned int data_width, unsigned int history_size);
-	void free_history();
 	void setHistory(unsigned int) override;
 };
 
@@ -80,39 +114,55 @@ class PeakHoldContinuous: public AverageHistoryOne
 {
 public:
 	PeakHoldContinuous(unsigned int data_width, unsigned int history);
-	virtual void pushNewData(double *data);
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
 };
 
 class MinHoldContinuous: public AverageHistoryOne
 {
 public:
 	MinHoldContinuous(unsigned int data_width, unsigned int history);
-	virtual void pushNewData(double *data);
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
 };
 
 class ExponentialRMS: public AverageHistoryOne
 {
 public:
 	ExponentialRMS(unsigned int data_width, unsigned int history);
-	virtual void pushNewData(double *data);
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
 };
 
 class ExponentialAverage: public AverageHistoryOne
 {
 public:
 	ExponentialAverage(unsigned int data_width, unsigned int history);
-	virtual void pushNewData(double *data);
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
 };
 
 class LinearRMSOne: public AverageHistoryOne
 {
 public:
 	LinearRMSOne(unsigned int data_width, unsigned int history);
-	~LinearRMSOne();
-	virtual void pushNewData(double *data);
+	virtual void reset();
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
+	virtual void frameDone();
 
 private:
-	double *m_sqr_sums;
+	std::vector<double> m_sqr_sums;
 	unsigned int m_inserted_count;
 };
 
@@ -120,11 +170,15 @@ class LinearAverageOne: public AverageHistoryOne
 {
 public:
 	LinearAverageOne(unsigned int data_width, unsigned int history);
-	~LinearAverageOne();
-	virtual void pushNewData(double *data);
+	virtual void reset();
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
+	virtual void frameDone();
 
 private:
-	double *m_sums;
+	std::vector<double> m_sums;
 	unsigned int m_inserted_count;
 };
 
@@ -132,48 +186,60 @@ class PeakHold: public AverageHistoryN
 {
 public:
 	PeakHold(unsigned int data_width, unsigned int history);
-	virtual void pushNewData(double *data);
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
+	virtual void historyChanged();
 
 private:
-	double getPeakFromHistoryColumn(unsigned int col);
+	double getPeakFromHistoryColumn(unsigned int col) const;
 };
 
 class MinHold: public AverageHistoryN
 {
 public:
 	MinHold(unsigned int data_width, unsigned int history);
-	virtual void pushNewData(double *data);
+
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
+	virtual void historyChanged();
 
 private:
-	double getMinFromHistoryColumn(unsigned int col);
+	double getMinFromHistoryColumn(unsigned int col) const;
 };
 
 class LinearRMS: public AverageHistoryN
 {
 public:
 	LinearRMS(unsigned int data_width, unsigned int history);
-	~LinearRMS();
-	virtual void pushNewData(double *data);
-	virtual void getAverage(double *out_data,
-		unsigned int num_samples) const;
 	virtual void reset();
 
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
+	virtual void frameDone();
+	virtual void historyChanged();
+
 private:
-	double *m_sqr_sums;
+	std::vector<double> m_sqr_sums;
 };
 
 class LinearAverage: public AverageHistoryN
 {
 public:
 	LinearAverage(unsigned int data_width, unsigned int history);
-	~LinearAverage();
-	virtual void pushNewData(double *data);
-	virtual void getAverage(double *out_data,
-		unsigned int num_samples) const;
 	virtual void reset();
 
+protected:
+	virtual void pushBins(const double *data, double *out,
+			      unsigned int first, unsigned int count);
+	virtual void frameDone();
+	virtual void historyChanged();
+
 private:
-	double *m_sums;
+	std::vector<double> m_sums;
 };
 
 } // namespace adiscope
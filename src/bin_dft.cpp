@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bin_dft.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* Samples filtered at a time when the compensation is on */
+#define COMPENSATION_BLOCK 256
+
+/* The phasors are rotated from one group of samples to the next and
+ * computed again from scratch this often, so the error cannot build up */
+#define PHASOR_RESEED 1024
+
+using namespace adiscope;
+
+BinDft::BinDft(double frequency, double sample_rate, size_t length) :
+	BinDft(std::vector<double>(1, frequency), sample_rate, length)
+{
+}
+
+BinDft::BinDft(const std::vector<double> &frequencies, double sample_rate,
+	       size_t length) :
+	m_w(frequencies.size()),
+	m_sample_rate(sample_rate),
+	m_length(length),
+	m_remove_dc(false),
+	m_sum(),
+	m_dc()
+{
+	for (size_t i = 0; i < frequencies.size(); i++) {
+		m_w[i] = 2.0 * M_PI * frequencies[i] / sample_rate;
+	}
+
+	for (unsigned int chn = 0; chn < 2; chn++) {
+		m_re[chn].resize(m_w.size());
+		m_im[chn].resize(m_w.size());
+		m_bin[chn].resize(m_w.size());
+
+		for (unsigned int stage = 0; stage < 2; stage++) {
+			m_stages[chn][stage] = { false, 0, 0 };
+		}
+	}
+	m_phasor_re.resize(m_w.size());
+	m_phasor_im.resize(m_w.size());
+}
+
+size_t BinDft::count() const
+{
+	return m_w.size();
+}
+
+void BinDft::setRemoveDc(bool remove_dc)
+{
+	m_remove_dc = remove_dc;
+}
+
+void BinDft::setCompensation(unsigned int chn, unsigned int stage,
+			     bool enable, float tc_us, float gain)
+{
+	// Same arithmetic as frequency_compensation_filter
+	float delta = 1.0 / static_cast<float>(m_sample_rate);
+	float TC1 = tc_us * float(1.0E-6);
+
+	m_stages[chn][stage] = { enable, TC1 / (TC1 + delta), gain };
+}
+
+bool BinDft::compensated() const
+{
+	return m_stages[0][0].enable || m_stages[0][1].enable ||
+		m_stages[1][0].enable || m_stages[1][1].enable;
+}
+
+void BinDft::compute(const short *interleaved)
+{
+	for (unsigned int chn = 0; chn < 2; chn++) {
+		std::fill(m_re[chn].begin(), m_re[chn].end(), 0.0);
+		std::fill(m_im[chn].begin(), m_im[chn].end(), 0.0);
+		std::fill(m_bin[chn].begin(), m_bin[chn].end(), 0.0);
+		m_sum[chn] = 0;
+		m_dc[chn] = 0;
+	}
+	std::fill(m_phasor_re.begin(), m_phasor_re.end(), 0.0);
+	std::fill(m_phasor_im.begin(), m_phasor_im.end(), 0.0);
+
+	if (!m_length || m_w.empty()) {
+		return;
+	}
+
+	if (!compensated()) {
+		accumulate(interleaved, interleaved + 1, 2, 0, m_length);
+	} else {
+		float block[2][COMPENSATION_BLOCK];
+		FilterState state[2][2] = {};
+
+		for (size_t first = 0; first < m_length; first += COMPENSATION_BLOCK) {
+			const size_t count = std::min<size_t>(m_length - first,
+							      COMPENSATION_BLOCK);
+
+			filter(interleaved, 0, first, count, block[0], state[0]);
+			filter(interleaved, 1, first, count, block[1], state[1]);
+			accumulate(block[0], block[1], 1, first, count);
+		}
+	}
+
+	for (unsigned int chn = 0; chn < 2; chn++) {
+		m_dc[chn] = m_sum[chn] / m_length;
+
+		for (size_t i = 0; i < m_w.size(); i++) {
+			// The mean is taken out of the sums afterwards, rather
+			// than out of every sample in a second pass
+			const std::complex<double> phasor_sum(m_phasor_re[i],
+							      -m_phasor_im[i]);
+			std::complex<double> &bin = m_bin[chn][i];
+
+			bin = std::complex<double>(m_re[chn][i], -m_im[chn][i]);
+
+			if (m_remove_dc) {
+				bin -= m_dc[chn] * phasor_sum;
+			}
+
+			bin /= static_cast<double>(m_length);
+		}
+	}
+}
+
+std::complex<double> BinDft::bin(unsigned int chn, size_t tone) const
+{
+	return m_bin[chn][tone];
+}
+
+double BinDft::dc(unsigned int chn) const
+{
+	return m_dc[chn];
+}
+
+void BinDft::samples(const short *interleaved, unsigned int chn,
+			   double scale, std::vector<float> &out) const
+{
+	const double offset = m_remove_dc ? m_dc[chn] : 0.0;
+	FilterState state[2] = {};
+	float block[COMPENSATION_BLOCK];
+
+	out.resize(m_length);
+
+	for (size_t first = 0; first < m_length; first += COMPENSATION_BLOCK) {
+		const size_t count = std::min<size_t>(m_length - first,
+						      COMPENSATION_BLOCK);
+
+		filter(interleaved, chn, first, count, block, state);
+
+		for (size_t i = 0; i < count; i++) {
+			out[first + i] = (block[i] - offset) * scale;
+		}
+	}
+}
+
+void BinDft::filter(const short *interleaved, unsigned int chn,
+			  size_t first, size_t count, float *out,
+			  FilterState *state) const
+{
+	for (size_t i = 0; i < count; i++) {
+		out[i] = interleaved[2 * (first + i) + chn];
+	}
+
+	for (unsigned int stage = 0; stage < 2; stage++) {
+		const Stage &s = m_stages[chn][stage];
+		FilterState &st = state[stage];
+
+		if (!s.enable) {
+			st.valid = false;
+			continue;
+		}
+
+		if (!st.valid) {
+			st.prev_in = out[0];
+			st.prev_out = 0;
+			st.valid = true;
+		}
+
+		float y = st.prev_out;
+		float x_prev = st.prev_in;
+
+		for (size_t i = 0; i < count; i++) {
+			const float x = out[i];
+
+			y = s.alpha * (y + (x - x_prev));
+			x_prev = x;
+			out[i] = x + y * s.gain;
+		}
+
+		st.prev_out = y;
+		st.prev_in = x_prev;
+	}
+}
+
+template <typename T>
+void BinDft::accumulate(const T *x0, const T *x1, size_t stride,
+			size_t first, size_t count)
+{
+	using simd::v4df;
+
+	if (m_w.size() > 1) {
+		accumulateTones(x0, x1, stride, first, count);
+		return;
+	}
+
+	// One frequency: the lanes hold four consecutive samples
+	const double w = m_w[0];
+	const v4df rot_re = simd::broadcast(std::cos(simd::LANES * w));
+	const v4df rot_im = simd::broadcast(std::sin(simd::LANES * w));
+
+	v4df re0 = {}, im0 = {}, re1 = {}, im1 = {};
+	v4df sum0 = {}, sum1 = {};
+	v4df pre = {}, pim = {};
+	v4df c = {}, s = {};
+	size_t k = 0;
+
+	for (; k + simd::LANES <= count; k += simd::LANES) {
+		if (k % PHASOR_RESEED == 0) {
+			for (unsigned int j = 0; j < simd::LANES; j++) {
+				c[j] = std::cos(w * (first + k + j));
+				s[j] = std::sin(w * (first + k + j));
+			}
+		}
+
+		const T *p0 = x0 + k * stride;
+		const T *p1 = x1 + k * stride;
+		const v4df a = { double(p0[0]), double(p0[stride]),
+				 double(p0[2 * stride]), double(p0[3 * stride]) };
+		const v4df b = { double(p1[0]), double(p1[stride]),
+				 double(p1[2 * stride]), double(p1[3 * stride]) };
+
+		re0 += a * c;
+		im0 += a * s;
+		re1 += b * c;
+		im1 += b * s;
+		sum0 += a;
+		sum1 += b;
+		pre += c;
+		pim += s;
+
+		const v4df next_c = c * rot_re - s * rot_im;
+		s = s * rot_re + c * rot_im;
+		c = next_c;
+	}
+
+	for (unsigned int j = 0; j < simd::LANES; j++) {
+		m_re[0][0] += re0[j];
+		m_im[0][0] += im0[j];
+		m_re[1][0] += re1[j];
+		m_im[1][0] += im1[j];
+		m_sum[0] += sum0[j];
+		m_sum[1] += sum1[j];
+		m_phasor_re[0] += pre[j];
+		m_phasor_im[0] += pim[j];
+	}
+
+	for (; k < count; k++) {
+		const double pc = std::cos(w * (first + k));
+		const double ps = std::sin(w * (first + k));
+		const double a = x0[k * stride];
+		const double b = x1[k * stride];
+
+		m_re[0][0] += a * pc;
+		m_im[0][0] += a * ps;
+		m_re[1][0] += b * pc;
+		m_im[1][0] += b * ps;
+		m_sum[0] += a;
+		m_sum[1] += b;
+		m_phasor_re[0] += pc;
+		m_phasor_im[0] += ps;
+	}
+}
+
+template <typename T>
+void BinDft::accumulateTones(const T *x0, const T *x1, size_t stride,
+			     size_t first, size_t count)
+{
+	using simd::v4df;
+
+	// Several frequencies: the lanes hold four of them, the phasors of
+	// the lanes left over stay at zero
+	for (size_t k = 0; k < count; k++) {
+		m_sum[0] += x0[k * stride];
+		m_sum[1] += x1[k * stride];
+	}
+
+	for (size_t start = 0; start < count; start += PHASOR_RESEED) {
+		const size_t end = std::min<size_t>(count, start + PHASOR_RESEED);
+
+		for (size_t tone = 0; tone < m_w.size(); tone += simd::LANES) {
+			const size_t lanes = std::min<size_t>(m_w.size() - tone,
+							      simd::LANES);
+			v4df rot_re = simd::broadcast(1.0), rot_im = {};
+			v4df c = {}, s = {};
+
+			for (unsigned int j = 0; j < lanes; j++) {
+				const double w = m_w[tone + j];
+
+				rot_re[j] = std::cos(w);
+				rot_im[j] = std::sin(w);
+				c[j] = std::cos(w * (first + start));
+				s[j] = std::sin(w * (first + start));
+			}
+
+			v4df re0 = {}, im0 = {}, re1 = {}, im1 = {};
+			v4df pre = {}, pim = {};
+
+			for (size_t k = start; k < end; k++) {
+				const v4df a = simd::broadcast(x0[k * stride]);
+				const v4df b = simd::broadcast(x1[k * stride]);
+
+				re0 += a * c;
+				im0 += a * s;
+				re1 += b * c;
+				im1 += b * s;
+				pre += c;
+				pim += s;
+
+				const v4df next_c = c * rot_re - s * rot_im;
+				s = s * rot_re + c * rot_im;
+				c = next_c;
+			}
+
+			for (unsigned int j = 0; j < lanes; j++) {
+				m_re[0][tone + j] += re0[j];
+				m_im[0][tone + j] += im0[j];
+				m_re[1][tone + j] += re1[j];
+				m_im[1][tone + j] += im1[j];
+				m_phasor_re[tone + j] += pre[j];
+				m_phasor_im[tone + j] += pim[j];
+			}
+		}
+	}
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BIN_DFT_H
+#define BIN_DFT_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace adiscope {
+
+/*
+ * DFT bins of one or more frequencies and the mean of both channels of an
+ * interleaved two channel capture, taken in a single pass over the raw ADC
+ * codes.
+ *
+ * Each channel may go through the two frequency compensation stages of the
+ * ADC front end first, which behave as frequency_compensation_filter does
+ * on a new stream, except that the samples stay in float from one stage to
+ * the next and into the DFT instead of being truncated to ADC codes. The
+ * samples are then read in small blocks instead of all at once.
+ *
+ * The bin is sum(x[n] * exp(-j * w * n)) / length, which differs from the
+ * result of a Goertzel filter over the same samples only by a phase that
+ * is the same for both channels. With DC removal the mean of the channel
+ * is subtracted from the samples first.
+ *
+ * Several frequencies are worked out together, four at a time, on each
+ * small block of samples while it is still in the cache. When they all
+ * have a whole number of periods in the capture, as the tones of a
+ * multisine do, the bins do not leak into each other.
+ */
+class BinDft
+{
+public:
+	BinDft(double frequency, double sample_rate, size_t length);
+	BinDft(const std::vector<double> &frequencies, double sample_rate,
+	       size_t length);
+
+	size_t count() const;
+
+	void setRemoveDc(bool remove_dc);
+	void setCompensation(unsigned int chn, unsigned int stage, bool enable,
+			     float tc_us, float gain);
+
+	void compute(const short *interleaved);
+
+	std::complex<double> bin(unsigned int chn, size_t tone = 0) const;
+	double dc(unsigned int chn) const;
+
+	/* The samples of a channel as the DFT saw them, times scale */
+	void samples(const short *interleaved, unsigned int chn,
+		     double scale, std::vector<float> &out) const;
+
+private:
+	struct Stage {
+		bool enable;
+		float alpha;
+		float gain;
+	};
+
+	struct FilterState {
+		bool valid;
+		float prev_in;
+		float prev_out;
+	};
+
+	bool compensated() const;
+	void filter(const short *interleaved, unsigned int chn, size_t first,
+		    size_t count, float *out, FilterState *state) const;
+	template <typename T>
+	void accumulate(const T *x0, const T *x1, size_t stride,
+			size_t first, size_t count);
+	template <typename T>
+	void accumulateTones(const T *x0, const T *x1, size_t stride,
+			     size_t first, size_t count);
+
+	std::vector<double> m_w;
+	double m_sample_rate;
+	size_t m_length;
+	bool m_remove_dc;
+	Stage m_stages[2][2];
+
+	std::vector<double> m_re[2];
+	std::vector<double> m_im[2];
+	double m_sum[2];
+	std::vector<double> m_phasor_re;
+	std::vector<double> m_phasor_im;
+
+	std::vector<std::complex<double>> m_bin[2];
+	double m_dc[2];
+};
+}
+
+#endif // BIN_DFT_H
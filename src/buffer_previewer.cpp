@@ -25,6 +25,8 @@
 #include <QPainter>
 #include <QPointF>
 
+#include <algorithm>
+
 using namespace adiscope;
 
 /*
@@ -73,7 +75,7 @@ void BufferPreviewer::setWaveformPos(double pos)
 		return;
 
 	m_waveformPos = pos;
-	update();
+	rebuildFullWaveform();
 }
 
 double BufferPreviewer::waveformWidth() const
@@ -87,7 +89,7 @@ void BufferPreviewer::setWaveformWidth(double width)
 		return;
 
 	m_waveformWidth = width;
-	update();
+	rebuildFullWaveform();
 }
 
 double BufferPreviewer::highlighPos() const
@@ -279,6 +281,12 @@ void BufferPreviewer::resizeEvent(QResizeEvent *)
 	buildFullWaveform(m_fullWavePoints, m_fullWaveNumPoints);
 }
 
+void BufferPreviewer::rebuildFullWaveform()
+{
+	buildFullWaveform(m_fullWavePoints, m_fullWaveNumPoints);
+	update();
+}
+
 void BufferPreviewer::mousePressEvent(QMouseEvent *event)
 {
 	if (event->button() == Qt::RightButton) {
@@ -350,14 +358,37 @@ void AnalogBufferPreviewer::buildFullWaveform(QPointF *wavePoints, int numPts)
  */
 
 DigitalBufferPreviewer::DigitalBufferPreviewer(QWidget *parent):
-	BufferPreviewer(parent), m_noOfSteps(0)
+	BufferPreviewer(parent), m_noOfSteps(0), m_captureFirst(0),
+	m_captureSamples(0)
 {
 }
 
 DigitalBufferPreviewer::DigitalBufferPreviewer(int pixelsPerPeriod,
 	QWidget *parent):
-	BufferPreviewer(pixelsPerPeriod, M_PI / 2, parent), m_noOfSteps(0)
+	BufferPreviewer(pixelsPerPeriod, M_PI / 2, parent), m_noOfSteps(0),
+	m_captureFirst(0), m_captureSamples(0)
+{
+}
+
+void DigitalBufferPreviewer::setCapture(const logic::CaptureBuffer::sptr &capture,
+	uint64_t first, uint64_t last)
 {
+	if (capture) {
+		last = std::min<uint64_t>(last, capture->written());
+		first = std::min(std::max(first, capture->firstSample()), last);
+	} else {
+		first = last = 0;
+	}
+
+	if (capture == m_capture && first == m_captureFirst &&
+	    last - first == m_captureSamples) {
+		return;
+	}
+
+	m_capture = capture;
+	m_captureFirst = first;
+	m_captureSamples = last - first;
+	rebuildFullWaveform();
 }
 
 void DigitalBufferPreviewer::setNoOfSteps(double val)
@@ -372,6 +403,40 @@ double DigitalBufferPreviewer::noOfSteps()
 
 void DigitalBufferPreviewer::buildFullWaveform(QPointF *wavePoints, int numPts)
 {
+	const qreal high = verticalSpacing() / 2;
+	const qreal low = contentsRect().height() - verticalSpacing() / 2;
+
+	// Show where the capture is busy: the line toggles on every pixel
+	// column that holds a transition on any channel and stays flat
+	// across the idle ones
+	if (m_capture && m_captureSamples > 1) {
+		const int waveStart = qRound(waveformPos() * numPts);
+		const int waveWidth = qMax(qRound(waveformWidth() * numPts), 1);
+		const logic::LogicEdges &edges = m_capture->edges();
+		bool level = false;
+
+		std::lock_guard<std::mutex> lock(edges.mutex());
+
+		for (int i = 0; i < numPts; i++) {
+			const int column = i - waveStart;
+
+			if (column >= 0 && column < waveWidth) {
+				const uint64_t first = m_captureFirst +
+					m_captureSamples * column / waveWidth;
+				const uint64_t last = m_captureFirst +
+					m_captureSamples * (column + 1) / waveWidth;
+
+				if (edges.transitions(first, last, *m_capture)) {
+					level = !level;
+				}
+			}
+
+			wavePoints[i] = QPointF(i, level ? high : low);
+		}
+
+		return;
+	}
+
 	for (int i = 0; i < numPts; i++) {
 		qreal y;
 		int pos = i % pixelsPerPeriod();
@@ -24,6 +24,8 @@
 
 #include <QFrame>
 
+#include "logicanalyzer/capturebuffer.h"
+
 namespace adiscope{
 
 class BufferPreviewer: public QFrame
@@ -67,6 +69,7 @@ protected:
 	void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
 	void resizeEvent(QResizeEvent *) Q_DECL_OVERRIDE;
 	virtual void buildFullWaveform(QPointF *wavePoints, int numPts) = 0;
+	void rebuildFullWaveform();
 
 	void mousePressEvent(QMouseEvent *event);
 	void mouseMoveEvent(QMouseEvent *event);
@@ -119,10 +122,19 @@ public:
 	void setNoOfSteps(double val);
 	double noOfSteps();
 
+	/* Draws the activity of the samples [first, last) of the capture
+	 * instead of a generic waveform. Must be called from the GUI thread */
+	void setCapture(const logic::CaptureBuffer::sptr &capture, uint64_t first,
+			uint64_t last);
+
 protected:
 	virtual void buildFullWaveform(QPointF *wavePoints, int numPts);
 private:
 	double m_noOfSteps;
+
+	logic::CaptureBuffer::sptr m_capture;
+	uint64_t m_captureFirst;
+	uint64_t m_captureSamples;
 };
 
 } // namespace adiscope
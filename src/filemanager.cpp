@@ -24,14 +24,253 @@
 #include <QDebug>
 #include <QFile>
 #include <QDate>
+#include <QDataStream>
+#include <QIODevice>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+/*
+ * Binary capture file (*.scb)
+ *
+ *	magic		8 bytes, "SCOPYCAP"
+ *	header		QDataStream, little endian: format version, Scopy
+ *			version, export date, device, tool, additional
+ *			information, sample rate, nr of samples, column
+ *			names, nr of columns, samples per block
+ *	blocks		each one 8 byte aligned: flags (u32), nr of samples
+ *			(u32), payload size (u64), then the payload
+ *
+ * The payload of a block holds its samples column by column as little
+ * endian doubles, so an uncompressed file is read straight from the
+ * mapping; with BINARY_BLOCK_COMPRESSED set the payload went through
+ * qCompress().
+ */
+#define BINARY_MAGIC "SCOPYCAP"
+#define BINARY_MAGIC_SIZE 8
+#define BINARY_VERSION 1
+#define BINARY_BLOCK_SAMPLES 65536
+#define BINARY_BLOCK_HEADER_SIZE 16
+#define BINARY_BLOCK_COMPRESSED 0x1
+
+/* Rows formatted at once, and bytes of text gathered before each write */
+#define TEXT_BLOCK_ROWS 4096
+#define TEXT_WRITE_BUFFER (1 << 20)
+
+/* Bytes read at once when importing text */
+#define TEXT_READ_BLOCK (1 << 20)
 
 using namespace adiscope;
 
+static qint64 alignTo8(qint64 pos)
+{
+	return (pos + 7) & ~qint64(7);
+}
+
+/* Exact powers of ten, the ones a double holds without rounding */
+static const double exactPowersOf10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double scaleByPowerOf10(double value, int exp10)
+{
+	// Tiny values need more than 10^308 to come up, in two steps
+	if (exp10 >= 0) {
+		return exp10 <= 22 ? value * exactPowersOf10[exp10]
+				   : value * exactPowersOf10[22] * std::pow(10.0, exp10 - 22);
+	}
+
+	return exp10 >= -22 ? value / exactPowersOf10[-exp10]
+			    : value * std::pow(10.0, exp10);
+}
+
+static int formatUnsigned(unsigned long long value, char *out)
+{
+	char digits[20];
+	int n = 0;
+
+	do {
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	} while (value);
+
+	for (int i = 0; i < n; i++) {
+		out[i] = digits[n - 1 - i];
+	}
+
+	return n;
+}
+
+/*
+ * Formats like printf("%.6g"), which is also what QTextStream writes for a
+ * double by default, without going through the locale machinery. Returns
+ * the number of characters written; at most 16.
+ */
+static int formatNumber(double value, char *out)
+{
+	char *p = out;
+
+	if (std::isnan(value)) {
+		memcpy(out, "nan", 3);
+		return 3;
+	}
+
+	if (std::signbit(value)) {
+		*p++ = '-';
+		value = -value;
+	}
+
+	if (std::isinf(value)) {
+		memcpy(p, "inf", 3);
+		return p - out + 3;
+	}
+
+	if (value == 0.0) {
+		*p++ = '0';
+		return p - out;
+	}
+
+	// Six significant digits; the exponent from log10() may be one off
+	// around powers of ten, the digits tell
+	int exp10 = static_cast<int>(std::floor(std::log10(value)));
+	unsigned long long digits = std::llround(scaleByPowerOf10(value, 5 - exp10));
+
+	if (digits < 100000) {
+		exp10--;
+		digits = std::llround(scaleByPowerOf10(value, 5 - exp10));
+	}
+	if (digits >= 1000000) {
+		exp10++;
+		digits = std::llround(scaleByPowerOf10(value, 5 - exp10));
+	}
+
+	int nrDigits = 6;
+	while (nrDigits > 1 && digits % 10 == 0) {
+		digits /= 10;
+		nrDigits--;
+	}
+
+	char d[6];
+	formatUnsigned(digits, d);
+
+	if (exp10 < -4 || exp10 >= 6) {
+		*p++ = d[0];
+		if (nrDigits > 1) {
+			*p++ = '.';
+			memcpy(p, d + 1, nrDigits - 1);
+			p += nrDigits - 1;
+		}
+
+		*p++ = 'e';
+		*p++ = exp10 < 0 ? '-' : '+';
+
+		const int absExp = exp10 < 0 ? -exp10 : exp10;
+		if (absExp < 10) {
+			*p++ = '0';
+		}
+		p += formatUnsigned(absExp, p);
+	} else if (exp10 >= 0) {
+		for (int i = 0; i <= exp10; i++) {
+			*p++ = i < nrDigits ? d[i] : '0';
+		}
+		if (nrDigits > exp10 + 1) {
+			*p++ = '.';
+			memcpy(p, d + exp10 + 1, nrDigits - exp10 - 1);
+			p += nrDigits - exp10 - 1;
+		}
+	} else {
+		*p++ = '0';
+		*p++ = '.';
+		for (int i = 0; i < -exp10 - 1; i++) {
+			*p++ = '0';
+		}
+		memcpy(p, d, nrDigits);
+		p += nrDigits;
+	}
+
+	return p - out;
+}
+
+/*
+ * Parses a decimal number. Numbers with up to 15 significant digits and a
+ * small exponent, which is what the exports hold, are converted exactly
+ * with a single multiplication or division; anything else is left to
+ * QByteArray::toDouble().
+ */
+static bool parseNumber(const char *begin, const char *end, double &value)
+{
+	const char *p = begin;
+	const bool negative = p < end && *p == '-';
+
+	if (p < end && (*p == '-' || *p == '+')) {
+		p++;
+	}
+
+	unsigned long long mantissa = 0;
+	int nrDigits = 0;
+	int exp10 = 0;
+	bool anyDigit = false;
+
+	for (; p < end && *p >= '0' && *p <= '9'; p++) {
+		if (nrDigits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			nrDigits += mantissa != 0;
+		} else {
+			exp10++;
+		}
+		anyDigit = true;
+	}
+
+	if (p < end && *p == '.') {
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (nrDigits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				nrDigits += mantissa != 0;
+				exp10--;
+			}
+			anyDigit = true;
+		}
+	}
+
+	if (anyDigit && p < end && (*p == 'e' || *p == 'E')) {
+		const bool negativeExp = ++p < end && *p == '-';
+		int exp = 0;
+		bool anyExpDigit = false;
+
+		if (p < end && (*p == '-' || *p == '+')) {
+			p++;
+		}
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			exp = std::min(exp * 10 + (*p - '0'), 100000);
+			anyExpDigit = true;
+		}
+
+		anyDigit = anyExpDigit;
+		exp10 += negativeExp ? -exp : exp;
+	}
+
+	if (anyDigit && p == end && nrDigits <= 15 && exp10 >= -22 && exp10 <= 22) {
+		value = scaleByPowerOf10(static_cast<double>(mantissa), exp10);
+		value = negative ? -value : value;
+		return true;
+	}
+
+	bool ok = false;
+	value = QByteArray::fromRawData(begin, end - begin).toDouble(&ok);
+	return ok;
+}
+
 FileManager::FileManager(QString toolName) :
 	hasHeader(false),
 	sampleRate(0),
 	nrOfSamples(0),
-	toolName(toolName)
+	fileType(CSV),
+	toolName(toolName),
+	compressed(false)
 {
 
 }
@@ -48,10 +287,6 @@ void FileManager::open(QString fileName,
 	//throws exception if the file is corrupted, has a header but not the scopy one
 	//columns with different sizes etc..
 
-	QVector<QVector<QString>> raw_data;
-	bool srOk = true;
-	bool dataOk = true;
-
 	openedFor = filepurpose;
 
 	if (fileName.endsWith(".csv")) {
@@ -61,12 +296,18 @@ void FileManager::open(QString fileName,
 		separator = "\t";
 		fileType = TXT;
 		//find sep to read txt files
+	} else if (fileName.endsWith(".scb")) {
+		fileType = BIN;
+	} else if (fileType == BIN) {
+		// Any other file is text
+		fileType = CSV;
 	}
 
 	//clear previous data if the manager was used for other exports
 	data.clear();
 	decoder_data.clear();
 	columnNames.clear();
+	columns.clear();
 	this->filename = fileName;
 
 	if (filepurpose == IMPORT) {
@@ -80,86 +321,13 @@ void FileManager::open(QString fileName,
 			throw FileManagerException("Can't open selected file");
 		}
 
-		QTextStream in(&file);
-
-		for (int i = 0; i < data.size(); ++i)
-			data[i].clear();
-
-		while (!in.atEnd()) {
-			QVector<QString> line_data;
-			QString line = in.readLine();
-			QStringList list = line.split(separator, QString::SkipEmptyParts);
-			for (const QString &list_item : qAsConst(list)) {
-				line_data.push_back(list_item);
-			}
-			if (line_data.size() > 0) {
-				raw_data.push_back(line_data);
-			}
+		if (fileType == BIN) {
+			readBinary(file);
+			nrOfSamples = data.size();
+			return;
 		}
 
-		//check if it has a header or not
-		/*
-		*  Header format
-		*
-		*       ;Scopy version <separator> abcdefg
-		*       ;Exported on <separator> Wed Apr 4 13:49:01 2018
-		*       ;Device <separator> M2K
-		*       ;Nr of samples <separator> 1234
-		*       ;Sample rate <separator> 1234 or 0 if it does not have samp. rate
-		*       ;Tool: <separator> Oscilloscope/ Spectrum ...
-		*       ;Additional Information
-		*/
-
-		hasHeader = ScopyFileHeader::hasValidHeader(raw_data);
-		if (hasHeader) {
-
-			format = SCOPY;
-
-			//first column in data is the time!!! when retrieving channel data start from data[1]
-			for (int i = 1; i < raw_data[6].size(); ++i) {
-				additionalInformation.push_back(raw_data[6][i]);
-			}
-
-			sampleRate = raw_data[4][1].toDouble(&srOk);
-			if (!srOk) {
-				throw FileManagerException("File is corrupted!");
-			}
-			//should be 0 if read from network/spectrum analyzer exported file
-
-			for (int j = 1; j < raw_data[7].size(); ++j)
-				columnNames.push_back(raw_data[7][j]);
-
-			data.resize(raw_data.size() - 8);
-			for (int i = 0; i < data.size(); ++i) {
-				data[i].resize(raw_data[i + 8].size() - 1);
-			}
-
-			for (int i = 8; i < raw_data.size(); ++i) {
-				for (int j = 1; j < raw_data[i].size(); ++j) {
-					data[i - 8][j - 1] = raw_data[i][j].toDouble(&dataOk);
-					if (!dataOk) {
-						throw FileManagerException("File is corrupted!");
-					}
-				}
-			}
-		} else {
-
-			format = RAW;
-
-			data.resize(raw_data.size());
-			for (int i = 0; i < data.size(); ++i) {
-				data[i].resize(raw_data[i].size());
-			}
-
-			for (int i = 0; i < raw_data.size(); ++i) {
-				for (int j = 0; j < raw_data[i].size(); ++j) {
-					data[i][j] = raw_data[i][j].toDouble(&dataOk);
-					if (!dataOk) {
-						throw FileManagerException("File is corrupted!");
-					}
-				}
-			}
-		}
+		readText(file);
 
 		nrOfSamples = data.size();
 	}
@@ -167,15 +335,19 @@ void FileManager::open(QString fileName,
 
 void FileManager::save(QVector<double> data, QString name)
 {
-	this->columnNames.push_back(name);
+	const size_t size = data.size();
 
-	if (this->data.size() == 0) {
-		this->data.resize(data.size());
-	}
+	save([data](size_t first, size_t count, double *dest) {
+		std::copy(data.constBegin() + first, data.constBegin() + first + count, dest);
+	}, size, name);
+}
 
-	for (int i = 0; i < data.size(); ++i) {
-		this->data[i].push_back(data[i]);
-	}
+void FileManager::save(ColumnReader reader, size_t size, QString name)
+{
+	const Column column = { reader, size };
+
+	columns.push_back(column);
+	columnNames.push_back(name);
 }
 
 void FileManager::save(QVector<QVector<double>> data, QVector<QVector<QString>> decoder_data, QStringList columnNames)
@@ -278,65 +450,470 @@ int FileManager::getNrOfChannels() const
 	}
 }
 
-void FileManager::performWrite()
+bool FileManager::performWrite()
 {
-	QString additionalInfo = "";
 	if (openedFor == IMPORT) {
 		qDebug() << "Can't write when opened for import!";
+		return false;
+	}
+
+	prepareColumns();
+
+	return fileType == BIN ? writeBinary() : writeText();
+}
+
+void FileManager::setProgressHandler(ProgressHandler handler)
+{
+	progressHandler = handler;
+}
+
+void FileManager::prepareColumns()
+{
+	// Tables saved row by row are read through the same interface as
+	// the streamed columns
+	if (!columns.isEmpty() || data.isEmpty()) {
 		return;
 	}
 
-	QFile exportFile(filename);
-	exportFile.open(QIODevice::WriteOnly);
-	QTextStream exportStream(&exportFile);
+	for (int col = 0; col < data[0].size(); ++col) {
+		const Column column = {
+			[this, col](size_t first, size_t count, double *dest) {
+				for (size_t i = 0; i < count; ++i) {
+					dest[i] = data[first + i].value(col);
+				}
+			},
+			size_t(data.size())
+		};
+
+		columns.push_back(column);
+	}
+}
+
+size_t FileManager::nrOfRows() const
+{
+	size_t rows = decoder_data.size();
+
+	for (const Column &column : columns) {
+		rows = std::max(rows, column.size);
+	}
+
+	return rows;
+}
+
+void FileManager::fillBlock(size_t first, size_t count, QVector<double> &block) const
+{
+	// Column by column; the rows past the end of a shorter column are NaN
+	block.resize(count * columns.size());
 
-	additionalInfo = (additionalInformation.size() != 0) ? additionalInformation[0] : "";
+	for (int col = 0; col < columns.size(); ++col) {
+		double *dest = block.data() + col * count;
+		const size_t size = columns[col].size;
+		const size_t available = first < size ? std::min(count, size - first) : 0;
 
-	QStringList header = ScopyFileHeader::getHeader();
+		if (available) {
+			columns[col].read(first, available, dest);
+		}
+		std::fill(dest + available, dest + count, NAN);
+	}
+}
+
+bool FileManager::reportProgress(size_t done, size_t total) const
+{
+	return !progressHandler || progressHandler(total ? int(100 * done / total) : 100);
+}
+
+bool FileManager::writeText()
+{
+	QFile exportFile(filename);
+	if (!exportFile.open(QIODevice::WriteOnly)) {
+		qDebug() << "Can't open" << filename << "for writing";
+		return false;
+	}
+
+	const size_t rows = nrOfRows();
+	const QString additionalInfo = (additionalInformation.size() != 0) ? additionalInformation[0] : "";
+	const QStringList header = ScopyFileHeader::getHeader();
 
 	//prepare header
-	exportStream << header[0] << separator << QString(SCOPY_VERSION_GIT) << "\n";
-	exportStream << header[1] << separator << QDate::currentDate().toString("dddd MMMM dd/MM/yyyy") << "\n";
-	exportStream << header[2] << separator << "M2K" << "\n";
-	exportStream << header[3] << separator << data.size() << "\n";
-	exportStream << header[4] << separator << sampleRate << "\n";
-	exportStream << header[5] << separator << toolName << "\n";
-	exportStream << header[6] << separator << additionalInfo << "\n";
+	QString headerText;
+	QTextStream headerStream(&headerText);
+
+	headerStream << header[0] << separator << QString(SCOPY_VERSION_GIT) << "\n";
+	headerStream << header[1] << separator << QDate::currentDate().toString("dddd MMMM dd/MM/yyyy") << "\n";
+	headerStream << header[2] << separator << "M2K" << "\n";
+	headerStream << header[3] << separator << qulonglong(rows) << "\n";
+	headerStream << header[4] << separator << sampleRate << "\n";
+	headerStream << header[5] << separator << toolName << "\n";
+	headerStream << header[6] << separator << additionalInfo << "\n";
 
 	//column names row
-	exportStream << "Sample" << separator;
-	bool skipFirstSeparator=true;
-	for (const QString &columnName : qAsConst(columnNames)) {
-		if(!skipFirstSeparator)
-			exportStream << separator;
-		exportStream << columnName;
-		skipFirstSeparator = false;
+	headerStream << "Sample" << separator << columnNames.join(separator) << "\n";
+	headerStream.flush();
+
+	if (exportFile.write(headerText.toUtf8()) < 0) {
+		return false;
 	}
-	exportStream << "\n";
 
-	for (int i = 0; i < data.size(); ++i) {
-		skipFirstSeparator = true;
-		exportStream << QString::number(i) << separator;
-		for (int j = 0; j < data[i].size(); ++j) {
-			if(!skipFirstSeparator)
-				exportStream << separator;
-			exportStream << data[i][j];
-			skipFirstSeparator = false;
-		}
+	// The values are formatted straight into a bounded buffer, a block
+	// of rows at a time
+	const char sep = separator.isEmpty() ? ',' : separator.at(0).toLatin1();
+	std::string out;
+	QVector<double> block;
 
-		if (!decoder_data.isEmpty()) {
-			for (int j = 0; j < decoder_data[i].size(); ++j) {
-				if(!skipFirstSeparator)
-					exportStream << separator;
-				if (!decoder_data[i][j].isEmpty()) {
-					exportStream << "\"" << decoder_data[i][j] << "\"";
+	out.reserve(TEXT_WRITE_BUFFER + 4096);
+
+	for (size_t first = 0; first < rows; first += TEXT_BLOCK_ROWS) {
+		const size_t count = std::min<size_t>(rows - first, TEXT_BLOCK_ROWS);
+
+		fillBlock(first, count, block);
+
+		for (size_t i = 0; i < count; ++i) {
+			const size_t row = first + i;
+			bool skipFirstSeparator = true;
+			char number[32];
+
+			out.append(number, formatUnsigned(row, number));
+			out += sep;
+
+			for (int col = 0; col < columns.size(); ++col) {
+				if (row >= columns[col].size) {
+					continue;
+				}
+				if (!skipFirstSeparator) {
+					out += sep;
 				}
+				out.append(number, formatNumber(block[col * count + i], number));
 				skipFirstSeparator = false;
-			}}
-		exportStream << "\n";
+			}
+
+			if (row < size_t(decoder_data.size())) {
+				for (const QString &value : decoder_data[row]) {
+					if (!skipFirstSeparator) {
+						out += sep;
+					}
+					if (!value.isEmpty()) {
+						out += '"';
+						out += value.toStdString();
+						out += '"';
+					}
+					skipFirstSeparator = false;
+				}
+			}
+			out += '\n';
+		}
+
+		if (out.size() >= TEXT_WRITE_BUFFER) {
+			if (exportFile.write(out.data(), out.size()) < 0) {
+				return false;
+			}
+			out.clear();
+		}
+
+		if (!reportProgress(first + count, rows)) {
+			exportFile.remove();
+			return false;
+		}
+	}
+
+	if (exportFile.write(out.data(), out.size()) < 0) {
+		return false;
+	}
+
+	exportFile.close();
+	return true;
+}
+
+void FileManager::readText(QFile &file)
+{
+	const char sep = separator.isEmpty() ? ',' : separator.at(0).toLatin1();
+	const QString splitSeparator(QChar::fromLatin1(sep));
+
+	/*
+	 *  Header format
+	 *
+	 *       ;Scopy version <separator> abcdefg
+	 *       ;Exported on <separator> Wed Apr 4 13:49:01 2018
+	 *       ;Device <separator> M2K
+	 *       ;Nr of samples <separator> 1234
+	 *       ;Sample rate <separator> 1234 or 0 if it does not have samp. rate
+	 *       ;Tool: <separator> Oscilloscope/ Spectrum ...
+	 *       ;Additional Information
+	 *       Sample <separator> column names
+	 *
+	 * The first lines are kept as text until it is known whether they
+	 * are the header; every other line goes straight to numbers.
+	 */
+	const int headerLines = ScopyFileHeader::getHeader().size() + 1;
+	QVector<QVector<QString>> headerFields;
+	QVector<QByteArray> pending;
+	bool headerChecked = false;
+	int firstField = 0;
+
+	auto parseLine = [&](const char *begin, const char *end) {
+		QVector<double> row;
+		int field = 0;
+
+		for (const char *p = begin; p <= end; ) {
+			const char *next = std::find(p, end, sep);
+			const char *fieldEnd = next;
+
+			while (p < fieldEnd && isspace(static_cast<unsigned char>(*p))) {
+				p++;
+			}
+			while (fieldEnd > p && isspace(static_cast<unsigned char>(fieldEnd[-1]))) {
+				fieldEnd--;
+			}
+
+			if (p != fieldEnd && field++ >= firstField) {
+				double value;
+
+				if (!parseNumber(p, fieldEnd, value)) {
+					throw FileManagerException("File is corrupted!");
+				}
+				row.push_back(value);
+			}
+
+			p = next + 1;
+		}
+
+		if (field) {
+			data.push_back(row);
+		}
+	};
+
+	auto checkHeader = [&]() {
+		headerChecked = true;
+		hasHeader = ScopyFileHeader::hasValidHeader(headerFields);
+
+		if (!hasHeader) {
+			format = RAW;
+
+			for (const QByteArray &line : qAsConst(pending)) {
+				parseLine(line.constData(), line.constData() + line.size());
+			}
+			return;
+		}
+
+		format = SCOPY;
+
+		for (int i = 1; i < headerFields[6].size(); ++i) {
+			additionalInformation.push_back(headerFields[6][i]);
+		}
+
+		//should be 0 if read from network/spectrum analyzer exported file
+		bool srOk = headerFields[4].size() > 1;
+		sampleRate = srOk ? headerFields[4][1].toDouble(&srOk) : 0;
+		if (!srOk) {
+			throw FileManagerException("File is corrupted!");
+		}
+
+		//first column in data is the sample index, it is skipped
+		if (headerFields.size() == headerLines) {
+			for (int j = 1; j < headerFields[7].size(); ++j) {
+				columnNames.push_back(headerFields[7][j]);
+			}
+		}
+		firstField = 1;
+	};
+
+	auto addLine = [&](const char *begin, const char *end) {
+		if (headerChecked) {
+			parseLine(begin, end);
+			return;
+		}
+
+		const QStringList fields = QString::fromUtf8(begin, end - begin).trimmed()
+				.split(splitSeparator, QString::SkipEmptyParts);
+
+		if (fields.isEmpty()) {
+			return;
+		}
+
+		headerFields.push_back(fields.toVector());
+		pending.push_back(QByteArray(begin, end - begin));
+
+		if (headerFields.size() == headerLines) {
+			checkHeader();
+		}
+	};
+
+	QByteArray buffer;
+
+	while (!file.atEnd()) {
+		buffer += file.read(TEXT_READ_BLOCK);
+
+		const char *begin = buffer.constData();
+		const char *end = begin + buffer.size();
+		const char *line = begin;
+
+		for (const char *eol; (eol = static_cast<const char *>(memchr(line, '\n', end - line))); line = eol + 1) {
+			addLine(line, eol);
+		}
+
+		buffer.remove(0, line - begin);
+	}
+
+	if (!buffer.isEmpty()) {
+		addLine(buffer.constData(), buffer.constData() + buffer.size());
+	}
+
+	if (!headerChecked) {
+		checkHeader();
+	}
+}
+
+bool FileManager::writeBinary()
+{
+	QFile exportFile(filename);
+	if (!exportFile.open(QIODevice::WriteOnly)) {
+		qDebug() << "Can't open" << filename << "for writing";
+		return false;
+	}
+
+	const size_t rows = nrOfRows();
+	const quint32 nrOfColumns = columns.size();
+
+	QDataStream out(&exportFile);
+	out.setByteOrder(QDataStream::LittleEndian);
+	out.setVersion(QDataStream::Qt_5_0);
+
+	out.writeRawData(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+	out << quint32(BINARY_VERSION)
+	    << QString(SCOPY_VERSION_GIT)
+	    << QDate::currentDate().toString("dddd MMMM dd/MM/yyyy")
+	    << QString("M2K")
+	    << toolName
+	    << additionalInformation
+	    << sampleRate
+	    << quint64(rows)
+	    << columnNames
+	    << nrOfColumns
+	    << quint32(BINARY_BLOCK_SAMPLES);
+
+	const char padding[8] = {};
+	QVector<double> block;
+
+	for (size_t first = 0; first < rows; first += BINARY_BLOCK_SAMPLES) {
+		const size_t count = std::min<size_t>(rows - first, BINARY_BLOCK_SAMPLES);
+
+		fillBlock(first, count, block);
+
+		QByteArray payload = QByteArray::fromRawData(
+					reinterpret_cast<const char *>(block.constData()),
+					block.size() * sizeof(double));
+		quint32 flags = 0;
+
+		if (compressed) {
+			payload = qCompress(payload);
+			flags |= BINARY_BLOCK_COMPRESSED;
+		}
+
+		out.writeRawData(padding, alignTo8(exportFile.pos()) - exportFile.pos());
+		out << flags << quint32(count) << quint64(payload.size());
+		out.writeRawData(payload.constData(), payload.size());
+
+		if (out.status() != QDataStream::Ok) {
+			return false;
+		}
+
+		if (!reportProgress(first + count, rows)) {
+			exportFile.remove();
+			return false;
+		}
 	}
 
 	exportFile.close();
+	return true;
+}
+
+void FileManager::readBinary(QFile &file)
+{
+	const qint64 size = file.size();
+	const uchar *map = file.map(0, size);
+
+	if (!map) {
+		throw FileManagerException("Can't open selected file");
+	}
+
+	QDataStream in(QByteArray::fromRawData(reinterpret_cast<const char *>(map), size));
+	in.setByteOrder(QDataStream::LittleEndian);
+	in.setVersion(QDataStream::Qt_5_0);
+
+	char magic[BINARY_MAGIC_SIZE];
+	quint32 version = 0;
+
+	if (in.readRawData(magic, BINARY_MAGIC_SIZE) != BINARY_MAGIC_SIZE ||
+			memcmp(magic, BINARY_MAGIC, BINARY_MAGIC_SIZE)) {
+		throw FileManagerException("File is corrupted!");
+	}
+
+	in >> version;
+	if (version != BINARY_VERSION) {
+		throw FileManagerException("Unsupported file version!");
+	}
+
+	QString scopyVersion, date, device, tool;
+	quint64 samples = 0;
+	quint32 nrOfColumns = 0, blockSamples = 0;
+
+	additionalInformation.clear();
+	in >> scopyVersion >> date >> device >> tool >> additionalInformation
+	   >> sampleRate >> samples >> columnNames >> nrOfColumns >> blockSamples;
+
+	if (in.status() != QDataStream::Ok || (samples && !nrOfColumns)) {
+		throw FileManagerException("File is corrupted!");
+	}
+
+	qint64 pos = in.device()->pos();
+
+	while (quint64(data.size()) < samples) {
+		pos = alignTo8(pos);
+		if (pos + BINARY_BLOCK_HEADER_SIZE > size) {
+			throw FileManagerException("File is corrupted!");
+		}
+
+		quint32 flags, count;
+		quint64 stored;
+
+		memcpy(&flags, map + pos, sizeof(flags));
+		memcpy(&count, map + pos + 4, sizeof(count));
+		memcpy(&stored, map + pos + 8, sizeof(stored));
+		pos += BINARY_BLOCK_HEADER_SIZE;
+
+		if (!count || count > blockSamples || stored > quint64(size - pos)) {
+			throw FileManagerException("File is corrupted!");
+		}
+
+		// Uncompressed payloads are 8 byte aligned within the mapping
+		// and are used as they are
+		QByteArray payload;
+		const double *values = reinterpret_cast<const double *>(map + pos);
+		quint64 bytes = stored;
+
+		if (flags & BINARY_BLOCK_COMPRESSED) {
+			payload = qUncompress(map + pos, static_cast<int>(stored));
+			values = reinterpret_cast<const double *>(payload.constData());
+			bytes = payload.size();
+		}
+
+		if (bytes != quint64(count) * nrOfColumns * sizeof(double)) {
+			throw FileManagerException("File is corrupted!");
+		}
+
+		for (quint32 i = 0; i < count; ++i) {
+			QVector<double> row(nrOfColumns);
+
+			for (quint32 col = 0; col < nrOfColumns; ++col) {
+				row[col] = values[quint64(col) * count + i];
+			}
+			data.push_back(row);
+		}
+
+		pos += stored;
+	}
+
+	hasHeader = true;
+	format = SCOPY;
 }
 
 void FileManager::performDecoderWrite(bool skip_empty_lines)
@@ -418,6 +995,16 @@ void FileManager::setFormat(const FileManager::FileFormat &value)
 	format = value;
 }
 
+bool FileManager::getCompressed() const
+{
+	return compressed;
+}
+
+void FileManager::setCompressed(bool value)
+{
+	compressed = value;
+}
+
 bool ScopyFileHeader::hasValidHeader(QVector<QVector<QString>> data)
 {
 
@@ -26,8 +26,11 @@
 #include <QStringList>
 
 #include <exception>
+#include <functional>
 #include <iostream>
 
+class QFile;
+
 
 namespace adiscope {
 class FileManager
@@ -46,9 +49,16 @@ public:
 
 	enum FileType {
 		CSV,
-		TXT
+		TXT,
+		BIN
 	};
 
+	/* Fills 'dest' with 'count' values of a column, starting at row 'first' */
+	typedef std::function<void(size_t first, size_t count, double *dest)> ColumnReader;
+
+	/* Gets the percentage written so far; returning false cancels the write */
+	typedef std::function<bool(int percent)> ProgressHandler;
+
 	FileManager(QString toolName);
 	~FileManager();
 
@@ -58,6 +68,10 @@ public:
 	void save(QVector<QVector<double>> data, QVector<QVector<QString>> decoder_data, QStringList column_names);
 	void save(QVector<QVector<double>> data, QStringList column_names);
 
+	/* Column that is read a chunk at a time while the file is written,
+	 * so it never has to be copied as a whole */
+	void save(ColumnReader reader, size_t size, QString name);
+
 	QVector<double> read(int index);
 	QVector<QVector<double>> read();
 
@@ -70,16 +84,39 @@ public:
 	double getNrOfSamples() const;
 	int getNrOfChannels() const;
 
-	void performWrite();
+	/* Returns false if the file couldn't be written or the write was
+	 * cancelled; can be run on a worker thread */
+	bool performWrite();
 	void performDecoderWrite(bool skip_empty_lines = false);
 
+	void setProgressHandler(ProgressHandler handler);
+
 	QStringList getAdditionalInformation() const;
 	void setAdditionalInformation(const QString& value);
 
 	FileFormat getFormat() const;
 	void setFormat(const FileFormat &value);
 
+	/* Compress the data blocks of binary files; compressed files
+	 * can't be read in place from the mapping */
+	bool getCompressed() const;
+	void setCompressed(bool value);
+
 private:
+	struct Column {
+		ColumnReader read;
+		size_t size;
+	};
+
+	void readText(QFile &file);
+	void readBinary(QFile &file);
+	bool writeText();
+	bool writeBinary();
+
+	void prepareColumns();
+	size_t nrOfRows() const;
+	void fillBlock(size_t first, size_t count, QVector<double> &block) const;
+	bool reportProgress(size_t done, size_t total) const;
 
 	QVector<QVector<double>> data;
 	QVector<QVector<QString>> decoder_data;
@@ -94,6 +131,9 @@ private:
 	QString separator;
 	QString toolName;
 	QStringList additionalInformation;
+	bool compressed;
+	QVector<Column> columns;
+	ProgressHandler progressHandler;
 
 };
 
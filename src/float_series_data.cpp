@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2019 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "float_series_data.h"
+
+#include <algorithm>
+
+using namespace adiscope;
+
+FloatSeriesData::FloatSeriesData(const double *x, const float *y, size_t size)
+	: m_x(x)
+	, m_y(y)
+	, m_size(size)
+	, m_ymin(0)
+	, m_ymax(0)
+	, m_range_valid(false)
+	, m_lod_valid(false)
+{
+}
+
+size_t FloatSeriesData::size() const
+{
+	return m_size;
+}
+
+QPointF FloatSeriesData::sample(size_t index) const
+{
+	return QPointF(m_x[index], m_y[index]);
+}
+
+QRectF FloatSeriesData::boundingRect() const
+{
+	if (m_size == 0) {
+		return QRectF(1.0, 1.0, -2.0, -2.0); // invalid
+	}
+
+	// The samples never change under us, so their range is computed once
+	if (!m_range_valid) {
+		m_ymin = m_y[0];
+		m_ymax = m_y[0];
+
+		for (size_t i = 1; i < m_size; i++) {
+			const float y = m_y[i];
+
+			// NaN compares false both ways and is left out
+			if (y < m_ymin) {
+				m_ymin = y;
+			}
+			if (y > m_ymax) {
+				m_ymax = y;
+			}
+		}
+		m_range_valid = true;
+	}
+
+	// The X axis is monotonic, only its ends matter
+	const double xmin = std::min(m_x[0], m_x[m_size - 1]);
+	const double xmax = std::max(m_x[0], m_x[m_size - 1]);
+
+	return QRectF(QPointF(xmin, m_ymin), QPointF(xmax, m_ymax));
+}
+
+const double *FloatSeriesData::xData() const
+{
+	return m_x;
+}
+
+const float *FloatSeriesData::yData() const
+{
+	return m_y;
+}
+
+bool FloatSeriesData::minMax(size_t first, size_t last, float &min, float &max) const
+{
+	if (!m_lod_valid) {
+		for (size_t start = 0; start < m_size; start += MinMaxIndex::BASE_SIZE) {
+			MinMaxBucket &bucket = m_lod.baseBucket(start);
+			const size_t end = std::min(start + MinMaxIndex::BASE_SIZE, m_size);
+
+			for (size_t i = start; i < end; i++) {
+				bucket.add(m_y[i]);
+			}
+		}
+		m_lod.commit(0);
+		m_lod_valid = true;
+	}
+
+	last = std::min(last, m_size);
+
+	size_t headEnd, tailStart;
+	MinMaxBucket range = m_lod.query(first, last, headEnd, tailStart);
+
+	for (size_t i = first; i < headEnd; i++) {
+		range.add(m_y[i]);
+	}
+	for (size_t i = std::max(tailStart, headEnd); i < last; i++) {
+		range.add(m_y[i]);
+	}
+
+	if (range.empty()) {
+		return false;
+	}
+
+	min = range.min;
+	max = range.max;
+
+	return true;
+}
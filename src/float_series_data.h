@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2019 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLOAT_SERIES_DATA_H
+#define FLOAT_SERIES_DATA_H
+
+#include <qwt_series_data.h>
+
+#include "lod_index.h"
+
+namespace adiscope {
+
+/*
+ * Curve data made of a double X axis and float samples, both owned by
+ * someone else (like QwtCPointerData). Lets the curves draw float32
+ * captures directly instead of widening every frame to double.
+ */
+class FloatSeriesData : public QwtSeriesData<QPointF>
+{
+public:
+	FloatSeriesData(const double *x, const float *y, size_t size);
+
+	size_t size() const;
+	QPointF sample(size_t index) const;
+	QRectF boundingRect() const;
+
+	const double *xData() const;
+	const float *yData() const;
+
+	/* Range of the samples in [first, last); returns false when they
+	 * are all NaN */
+	bool minMax(size_t first, size_t last, float &min, float &max) const;
+
+private:
+	const double *m_x;
+	const float *m_y;
+	size_t m_size;
+
+	mutable float m_ymin;
+	mutable float m_ymax;
+	mutable bool m_range_valid;
+
+	// Built on the first range query, the samples never change
+	mutable MinMaxIndex m_lod;
+	mutable bool m_lod_valid;
+};
+}
+
+#endif // FLOAT_SERIES_DATA_H
@@ -32,7 +32,8 @@ frequency_compensation_filter_impl::frequency_compensation_filter_impl(
 	: sync_block("overshoot_filter",
 		     io_signature::make(1,1, sizeof(short)),
 		     io_signature::make(1, 1, sizeof(short))),
-	  sample_rate(sample_rate), high_gain(false)
+	  sample_rate(sample_rate), high_gain(false),
+	  state_valid(false), prev_in(0), prev_out(0)
 
 {
 	for (auto i=0; i < 2; i++) {
@@ -53,35 +54,53 @@ frequency_compensation_filter::make(bool enable, float TC, float gain,
 			       sample_rate));
 }
 
+bool frequency_compensation_filter_impl::start()
+{
+	state_valid = false;
+	return sync_block::start();
+}
+
 int
 frequency_compensation_filter_impl::work(int noutput_items,
 		gr_vector_const_void_star& input_items,
 		gr_vector_void_star& output_items)
 {
 	const short *in = (const short *) input_items[0];
-	float *out_f = new float[noutput_items];
 	short *out = (short *) output_items[0];
 
+	if (!config[high_gain].enable) {
+		memcpy(out,in,noutput_items*sizeof(short));
+		state_valid = false;
+		return noutput_items;
+	}
+
 	float delta = 1.0 / sample_rate;
 	float TC1 = config[high_gain].TC * float(1.0E-6);
 	float Alpha = TC1/(TC1+delta);
-	out_f[0]=(in[1]-in[0]);
-	int i = 1;
-
-	if (config[high_gain].enable) {
-		for (i = 1; i < noutput_items; i++) {
-			out_f[i]=(Alpha*(out_f[i-1]+(float)(in[i]-in[i-1])));
-		}
+	float gain = config[high_gain].gain;
+
+	// The filter picks up where the previous call left it; a new stream
+	// starts from rest
+	if (!state_valid) {
+		prev_in = in[0];
+		prev_out = 0;
+		state_valid = true;
+	}
 
-		for (i = 0; i < noutput_items; i++) {
-			out[i]=in[i]+(short)((out_f[i])*config[high_gain].gain);
-		}
+	// The filter is recursive, so the compensation is mixed back in
+	// the same pass instead of going through a temporary buffer
+	float y = prev_out;
+	short x_prev = prev_in;
 
-	} else {
-		memcpy(out,in,noutput_items*sizeof(short));
+	for (int i = 0; i < noutput_items; i++) {
+		y = Alpha*(y+(float)(in[i]-x_prev));
+		x_prev = in[i];
+		out[i]=in[i]+(short)(y*gain);
 	}
 
-	delete []out_f;
+	prev_out = y;
+	prev_in = x_prev;
+
 	return noutput_items;
 }
 
@@ -151,6 +170,10 @@ bool frequency_compensation_filter_impl::get_high_gain()
 }
 void frequency_compensation_filter_impl::set_high_gain(bool en)
 {
+	if (this->high_gain != en) {
+		state_valid = false;
+	}
+
 	this->high_gain=en;
 }
 }
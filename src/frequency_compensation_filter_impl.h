@@ -39,10 +39,16 @@ private:
 	float sample_rate;
 	bool high_gain;
 
+	// Filter state carried over between work() calls
+	bool state_valid;
+	short prev_in;
+	float prev_out;
+
 public:
 	typedef std::shared_ptr<frequency_compensation_filter> sptr;
 	frequency_compensation_filter_impl(bool enable, float TC, float gain,
 					   float sample_rate);
+	bool start();
 	int work(int noutput_items,
 		 gr_vector_const_void_star& input_items,
 		 gr_vector_void_star& output_items);
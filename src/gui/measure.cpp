@@ -19,6 +19,7 @@
  */
 
 #include "measure.h"
+#include "simd.h"
 #include <fstream>
 #include <cmath>
 #include "adc_sample_conv.hpp"
@@ -26,7 +27,11 @@
 #include <QDebug>
 #include <QObject>
 #include <string>
+#include <volk/volk.h>
 #include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 
 using namespace adiscope;
 
@@ -34,13 +39,11 @@ namespace adiscope {
 	class CrossPoint
 	{
 		public:
-		CrossPoint(float value, size_t bufIndex, bool onRising, QString name):
+		CrossPoint(float value, size_t bufIndex, bool onRising, char level):
 			m_value(value),
 			m_bufIdx(bufIndex),
 			m_onRising(onRising),
-			m_name(name)
-
-
+			m_level(level)
 		{
 		}
 
@@ -48,7 +51,7 @@ namespace adiscope {
 		float m_value;
 		size_t m_bufIdx;
 		bool m_onRising;
-		QString m_name;
+		char m_level;
 	};
 
 	class HystLevelCross
@@ -194,7 +197,7 @@ namespace adiscope {
 	{
 	public:
 		CrossingDetection(double level, double hysteresis_span,
-				const QString &name):
+				char name):
 			m_posCrossFound(false),
 			m_negCrossFound(false),
 			m_crossed(false),
@@ -237,12 +240,12 @@ namespace adiscope {
 			}
 		}
 
-		void setExternalList(QList<CrossPoint> *externList)
+		void setExternalList(std::vector<CrossPoint> *externList)
 		{
 			m_externList = externList;
 		}
 
-		QList<CrossPoint> detectedCrossings()
+		const std::vector<CrossPoint> &detectedCrossings() const
 		{
 			return m_detectedCrossings;
 		}
@@ -303,9 +306,9 @@ namespace adiscope {
 							m_posCrossPoint = i;
 						m_detectedCrossings.push_back(
 							CrossPoint(data[m_posCrossPoint], m_posCrossPoint,
-								true, m_name + "R"));
+								true, m_name));
 						if (m_externList)
-							m_externList->push_back(m_detectedCrossings.last());
+							m_externList->push_back(m_detectedCrossings.back());
 					}
 				}
 				if (!m_negCrossFound) {
@@ -321,9 +324,9 @@ namespace adiscope {
 							m_negCrossPoint = i - 1;
 						m_detectedCrossings.push_back(
 							CrossPoint(data[m_negCrossPoint], m_negCrossPoint,
-								false, m_name + "F"));
+								false, m_name));
 						if (m_externList)
-							m_externList->push_back(m_detectedCrossings.last());
+							m_externList->push_back(m_detectedCrossings.back());
 					}
 				}
 			}
@@ -345,10 +348,10 @@ namespace adiscope {
 		size_t m_posCrossPoint;
 		size_t m_negCrossPoint;
 
-		QList<CrossPoint> m_detectedCrossings;
-		QList<CrossPoint> *m_externList;
+		std::vector<CrossPoint> m_detectedCrossings;
+		std::vector<CrossPoint> *m_externList;
 
-		QString m_name;
+		char m_name;
 	};
 
 	class SpectralDetection {
@@ -719,18 +722,125 @@ namespace adiscope {
 	};
 }
 
+namespace {
+	using simd::v4df;
+	using simd::v4di;
+
+	struct SampleStats
+	{
+		double min;
+		double max;
+		double sum;
+		double sqr_sum;
+		size_t count;
+	};
+
+	/*
+	 * Min, max, sum, sum of squares and number of the samples that are
+	 * not NaN, together with the histogram of their ADC codes, computed
+	 * in a single pass four samples at a time. The code of a sample is
+	 * rawGain * sample + rawOffset, truncated and moved up by half of the
+	 * ADC span. Each lane has a histogram of its own so that long runs of
+	 * the same code don't all wait on one counter.
+	 */
+	SampleStats sampleStats(const double *data, size_t length,
+				double rawGain, double rawOffset,
+				std::vector<int> *histogram)
+	{
+		const int span = histogram ? histogram->size() : 0;
+		const int hlfScale = span / 2;
+		const double rawLow = -hlfScale - 1;
+		const double rawHigh = span - hlfScale;
+		std::vector<int> laneHistograms(simd::LANES * span);
+
+		const v4df gain = simd::broadcast(rawGain);
+		const v4df offset = simd::broadcast(rawOffset);
+		v4df vmin = simd::broadcast(INFINITY);
+		v4df vmax = -vmin;
+		v4df vsum = {};
+		v4df vsqr = {};
+		v4di vcount = {};
+		size_t i = 0;
+
+		for (; i + simd::LANES <= length; i += simd::LANES) {
+			const v4df v = simd::load(data + i);
+
+			// NaN compares false, which leaves it out of min and
+			// max and zeroes it in the sums
+			const v4di valid = (v4di)(v == v);
+			const v4df clean = (v4df)((v4di)v & valid);
+
+			vmin = simd::min(v, vmin);
+			vmax = simd::max(v, vmax);
+			vsum += clean;
+			vsqr += clean * clean;
+			vcount -= valid;
+
+			if (span) {
+				const v4df raw = v * gain + offset;
+
+				for (unsigned int lane = 0; lane < simd::LANES; lane++) {
+					if (raw[lane] > rawLow && raw[lane] < rawHigh) {
+						laneHistograms[lane * span + (int)raw[lane] + hlfScale]++;
+					}
+				}
+			}
+		}
+
+		SampleStats stats;
+		stats.min = std::min(std::min(vmin[0], vmin[1]), std::min(vmin[2], vmin[3]));
+		stats.max = std::max(std::max(vmax[0], vmax[1]), std::max(vmax[2], vmax[3]));
+		stats.sum = (vsum[0] + vsum[1]) + (vsum[2] + vsum[3]);
+		stats.sqr_sum = (vsqr[0] + vsqr[1]) + (vsqr[2] + vsqr[3]);
+		stats.count = vcount[0] + vcount[1] + vcount[2] + vcount[3];
+
+		for (; i < length; i++) {
+			const double value = data[i];
+
+			if (qIsNaN(value)) {
+				continue;
+			}
+
+			stats.min = std::min(stats.min, value);
+			stats.max = std::max(stats.max, value);
+			stats.sum += value;
+			stats.sqr_sum += value * value;
+			stats.count++;
+
+			if (span) {
+				const double raw = value * rawGain + rawOffset;
+
+				if (raw > rawLow && raw < rawHigh) {
+					laneHistograms[(int)raw + hlfScale]++;
+				}
+			}
+		}
+
+		for (int code = 0; code < span; code++) {
+			(*histogram)[code] = laneHistograms[code] +
+				laneHistograms[span + code] +
+				laneHistograms[2 * span + code] +
+				laneHistograms[3 * span + code];
+		}
+
+		return stats;
+	}
+}
+
 Measure::Measure(int channel, double *buffer, size_t length,
 		 const std::function<double(unsigned int, double, bool)> &conversion_fct, bool isTimeDomain):
 	m_channel(channel),
 	m_buffer(buffer),
+	m_fbuffer(nullptr),
 	m_buf_length(length),
 	m_sample_rate(1.0),
 	m_adc_bit_count(0),
 	m_cross_level(0),
 	m_hysteresis_span(0),
-	m_histogram(nullptr),
-	m_cross_detect(nullptr),
 	m_gatingEnabled(false),
+	m_has_conversion(false),
+	m_volts_per_raw(0),
+	m_raw_zero_volts(0),
 	m_conversion_function(conversion_fct),
 	m_isTimeDomain(isTimeDomain),
 	m_harmonics_number(5)
@@ -808,22 +918,36 @@ Measure::Measure(int channel, double *buffer, size_t length,
 void Measure::setConversionFunction(const std::function<double(unsigned int, double, bool)> &fp)
 {
 	m_conversion_function = fp;
+	m_has_conversion = false;
+}
 
+void Measure::updateConversion()
+{
+	// Volts are an affine function of the ADC code; two codes far apart
+	// give its coefficients, so the samples are converted without going
+	// through the device for each of them
+	const int span = 2048;
+	const double zero = m_conversion_function(m_channel, 0, true);
+	const double full = m_conversion_function(m_channel, span, true);
+
+	m_raw_zero_volts = zero;
+	m_volts_per_raw = (full - zero) / span;
+	m_has_conversion = (m_volts_per_raw != 0);
 }
 
-bool Measure::highLowFromHistogram(double &low, double &high,
-		double min, double max)
+bool Measure::highLowFromHistogram(const std::vector<int> &histogram,
+		double &low, double &high, double min, double max)
 {
 	bool success = false;
-	int *hist = m_histogram;
+	const int *hist = histogram.data();
 	int adc_span = 1 << m_adc_bit_count;
 	int hlf_scale = adc_span / 2;
 	int minRaw = min;
 	int maxRaw = max;
 
-	if (m_conversion_function) {
-		minRaw = m_conversion_function(m_channel, min, false);
-		maxRaw = m_conversion_function(m_channel, max, false);
+	if (m_has_conversion) {
+		minRaw = (min - m_raw_zero_volts) / m_volts_per_raw;
+		maxRaw = (max - m_raw_zero_volts) / m_volts_per_raw;
 	}
 
 	minRaw += hlf_scale;
@@ -846,9 +970,9 @@ bool Measure::highLowFromHistogram(double &low, double &high,
 		int lowTmp = lowRaw - hlf_scale;
 		int highTmp = highRaw - hlf_scale;
 
-		if (m_conversion_function) {
-			low = m_conversion_function(m_channel, lowTmp, true);
-			high = m_conversion_function(m_channel, highTmp, true);
+		if (m_has_conversion) {
+			low = m_raw_zero_volts + lowTmp * m_volts_per_raw;
+			high = m_raw_zero_volts + highTmp * m_volts_per_raw;
 		}
 		success = true;
 	}
@@ -865,17 +989,97 @@ void Measure::clearMeasurements()
 void Measure::setDataSource(double *buffer, size_t length)
 {
 	m_buffer = buffer;
+	m_fbuffer = nullptr;
+	m_owner.reset();
 	m_buf_length = length;
 }
 
+void Measure::setDataSource(const float *buffer, size_t length,
+			    const std::shared_ptr<const void> &owner)
+{
+	m_buffer = nullptr;
+	m_fbuffer = buffer;
+	m_owner = owner;
+	m_buf_length = length;
+}
+
+std::shared_ptr<Measure> Measure::snapshot() const
+{
+	std::shared_ptr<Measure> copy = std::make_shared<Measure>(m_channel,
+		nullptr, 0, nullptr, m_isTimeDomain);
+
+	copy->m_sample_rate = m_sample_rate;
+	copy->m_adc_bit_count = m_adc_bit_count;
+	copy->m_cross_level = m_cross_level;
+	copy->m_hysteresis_span = m_hysteresis_span;
+	copy->m_startIndex = m_startIndex;
+	copy->m_endIndex = m_endIndex;
+	copy->m_gatingEnabled = m_gatingEnabled;
+	copy->m_harmonics_number = m_harmonics_number;
+	copy->m_mask = m_mask;
+
+	for (int i = 0; i < m_measurements.size(); i++) {
+		*copy->m_measurements[i] = *m_measurements[i];
+	}
+
+	// The conversion may call into the device, so it is resolved here
+	// and the snapshot only keeps its coefficients
+	if (m_isTimeDomain && m_conversion_function) {
+		copy->m_conversion_function = m_conversion_function;
+		copy->updateConversion();
+		copy->m_conversion_function = nullptr;
+	}
+
+	// A frame kept alive by its owner doesn't change anymore and is read
+	// in place; any other buffer is rewritten by the next capture, so its
+	// samples are copied
+	copy->m_buf_length = m_buf_length;
+
+	if (m_fbuffer && m_owner) {
+		copy->m_fbuffer = m_fbuffer;
+		copy->m_owner = m_owner;
+	} else if (m_fbuffer) {
+		copy->m_converted.assign(m_fbuffer, m_fbuffer + m_buf_length);
+		copy->m_buffer = copy->m_converted.data();
+	} else if (m_buffer) {
+		copy->m_converted.assign(m_buffer, m_buffer + m_buf_length);
+		copy->m_buffer = copy->m_converted.data();
+	}
+
+	return copy;
+}
+
+void Measure::copyResults(const Measure &other)
+{
+	const int count = std::min(m_measurements.size(),
+				   other.m_measurements.size());
+
+	for (int i = 0; i < count; i++) {
+		const MeasurementData &result = *other.m_measurements[i];
+
+		m_measurements[i]->setValue(result.value());
+		m_measurements[i]->setMeasured(result.measured());
+	}
+}
+
 void Measure::measure()
 {
 	clearMeasurements();
 
+	if (m_fbuffer && m_buf_length > 0) {
+		m_converted.resize(m_buf_length);
+		volk_32f_convert_64f(m_converted.data(), m_fbuffer,
+				     m_buf_length);
+		m_buffer = m_converted.data();
+	}
+
 	if (!m_buffer || m_buf_length == 0)
 		return;
 
 	if(m_isTimeDomain) {
+		if (m_conversion_function) {
+			updateConversion();
+		}
 		measureTimeDomain();
 	} else {
 		measureSpectral();
@@ -916,7 +1120,6 @@ void Measure::measureTimeDomain()
 	size_t data_length = m_buf_length;
 	size_t count = data_length;
 	int adc_span = 1 << m_adc_bit_count;
-	int hlf_scale = adc_span / 2;
 	bool using_histogram_method = (adc_span > 1);
 
 	int startIndex;
@@ -954,47 +1157,30 @@ void Measure::measureTimeDomain()
 		endIndex = data_length;
 	}
 
-	m_cross_detect = new CrossingDetection(m_cross_level, m_hysteresis_span,
-			"P");
-	if (using_histogram_method)
-		m_histogram = new int[adc_span]{};
-
-	for (ssize_t i = startIndex; i < endIndex; i++) {
-
-		if (qIsNaN(data[i])) {
-			count--;
-			continue;
-		}
-		// Find level crossings (period detection)
-		m_cross_detect->crossDetectStep(data, i);
-
-		// Min
-		if (data[i] < min) {
-			min = data[i];
-		}
-
-		// Max
-		if (data[i] > max) {
-			max = data[i];
-		}
-
-		// Sum of values
-		sum += data[i];
+	// Min, max, sums and histogram
+	std::vector<int> histogram(using_histogram_method ? adc_span : 0);
+	const size_t length = (endIndex > startIndex) ? endIndex - startIndex : 0;
+	const double rawGain = m_has_conversion ? 1 / m_volts_per_raw : 0;
+	const double rawOffset = m_has_conversion ? -m_raw_zero_volts * rawGain : 0;
+	const SampleStats stats = sampleStats(data + startIndex, length,
+		rawGain, rawOffset, using_histogram_method ? &histogram : nullptr);
 
-		// Sum of the squares of values
-		sqr_sum += data[i] * data[i];
+	if (stats.min < min) {
+		min = stats.min;
+	}
+	if (stats.max > max) {
+		max = stats.max;
+	}
+	sum += stats.sum;
+	sqr_sum += stats.sqr_sum;
+	count -= length - stats.count;
 
-		// Build histogram
-		if (using_histogram_method) {
-			double rawTmp = data[i];
-			int raw = 0;
-			if (m_conversion_function) {
-				raw = (int)m_conversion_function(m_channel, rawTmp, false);
-			}
-			raw += hlf_scale;
+	// Find level crossings (period detection)
+	CrossingDetection crossDetect(m_cross_level, m_hysteresis_span, 'P');
 
-			if (raw >= 0 && raw  < adc_span)
-				m_histogram[raw] += 1;
+	for (ssize_t i = startIndex; i < endIndex; i++) {
+		if (!qIsNaN(data[i])) {
+			crossDetect.crossDetectStep(data, i);
 		}
 	}
 
@@ -1023,7 +1209,7 @@ void Measure::measureTimeDomain()
 
 	// Try to use Histogram method
 	if (using_histogram_method)
-		highLowFromHistogram(low, high, min, max);
+		highLowFromHistogram(histogram, low, high, min, max);
 
 	// Low, High, Middle, Amplitude, Overshoot positive/negative
 	m_measurements[LOW]->setValue(low);
@@ -1041,13 +1227,8 @@ void Measure::measureTimeDomain()
 	overshoot_n = (low - min) / amplitude * 100;
 	m_measurements[N_OVER]->setValue(overshoot_n);
 
-	if (m_histogram != NULL) {
-		delete[] m_histogram;
-		m_histogram = NULL;
-	}
-
 	// Find Period / Frequency
-	QList<CrossPoint> periodPoints = m_cross_detect->detectedCrossings();
+	const std::vector<CrossPoint> &periodPoints = crossDetect.detectedCrossings();
 	int n = periodPoints.size();
 	if (n > 2) {
 		double sample_period;
@@ -1082,11 +1263,11 @@ void Measure::measureTimeDomain()
 		double midRef = low + (0.5 * amplitude);
 		double highRef = low + (0.9 * amplitude);
 
-		CrossingDetection cdLow(lowRef, 0.2, "L");
-		CrossingDetection cdMid(midRef, 0.2, "M");
-		CrossingDetection cdHigh(highRef, 0.2, "H");
+		CrossingDetection cdLow(lowRef, 0.2, 'L');
+		CrossingDetection cdMid(midRef, 0.2, 'M');
+		CrossingDetection cdHigh(highRef, 0.2, 'H');
 
-		QList<CrossPoint> crossSequence;
+		std::vector<CrossPoint> crossSequence;
 		cdLow.setExternalList(&crossSequence);
 		cdMid.setExternalList(&crossSequence);
 		cdHigh.setExternalList(&crossSequence);
@@ -1111,30 +1292,37 @@ void Measure::measureTimeDomain()
 			period_sqr_sum += data[i] * data[i];
 		}
 
-		for (int i = 1; i < crossSequence.size(); i++) {
+		for (size_t i = 1; i < crossSequence.size(); i++) {
 			CrossPoint &p0 = crossSequence[i - 1];
 			CrossPoint &p1 = crossSequence[i];
 			if ((p1.m_bufIdx == p0.m_bufIdx) && (p1.m_onRising == p0.m_onRising)) {
-				if ((p0.m_name == "MR" && p1.m_name == "LR") ||
-						(p0.m_name == "HR" && p1.m_name == "MR"))
-					crossSequence.swap(i, i - 1);
-				else if ((p0.m_name == "MF" && p1.m_name == "HF") ||
-						(p0.m_name == "LF" && p1.m_name == "MF"))
-					crossSequence.swap(i, i - 1);
+				if (p0.m_onRising && ((p0.m_level == 'M' && p1.m_level == 'L') ||
+						(p0.m_level == 'H' && p1.m_level == 'M')))
+					std::swap(p0, p1);
+				else if (!p0.m_onRising && ((p0.m_level == 'M' && p1.m_level == 'H') ||
+						(p0.m_level == 'L' && p1.m_level == 'M')))
+					std::swap(p0, p1);
 			}
 		}
 
-		QString sequence = "";
-		for (int i = 0; i < crossSequence.size(); i++)
-			sequence += crossSequence[i].m_name;
-
-		QString periodSequence = "LRMRHRHFMFLF";
-		int pos = sequence.indexOf(periodSequence);
+		static const CrossPoint periodSequence[] = {
+			CrossPoint(0, 0, true, 'L'),
+			CrossPoint(0, 0, true, 'M'),
+			CrossPoint(0, 0, true, 'H'),
+			CrossPoint(0, 0, false, 'H'),
+			CrossPoint(0, 0, false, 'M'),
+			CrossPoint(0, 0, false, 'L'),
+		};
+		auto it = std::search(crossSequence.begin(), crossSequence.end(),
+				      std::begin(periodSequence), std::end(periodSequence),
+				      [](const CrossPoint &p0, const CrossPoint &p1) {
+			return p0.m_level == p1.m_level && p0.m_onRising == p1.m_onRising;
+		});
 
-		if (pos < 0) {
+		if (it == crossSequence.end()) {
 			qDebug() << "Unable to find 2 transitions for each of the 10%, 50%, 90% levels";
 		} else {
-			pos /= 2;
+			size_t pos = it - crossSequence.begin();
 			CrossPoint &lowRising = crossSequence[pos];
 			CrossPoint &midRising = crossSequence[pos + 1];
 			CrossPoint &highRising = crossSequence[pos + 2];
@@ -1196,9 +1384,6 @@ void Measure::measureTimeDomain()
 		}
 	}
 
-	delete m_cross_detect;
-	m_cross_detect = NULL;
-
 }
 
 void Measure::measureSpectral() {
@@ -23,11 +23,11 @@
 
 #include <QList>
 #include <QString>
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace adiscope {
-	class CrossingDetection;
-
 	class MeasurementData
 	{
 	public:
@@ -119,8 +119,21 @@ namespace adiscope {
 			const std::function<double(unsigned int, double, bool)> &conversion = nullptr, bool isTimeDomain = true);
 
 		void setDataSource(double *buffer, size_t length);
+		/* Float samples are widened to double only when measured; the
+		 * owner, if any, keeps them unchanged for as long as it lives */
+		void setDataSource(const float *buffer, size_t length,
+				   const std::shared_ptr<const void> &owner = nullptr);
 		void measure();
 
+		/*
+		 * Copy of the settings and the data source that can be measured
+		 * on any thread. Samples that the owner of the data source may
+		 * still change are copied. The results are brought back with
+		 * copyResults().
+		 */
+		std::shared_ptr<Measure> snapshot() const;
+		void copyResults(const Measure &other);
+
 		void measureTimeDomain();
 		void measureSpectral();
 
@@ -150,13 +163,17 @@ namespace adiscope {
 		std::vector<int> LoadMaskfromFile(std::string file_name);
 
 	private:
-		bool highLowFromHistogram(double &low, double &high,
-			double min, double max);
+		bool highLowFromHistogram(const std::vector<int> &histogram,
+			double &low, double &high, double min, double max);
 		void clearMeasurements();
+		void updateConversion();
 
 	private:
 		int m_channel;
 		double *m_buffer;
+		const float *m_fbuffer;
+		std::shared_ptr<const void> m_owner;
+		std::vector<double> m_converted;
 		ssize_t m_buf_length;
 		double m_sample_rate;
 		unsigned int m_adc_bit_count;
@@ -165,8 +182,11 @@ namespace adiscope {
 		int m_startIndex;
 		int m_endIndex;
 		int m_gatingEnabled;
-		int *m_histogram;
-		CrossingDetection *m_cross_detect;
+
+		// Affine ADC code to volts conversion of the channel
+		bool m_has_conversion;
+		double m_volts_per_raw;
+		double m_raw_zero_volts;
 
 		int m_harmonics_number;
 		std::vector<int> m_mask;
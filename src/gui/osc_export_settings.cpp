@@ -171,6 +171,12 @@ void ExportSettings::enableExportButton(bool on)
 	ui->btnExport->setEnabled(on);
 }
 
+void ExportSettings::setExportProgress(int percent)
+{
+	ui->btnExport->setText(percent < 100 ? tr("Exporting %1%").arg(percent)
+					     : tr("Export"));
+}
+
 void ExportSettings::disableUIMargins()
 {
 	ui->verticalLayout_3->setMargin(0);
@@ -59,6 +59,8 @@ public Q_SLOTS:
 	void disableUIMargins();
 	void setTitleLabelVisible(bool enabled);
 	void setExportAllButtonLabel(const QString &text);
+	/* Shows the progress of a running export on the export button */
+	void setExportProgress(int percent);
 
 protected:
 	Ui::ExportSettings *ui;
@@ -83,9 +83,9 @@ namespace adiscope {
       d_index = 0;
 
       for(int i = 0; i < d_nconnections; i++) {
-	d_residbufs.push_back((double*)volk_malloc(d_size*sizeof(double),
-                                                   volk_get_alignment()));
-	memset(d_residbufs[i], 0, d_size*sizeof(double));
+	d_residbufs.push_back((float*)volk_malloc(d_size*sizeof(float),
+                                                  volk_get_alignment()));
+	memset(d_residbufs[i], 0, d_size*sizeof(float));
       }
 
       // Set alignment properties for VOLK
@@ -93,6 +93,8 @@ namespace adiscope {
 	volk_get_alignment() / sizeof(gr_complex);
       set_alignment(std::max(1,alignment_multiple));
 
+      d_frame_pool = SampleFramePool<float>::make();
+
       this->plot = (HistogramDisplayPlot*)plot;
 	  initialize();
     }
@@ -148,10 +150,10 @@ namespace adiscope {
 	// Resize residbuf and replace data
 	for(int i = 0; i < d_nconnections; i++) {
 	  volk_free(d_residbufs[i]);
-	  d_residbufs[i] = (double*)volk_malloc(newsize*sizeof(double),
-                                                volk_get_alignment());
+	  d_residbufs[i] = (float*)volk_malloc(newsize*sizeof(float),
+                                               volk_get_alignment());
 
-	  memset(d_residbufs[i], 0, newsize*sizeof(double));
+	  memset(d_residbufs[i], 0, newsize*sizeof(float));
 	}
 
 	// Set new size and reset buffer index
@@ -208,16 +210,22 @@ namespace adiscope {
 	  // Fill up residbufs with d_size number of items
 	  for(n = 0; n < d_nconnections; n++) {
 	    in = (const float*)input_items[idx++];
-	    volk_32f_convert_64f_u(&d_residbufs[n][d_index],
-				   &in[j], resid);
+	    memcpy(&d_residbufs[n][d_index], &in[j], resid*sizeof(float));
 	  }
 
 	  // Update the plot if its time
 	  if(gr::high_res_timer_now() - d_last_time > d_update_time) {
 	    d_last_time = gr::high_res_timer_now();
-	    if (d_qApplication)
+	    if (d_qApplication) {
+	      SampleFrame<float>::sptr frame =
+		      d_frame_pool->acquire(d_nconnections, d_size);
+	      for(n = 0; n < d_nconnections; n++) {
+		memcpy(frame->channel(n), d_residbufs[n], d_size*sizeof(float));
+	      }
+
 	      d_qApplication->postEvent(this->plot,
-				      new HistogramUpdateEvent(d_residbufs, d_size));
+				      new HistogramUpdateEvent(frame));
+	    }
 	  }
 
 	  d_index = 0;
@@ -228,8 +236,7 @@ namespace adiscope {
 	else {
 	  for(n = 0; n < d_nconnections; n++) {
 	    in = (const float*)input_items[idx++];
-	    volk_32f_convert_64f_u(&d_residbufs[n][d_index],
-				   &in[j], datasize);
+	    memcpy(&d_residbufs[n][d_index], &in[j], datasize*sizeof(float));
 	  }
 	  d_index += datasize;
 	  j += datasize;
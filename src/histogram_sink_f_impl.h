@@ -46,6 +46,7 @@
 
 #include "histogram_sink_f.h"
 #include "HistogramDisplayPlot.h"
+#include "sample_frame.h"
 
 namespace adiscope {
 
@@ -61,7 +62,8 @@ namespace adiscope {
       int d_nconnections;
 
       int d_index;
-      std::vector<double*> d_residbufs;
+      std::vector<float*> d_residbufs;
+      SampleFramePool<float>::sptr d_frame_pool;
 
       HistogramDisplayPlot *plot;
 
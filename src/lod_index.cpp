@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lod_index.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace adiscope;
+
+MinMaxBucket::MinMaxBucket()
+	: min(std::numeric_limits<float>::infinity())
+	, max(-std::numeric_limits<float>::infinity())
+{
+}
+
+template <typename Bucket>
+constexpr size_t LodIndex<Bucket>::BASE_SIZE;
+
+template <typename Bucket>
+constexpr size_t LodIndex<Bucket>::FANOUT;
+
+template <typename Bucket>
+LodIndex<Bucket>::LodIndex()
+	: m_levels(1)
+{
+}
+
+template <typename Bucket>
+void LodIndex<Bucket>::clear()
+{
+	m_levels.assign(1, std::vector<Bucket>());
+}
+
+template <typename Bucket>
+Bucket &LodIndex<Bucket>::baseBucket(size_t sample)
+{
+	std::vector<Bucket> &base = m_levels[0];
+	const size_t idx = sample / BASE_SIZE;
+
+	if (idx >= base.size()) {
+		base.resize(idx + 1);
+	}
+
+	return base[idx];
+}
+
+template <typename Bucket>
+void LodIndex<Bucket>::commit(size_t fromSample)
+{
+	size_t dirty = fromSample / BASE_SIZE;
+
+	for (size_t level = 0; m_levels[level].size() > 1; level++) {
+		const size_t count = m_levels[level].size();
+		const size_t parents = (count + FANOUT - 1) / FANOUT;
+
+		if (level + 1 == m_levels.size()) {
+			m_levels.push_back(std::vector<Bucket>());
+		}
+
+		// The last parent may be partial; it is recomputed once the
+		// rest of its children come in
+		std::vector<Bucket> &children = m_levels[level];
+		std::vector<Bucket> &upper = m_levels[level + 1];
+
+		upper.resize(parents);
+		dirty /= FANOUT;
+
+		for (size_t p = dirty; p < parents; p++) {
+			const size_t end = std::min(count, (p + 1) * FANOUT);
+			Bucket merged;
+
+			for (size_t c = p * FANOUT; c < end; c++) {
+				merged.merge(children[c]);
+			}
+			upper[p] = merged;
+		}
+	}
+}
+
+template <typename Bucket>
+void LodIndex<Bucket>::dropFront(size_t sample)
+{
+	std::vector<Bucket> &base = m_levels[0];
+
+	base.erase(base.begin(), base.begin() + std::min(sample / BASE_SIZE, base.size()));
+
+	// The parents no longer line up with their children
+	m_levels.resize(1);
+	commit(0);
+}
+
+template <typename Bucket>
+Bucket LodIndex<Bucket>::query(size_t first, size_t last,
+			       size_t &headEnd, size_t &tailStart) const
+{
+	Bucket result;
+
+	// Whole base buckets within the range
+	size_t lo = (first + BASE_SIZE - 1) / BASE_SIZE;
+	size_t hi = last / BASE_SIZE;
+
+	if (first >= last || lo >= hi) {
+		headEnd = tailStart = last;
+		return result;
+	}
+
+	headEnd = lo * BASE_SIZE;
+	tailStart = hi * BASE_SIZE;
+
+	// Take the unaligned buckets at both ends of the current level and
+	// move up with whatever is left in between
+	for (size_t level = 0; lo < hi; level++) {
+		const std::vector<Bucket> &buckets = m_levels[level];
+
+		if (level + 1 == m_levels.size()) {
+			for (; lo < hi; lo++) {
+				result.merge(buckets[lo]);
+			}
+			break;
+		}
+
+		for (; lo < hi && lo % FANOUT; lo++) {
+			result.merge(buckets[lo]);
+		}
+		for (; hi > lo && hi % FANOUT; hi--) {
+			result.merge(buckets[hi - 1]);
+		}
+
+		lo /= FANOUT;
+		hi /= FANOUT;
+	}
+
+	return result;
+}
+
+namespace adiscope {
+	template class LodIndex<MinMaxBucket>;
+	template class LodIndex<TransitionBucket>;
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOD_INDEX_H
+#define LOD_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace adiscope {
+
+/* Smallest and largest value of a run of analog samples */
+struct MinMaxBucket
+{
+	float min;
+	float max;
+
+	MinMaxBucket();
+
+	bool empty() const { return min > max; }
+
+	void add(float value)
+	{
+		// NaN compares false both ways and is left out
+		if (value < min) {
+			min = value;
+		}
+		if (value > max) {
+			max = value;
+		}
+	}
+
+	void merge(const MinMaxBucket &other)
+	{
+		add(other.min);
+		add(other.max);
+	}
+};
+
+/* Channels of a logic capture that toggle at least once within a run */
+struct TransitionBucket
+{
+	uint16_t mask;
+
+	TransitionBucket() : mask(0) {}
+
+	bool empty() const { return !mask; }
+
+	void merge(const TransitionBucket &other)
+	{
+		mask |= other.mask;
+	}
+};
+
+/*
+ * Level of detail index over a growing buffer. The base level holds one
+ * bucket per BASE_SIZE consecutive samples and every level above it merges
+ * FANOUT buckets of the level below, so that a summary of any sample range
+ * takes O(log n) buckets to compute no matter how large the range is.
+ *
+ * The index does not look at the samples itself: the owner fills in the
+ * base buckets as new data comes in and then commits them, which updates
+ * the levels above. Queries only ever cover whole buckets; the owner scans
+ * the samples at the two ends of a range.
+ */
+template <typename Bucket>
+class LodIndex
+{
+public:
+	static constexpr size_t BASE_SIZE = 32;
+	static constexpr size_t FANOUT = 8;
+
+	LodIndex();
+
+	void clear();
+
+	/* Base bucket covering the given sample, allocated if needed */
+	Bucket &baseBucket(size_t sample);
+
+	/* Recomputes the upper levels for the base buckets starting at
+	 * the one covering the given sample */
+	void commit(size_t fromSample);
+
+	/* Drops the base buckets before the given sample, a multiple of
+	 * BASE_SIZE; the bucket that covered it now covers sample 0 */
+	void dropFront(size_t sample);
+
+	/*
+	 * Merges the buckets that lie entirely within [first, last). On
+	 * return, [first, headEnd) and [tailStart, last) are the samples
+	 * not covered by the result; when the range does not hold any
+	 * whole bucket, headEnd == tailStart == last.
+	 * The buckets must have been filled for the whole range.
+	 */
+	Bucket query(size_t first, size_t last, size_t &headEnd, size_t &tailStart) const;
+
+private:
+	std::vector<std::vector<Bucket>> m_levels;
+};
+
+typedef LodIndex<MinMaxBucket> MinMaxIndex;
+typedef LodIndex<TransitionBucket> TransitionIndex;
+}
+
+#endif // LOD_INDEX_H
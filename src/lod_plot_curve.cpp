@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lod_plot_curve.h"
+#include "float_series_data.h"
+
+#include <qwt_painter.h>
+#include <qwt_scale_map.h>
+
+#include <QPainter>
+#include <QtMath>
+
+#include <algorithm>
+
+/* Below this many samples per pixel column, the plain polyline is drawn */
+#define LOD_MIN_SAMPLES_PER_COLUMN 4
+
+using namespace adiscope;
+
+LodPlotCurve::LodPlotCurve(const QString &title)
+	: QwtPlotCurve(title)
+{
+}
+
+void LodPlotCurve::drawCurve(QPainter *painter, int style,
+			     const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+			     const QRectF &canvasRect, int from, int to) const
+{
+	if (style == Lines && !testCurveAttribute(Fitted) &&
+			brush().style() == Qt::NoBrush &&
+			drawColumns(painter, xMap, yMap, canvasRect, from, to)) {
+		return;
+	}
+
+	QwtPlotCurve::drawCurve(painter, style, xMap, yMap, canvasRect, from, to);
+}
+
+bool LodPlotCurve::drawColumns(QPainter *painter, const QwtScaleMap &xMap,
+			       const QwtScaleMap &yMap, const QRectF &canvasRect,
+			       int from, int to) const
+{
+	const FloatSeriesData *series = dynamic_cast<const FloatSeriesData *>(data());
+
+	if (!series || to - from < 2) {
+		return false;
+	}
+
+	// The X axis of a capture is evenly spaced, so the samples under a
+	// pixel column are found without searching
+	const double *x = series->xData();
+	const double x0 = x[from];
+	const double dx = (x[to] - x0) / (to - from);
+
+	const double pxFrom = xMap.transform(x[from]);
+	const double pxTo = xMap.transform(x[to]);
+
+	if (!(dx > 0.0) || pxTo <= pxFrom ||
+			to - from < LOD_MIN_SAMPLES_PER_COLUMN * (pxTo - pxFrom)) {
+		return false;
+	}
+
+	const int firstColumn = qFloor(std::max(pxFrom, canvasRect.left()));
+	const int lastColumn = qCeil(std::min(pxTo, canvasRect.right()));
+
+	if (lastColumn <= firstColumn) {
+		return false;
+	}
+
+	auto sampleAt = [&](int column) -> size_t {
+		const double pos = qCeil((xMap.invTransform(column) - x0) / dx);
+
+		return from + static_cast<size_t>(qBound(0.0, pos, double(to - from + 1)));
+	};
+
+	QPolygonF polyline;
+	polyline.reserve(2 * (lastColumn - firstColumn + 1));
+
+	size_t s0 = sampleAt(firstColumn);
+
+	for (int column = firstColumn; column <= lastColumn; column++) {
+		const size_t s1 = sampleAt(column + 1);
+
+		if (s1 <= s0) {
+			continue;
+		}
+
+		// Overlap the previous column by one sample so that the
+		// segments of neighbouring columns join up
+		const size_t first = s0 > static_cast<size_t>(from) ? s0 - 1 : s0;
+		float min, max;
+
+		if (series->minMax(first, s1, min, max)) {
+			polyline += QPointF(column, yMap.transform(min));
+			polyline += QPointF(column, yMap.transform(max));
+		}
+
+		s0 = s1;
+	}
+
+	QwtPainter::drawPolyline(painter, polyline);
+
+	return true;
+}
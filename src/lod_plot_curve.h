@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOD_PLOT_CURVE_H
+#define LOD_PLOT_CURVE_H
+
+#include <qwt_plot_curve.h>
+
+namespace adiscope {
+
+/*
+ * Curve that draws dense FloatSeriesData as one vertical min/max segment
+ * per pixel column, taken from the level of detail index of the data. The
+ * cost of a repaint then depends on the width of the canvas rather than on
+ * the number of samples. Any other case is left to QwtPlotCurve.
+ */
+class LodPlotCurve : public QwtPlotCurve
+{
+public:
+	explicit LodPlotCurve(const QString &title = QString());
+
+protected:
+	void drawCurve(QPainter *painter, int style,
+		       const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+		       const QRectF &canvasRect, int from, int to) const;
+
+private:
+	bool drawColumns(QPainter *painter, const QwtScaleMap &xMap,
+			 const QwtScaleMap &yMap, const QRectF &canvasRect,
+			 int from, int to) const;
+};
+}
+
+#endif // LOD_PLOT_CURVE_H
@@ -28,12 +28,18 @@ adiscope::logic::LogicTool::LogicTool(iio_context *ctx, adiscope::ToolMenuItem *
                                       adiscope::ApiObject *api, const QString &name,
                                       adiscope::ToolLauncher *parent)
         : Tool(ctx, toolMenuItem, api, name, parent)
-        , m_buffer(nullptr)
 {
 
 }
 
-uint16_t *LogicTool::getData()
+CaptureBuffer::sptr LogicTool::getCapture() const
 {
-	return m_buffer;
+	std::lock_guard<std::mutex> lock(m_captureMutex);
+	return m_capture;
+}
+
+void LogicTool::setCapture(const CaptureBuffer::sptr &capture)
+{
+	std::lock_guard<std::mutex> lock(m_captureMutex);
+	m_capture = capture;
 }
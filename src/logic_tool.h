@@ -23,6 +23,9 @@
 #define LOGICTOOL_H
 
 #include "tool.hpp"
+#include "logicanalyzer/capturebuffer.h"
+
+#include <mutex>
 
 namespace adiscope {
 namespace logic {
@@ -35,13 +38,18 @@ public:
 	          ToolLauncher *parent);
 	virtual ~LogicTool() = default;
 
-	uint16_t *getData();
+	// Buffer of the last capture; can be called from any thread
+	CaptureBuffer::sptr getCapture() const;
 
 Q_SIGNALS:
 	void dataAvailable(uint64_t, uint64_t);
 
 protected:
-	uint16_t *m_buffer;
+	void setCapture(const CaptureBuffer::sptr &capture);
+
+private:
+	CaptureBuffer::sptr m_capture;
+	mutable std::mutex m_captureMutex;
 };
 } // namespace logic
 } // namespace adiscope
@@ -47,9 +47,56 @@ extern "C" {
 
 #include <vector>
 
-Annotation::Annotation(const srd_proto_data *const pdata, const Row *row) :
-    start_sample_(pdata->start_sample),
-    end_sample_(pdata->end_sample),
+AnnotationStrings::Texts AnnotationStrings::intern(const char *const *texts)
+{
+    // The raw texts, NUL separated, are the key: looking up a text that
+    // was seen before does not convert anything
+    key_.clear();
+    for (; *texts; texts++) {
+        key_.append(*texts);
+        key_.push_back('\0');
+    }
+
+    auto it = strings_.find(key_);
+    if (it != strings_.end()) {
+        return it->second;
+    }
+
+    auto strings = std::make_shared<vector<QString>>();
+    for (size_t start = 0; start < key_.size(); ) {
+        const size_t end = key_.find('\0', start);
+        strings->push_back(QString::fromUtf8(key_.data() + start, end - start));
+        start = end + 1;
+    }
+
+    strings_.emplace(key_, strings);
+
+    return strings;
+}
+
+void AnnotationStrings::prune()
+{
+    for (auto it = strings_.begin(); it != strings_.end(); ) {
+        if (it->second.use_count() == 1) {
+            it = strings_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+Annotation::Annotation() :
+    start_sample_(0),
+    end_sample_(0),
+    ann_class_(0),
+    row_(nullptr)
+{
+}
+
+Annotation::Annotation(const srd_proto_data *const pdata, const Row *row,
+                       AnnotationStrings &strings, uint64_t sample_offset) :
+    start_sample_(pdata->start_sample + sample_offset),
+    end_sample_(pdata->end_sample + sample_offset),
     row_(row)
 {
     assert(pdata);
@@ -58,12 +105,7 @@ Annotation::Annotation(const srd_proto_data *const pdata, const Row *row) :
     assert(pda);
 
     ann_class_ = (Class)(pda->ann_class);
-
-    const char *const *annotations = (char**)pda->ann_text;
-    while (*annotations) {
-        annotations_.push_back(QString::fromUtf8(*annotations));
-        annotations++;
-    }
+    annotations_ = strings.intern((const char *const *)pda->ann_text);
 }
 
 uint64_t Annotation::start_sample() const
@@ -83,7 +125,9 @@ Annotation::Class Annotation::ann_class() const
 
 const vector<QString>& Annotation::annotations() const
 {
-    return annotations_;
+    static const vector<QString> none;
+
+    return annotations_ ? *annotations_ : none;
 }
 
 const Row* Annotation::row() const
@@ -42,6 +42,9 @@
 #define ANNOTATION_H
 
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <QString>
@@ -51,15 +54,38 @@ class Row;
 
 using std::vector;
 
+/*
+ * Pool of annotation texts. Decoders repeat the same few texts over and
+ * over (the same bytes, the same bit values, the same labels), so every
+ * distinct set of texts is converted to QStrings once and shared by all
+ * the annotations that carry it. Each annotation holds a reference to its
+ * texts, so copies of it stay valid after the pool and its row are gone.
+ */
+class AnnotationStrings
+{
+public:
+    typedef std::shared_ptr<const vector<QString>> Texts;
+
+    Texts intern(const char *const *texts);
+
+    /* Forgets the texts no annotation carries anymore */
+    void prune();
+
+private:
+    std::unordered_map<std::string, Texts> strings_;
+    std::string key_;
+};
+
 class Annotation
 {
 public:
     typedef uint32_t Class;
 
 public:
-    Annotation() = default;
+    Annotation();
     Annotation(const Annotation &other) = default;
-    Annotation(const srd_proto_data *const pdata, const Row *row);
+    Annotation(const srd_proto_data *const pdata, const Row *row,
+               AnnotationStrings &strings, uint64_t sample_offset = 0);
 
     uint64_t start_sample() const;
     uint64_t end_sample() const;
@@ -73,7 +99,7 @@ private:
     uint64_t start_sample_;
     uint64_t end_sample_;
     Class ann_class_;
-    vector<QString> annotations_;
+    AnnotationStrings::Texts annotations_;
     const Row *row_;
 
 };
@@ -76,7 +76,8 @@ AnnotationCurve::~AnnotationCurve()
 	delete m_annotationDecoder;
 }
 
-void AnnotationCurve::annotationCallback(srd_proto_data *pdata, void *annotationCurve)
+void AnnotationCurve::annotationCallback(srd_proto_data *pdata, void *annotationCurve,
+                                         uint64_t sampleOffset)
 {
     if (!pdata) {
         qDebug() << "Error pdata nullptr!";
@@ -139,16 +140,36 @@ void AnnotationCurve::annotationCallback(srd_proto_data *pdata, void *annotation
 
     std::unique_lock<std::mutex> lock(curve->m_mutex);
 
-    (*row_iter).second.emplace_annotation(pdata, &((*row_iter).first));
+    (*row_iter).second.emplace_annotation(pdata, &((*row_iter).first), sampleOffset);
+    curve->m_revision++;
 //	qDebug() << "Pushed annotation with format: " << format << " to row: " << (*row_iter).first.index();
 }
 
+void AnnotationCurve::pruneAnnotations(uint64_t firstSample)
+{
+    if (!firstSample) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    bool dropped = false;
+    for (auto &row : m_annotationRows) {
+        dropped |= row.second.drop_annotations_before(firstSample);
+    }
+
+    if (dropped) {
+        m_revision++;
+    }
+}
+
 void AnnotationCurve::dataAvailable(uint64_t from, uint64_t to)
 {
 	if (from == 0) {
 		reset();
 	}
 
+    setLastSample(to);
     m_annotationDecoder->dataAvailable(from, to);
 }
 
@@ -160,6 +181,7 @@ void AnnotationCurve::setClassRows(const std::map<std::pair<const srd_decoder *,
 void AnnotationCurve::setAnnotationRows(const std::map<Row, RowData> &annotationRows)
 {
     m_annotationRows = annotationRows;
+    m_revision++;
 }
 
 const std::map<Row, RowData> & AnnotationCurve::getAnnotationRows() const
@@ -167,11 +189,24 @@ const std::map<Row, RowData> & AnnotationCurve::getAnnotationRows() const
     return m_annotationRows;
 }
 
+std::shared_ptr<const std::map<Row, RowData>> AnnotationCurve::snapshotAnnotationRows() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (!m_snapshot || m_snapshotRevision != m_revision) {
+        m_snapshot = std::make_shared<const std::map<Row, RowData>>(m_annotationRows);
+        m_snapshotRevision = m_revision;
+    }
+
+    return m_snapshot;
+}
+
 void AnnotationCurve::sort_rows()
 {
     for (auto it = m_annotationRows.begin(); it != m_annotationRows.end(); ++it) {
         it->second.sort_annotations();
     }
+    m_revision++;
 }
 
 void AnnotationCurve::newAnnotations()
@@ -186,6 +221,7 @@ void AnnotationCurve::reset()
 
     m_classRows.clear();
     m_annotationRows.clear();
+    m_revision++;
 	m_annotationDecoder->reset();
 	m_visibleRows = 0;
 	state = 0;
@@ -391,7 +427,7 @@ void AnnotationCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap, cons
         const double min_ann_label_width = QFontMetrics(QFont("Times", 10, QFont::Bold)).horizontalAdvance("XX");
 
         for (; start <= stop; ++start) {
-            Annotation ann = ((*it).second.getAnnAt(start));
+            const Annotation &ann = *(*it).second.annAt(start);
 
 	    const double annotation_width = xMap.transform(fromSampleToTime(ann.end_sample())) - xMap.transform(fromSampleToTime(ann.start_sample()));
 
@@ -683,15 +719,14 @@ uint64_t AnnotationCurve::getMaxAnnotationCount(int index)
 {
 	std::map<Row, RowData>::iterator it;
 	uint64_t count = 0;
-	std::map<Row, RowData> decoder(getAnnotationRows());
 
 	for (it = m_annotationRows.begin(); it != m_annotationRows.end(); it++) {
-		auto temp_annotations = it->second.get_annotations();
+		const uint64_t size = it->second.size();
 		if (it->first.index() == index) {
-			return temp_annotations.size();
+			return size;
 		}
-		if (count < temp_annotations.size()) {
-			count = temp_annotations.size();
+		if (count < size) {
+			count = size;
 		}
 	}
 
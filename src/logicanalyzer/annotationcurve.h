@@ -26,6 +26,7 @@
 
 #include <libsigrokdecode/libsigrokdecode.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
@@ -75,7 +76,12 @@ Q_SIGNALS:
     void annotationClicked(AnnotationQueryResult result);
 
 public:
-    static void annotationCallback(srd_proto_data *pdata, void *annotationCurve);
+    // sampleOffset is the capture sample the decoder session started at
+    static void annotationCallback(srd_proto_data *pdata, void *annotationCurve,
+                                   uint64_t sampleOffset = 0);
+
+    // Drops the annotations a continuous capture left behind its buffer
+    void pruneAnnotations(uint64_t firstSample);
 
     virtual void dataAvailable(uint64_t from, uint64_t to) override;
 
@@ -83,6 +89,10 @@ public:
     void setAnnotationRows(const std::map<Row, RowData> &annotationRows);
     const std::map<Row, RowData>& getAnnotationRows() const;
 
+    // Copy of the annotation rows that stays valid while the decoder keeps
+    // adding to them. It is only copied again once the rows changed.
+    std::shared_ptr<const std::map<Row, RowData>> snapshotAnnotationRows() const;
+
     void sort_rows();
 
     uint64_t getMaxAnnotationCount(int index = -1);
@@ -161,6 +171,11 @@ private:
     std::map<std::pair<const srd_decoder*, int>, Row> m_classRows;
     std::map<Row, RowData> m_annotationRows;
 
+    // Bumped on every change of the rows
+    std::atomic<uint64_t> m_revision{0};
+    mutable uint64_t m_snapshotRevision = 0;
+    mutable std::shared_ptr<const std::map<Row, RowData>> m_snapshot;
+
     std::vector<std::shared_ptr<adiscope::bind::Decoder>> m_bindings;
 
     mutable int m_visibleRows;
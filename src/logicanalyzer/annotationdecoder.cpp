@@ -21,16 +21,16 @@
 
 #include "annotationdecoder.h"
 #include <libsigrokdecode/libsigrokdecode.h>
+#include "decoderengine.h"
 #include "logic_analyzer.h"
 #include <QDebug>
 #include <algorithm>
+#include <chrono>
 
 using namespace adiscope;
 
 constexpr uint64_t MAX_CHUNK_SIZE = 256 * 1024;
 
-std::mutex AnnotationDecoder::g_sessionMutex;
-
 void AnnotationDecoder::initDecoderChannels()
 {
     uint16_t id = 0;
@@ -78,6 +78,12 @@ AnnotationDecoder::AnnotationDecoder(AnnotationCurve *annotationCurve, std::shar
     , m_logic(logic)
     , m_decodeCanceled(false)
     , m_lastSample(0)
+    , m_samplesDecoded(0)
+    , m_annotationsDecoded(0)
+    , m_decodeTimeNs(0)
+    , m_captureVersion(0)
+    , m_sessionStart(0)
+    , m_sessionEnd(0)
 {
     // 1. Get stacked decoder from annotation Curve
     // 2. Configure curve (channels and annotations)
@@ -96,6 +102,7 @@ AnnotationDecoder::AnnotationDecoder(AnnotationCurve *annotationCurve, std::shar
 AnnotationDecoder::~AnnotationDecoder()
 {
 	if (m_srdSession) {
+	    DecoderEngine::PythonLock python;
 	    m_decodeCanceled = true;
 	    srd_session_terminate_reset(m_srdSession);
 	    {
@@ -115,6 +122,7 @@ AnnotationDecoder::~AnnotationDecoder()
 void AnnotationDecoder::stackDecoder(std::shared_ptr<logic::Decoder> decoder)
 {
     if (m_srdSession) {
+        DecoderEngine::PythonLock python;
         m_decodeCanceled = true;
         srd_session_terminate_reset(m_srdSession);
         {
@@ -140,6 +148,7 @@ void AnnotationDecoder::stackDecoder(std::shared_ptr<logic::Decoder> decoder)
 void AnnotationDecoder::unstackDecoder(std::shared_ptr<logic::Decoder> decoder)
 {
 	if (m_srdSession) {
+	    DecoderEngine::PythonLock python;
 	    m_decodeCanceled = true;
 	    srd_session_terminate_reset(m_srdSession);
 	    {
@@ -172,6 +181,7 @@ void AnnotationDecoder::startDecode()
     // TODO: cancel mechanism
 
     if (m_srdSession) {
+        DecoderEngine::PythonLock python;
         m_decodeCanceled = true;
         srd_session_terminate_reset(m_srdSession);
         {
@@ -194,28 +204,30 @@ void AnnotationDecoder::startDecode()
         m_annotationCurve->setClassRows(m_class_rows);
         m_annotationCurve->setAnnotationRows(m_annotation_rows);
 
+        const logic::CaptureBuffer::sptr capture = m_logic->getCapture();
+        const uint64_t lastSample = capture ? std::min(m_lastSample, capture->written()) : 0;
+
         std::unique_lock<std::mutex> lock(m_newDataMutex);
         {
             // clear the current queue content
-            std::queue<std::pair<uint64_t, uint64_t>> empty;
+            std::queue<DecodeChunk> empty;
             m_newDataQueue.swap(empty);
         }
-        uint64_t q = m_lastSample / MAX_CHUNK_SIZE;
-        uint64_t r = m_lastSample % MAX_CHUNK_SIZE;
-        for (uint64_t i = 0; i < q; ++ i) {
-            m_newDataQueue.emplace(0 + i * MAX_CHUNK_SIZE, MAX_CHUNK_SIZE * (i + 1));
-        }
 
-        if (r != 0) {
-            m_newDataQueue.emplace(MAX_CHUNK_SIZE * q, MAX_CHUNK_SIZE * q + r);
+        // A continuous capture only holds its last samples
+        for (uint64_t pos = capture ? capture->firstSample() : 0; pos < lastSample;
+             pos += MAX_CHUNK_SIZE) {
+            queueChunk(pos, std::min(pos + MAX_CHUNK_SIZE, lastSample), capture);
         }
     }
 
 
-    if (srd_session_start(m_srdSession) != SRD_OK) {
-	qDebug() << "srd_session_start returned error!";
-    } else {
-//        qDebug() << "srd_session_start returned SRD_OK";
+    {
+        DecoderEngine::PythonLock python;
+
+        if (srd_session_start(m_srdSession) != SRD_OK) {
+            qDebug() << "srd_session_start returned error!";
+        }
     }
 
     if (m_decodeThread) {
@@ -223,6 +235,13 @@ void AnnotationDecoder::startDecode()
         delete m_decodeThread;
     }
 
+    resetStats();
+
+    {
+        std::unique_lock<std::mutex> lock(m_newDataMutex);
+        m_sessionStart = m_sessionEnd = m_newDataQueue.empty() ? 0 : m_newDataQueue.front().start;
+    }
+
     m_decodeCanceled = false;
     m_decodeThread = new std::thread(&AnnotationDecoder::decodeProc, this);
 
@@ -245,7 +264,8 @@ void AnnotationDecoder::stopDecode()
         m_decodeThread = nullptr;
     }
 
-    std::lock_guard<std::mutex> srd_lock(g_sessionMutex);
+    std::lock_guard<std::mutex> srd_lock(DecoderEngine::getInstance()->globalMutex());
+    DecoderEngine::PythonLock python;
 
     if (m_srdSession) {
         srd_session_destroy(m_srdSession);
@@ -265,17 +285,34 @@ void AnnotationDecoder::dataAvailable(uint64_t from, uint64_t to)
 //	faster than libsigrokdecode can process
 
 	if (from != to) {
+		const logic::CaptureBuffer::sptr capture = m_logic->getCapture();
 		std::unique_lock<std::mutex> lock(m_newDataMutex);
 
 
 		m_lastSample = to;
 
-		m_newDataQueue.emplace(from, to);
+		queueChunk(from, to, capture);
 		lock.unlock();
 		m_newDataCv.notify_one();
 	}
 }
 
+void AnnotationDecoder::queueChunk(uint64_t from, uint64_t to,
+                                   const logic::CaptureBuffer::sptr &capture)
+{
+    // m_newDataMutex must be held
+    if (!capture) {
+        return;
+    }
+
+    // Chunks still queued from an older capture are dropped by decodeProc
+    if (capture->version() > m_captureVersion) {
+        m_captureVersion = capture->version();
+    }
+
+    m_newDataQueue.push({from, to, capture});
+}
+
 std::vector<std::shared_ptr<logic::Decoder> > AnnotationDecoder::getDecoderStack()
 {
     return m_stack;
@@ -284,6 +321,7 @@ std::vector<std::shared_ptr<logic::Decoder> > AnnotationDecoder::getDecoderStack
 void AnnotationDecoder::unassignChannel(uint16_t chId)
 {
     if (m_srdSession) {
+        DecoderEngine::PythonLock python;
         m_decodeCanceled = true;
         srd_session_terminate_reset(m_srdSession);
         {
@@ -333,6 +371,7 @@ void AnnotationDecoder::reset()
 void AnnotationDecoder::assignChannel(uint16_t chId, uint16_t bitId)
 {
     if (m_srdSession) {
+        DecoderEngine::PythonLock python;
         m_decodeCanceled = true;
         srd_session_terminate_reset(m_srdSession);
         {
@@ -375,7 +414,8 @@ void AnnotationDecoder::stackChanged()
 {
     stopDecode();
 
-    std::lock_guard<std::mutex> srd_lock(g_sessionMutex);
+    std::lock_guard<std::mutex> srd_lock(DecoderEngine::getInstance()->globalMutex());
+    DecoderEngine::PythonLock python;
 
     if (srd_session_new(&m_srdSession) != SRD_OK) {
         qDebug() << "srd_session_new returned error!";
@@ -453,7 +493,37 @@ void AnnotationDecoder::stackChanged()
 
     // register curve to receive new annotations from libsigrokdecode
     srd_pd_output_callback_add(m_srdSession, SRD_OUTPUT_ANN,
-                               AnnotationCurve::annotationCallback, m_annotationCurve);
+                               AnnotationDecoder::annotationCallback, this);
+}
+
+void AnnotationDecoder::annotationCallback(srd_proto_data *pdata, void *annotationDecoder)
+{
+    AnnotationDecoder *const decoder = static_cast<AnnotationDecoder*>(annotationDecoder);
+
+    decoder->m_annotationsDecoded++;
+    AnnotationCurve::annotationCallback(pdata, decoder->m_annotationCurve,
+                                        decoder->m_sessionStart);
+}
+
+void AnnotationDecoder::resetStats()
+{
+    m_samplesDecoded = 0;
+    m_annotationsDecoded = 0;
+    m_decodeTimeNs = 0;
+}
+
+double AnnotationDecoder::getSamplesPerSecond() const
+{
+    const uint64_t ns = m_decodeTimeNs;
+
+    return ns ? m_samplesDecoded * 1e9 / ns : 0.0;
+}
+
+double AnnotationDecoder::getAnnotationsPerSecond() const
+{
+    const uint64_t ns = m_decodeTimeNs;
+
+    return ns ? m_annotationsDecoded * 1e9 / ns : 0.0;
 }
 
 void AnnotationDecoder::decodeProc()
@@ -486,29 +556,76 @@ void AnnotationDecoder::decodeProc()
 
 //        qDebug() << "exit wait!";
 
-        uint64_t start, stop;
-        std::tie(start, stop) = m_newDataQueue.front();
+        const DecodeChunk chunk = m_newDataQueue.front();
         m_newDataQueue.pop();
+        const bool stale = chunk.capture->version() != m_captureVersion;
         lock.unlock(); // unlock to allow new data to enter the queue
 
-        uint64_t chunkSize = stop - start;
-        std::unique_ptr<uint16_t []> chunk(new uint16_t[chunkSize]);
-
-        uint16_t *data = m_logic->getData();
+	const uint64_t firstSample = chunk.capture->firstSample();
 
-	if (!data) {
+	if (stale || chunk.stop > chunk.capture->written() || chunk.stop <= firstSample) {
 		continue;
 	}
 
-        memcpy(chunk.get(), data + start, chunkSize * sizeof(uint16_t));
+        const uint64_t start = std::max(chunk.start, firstSample);
+        const uint64_t stop = chunk.stop;
+        const uint64_t chunkSize = stop - start;
+
+        // The samples since the end of the session were dropped before
+        // they were decoded, start over from the ones still held
+        if (start != m_sessionEnd) {
+            DecoderEngine::PythonLock python;
+
+            srd_session_terminate_reset(m_srdSession);
+            srd_session_metadata_set(m_srdSession, SRD_CONF_SAMPLERATE,
+                                     g_variant_new_uint64(m_annotationCurve->getSampleRate()));
+            for (const std::shared_ptr<logic::Decoder> &dec : m_stack) {
+                dec->apply_all_options();
+            }
+
+            if (srd_session_start(m_srdSession) != SRD_OK) {
+                qDebug() << "srd_session_start returned error!";
+            }
+
+            m_sessionStart = m_sessionEnd = start;
+        }
 
 //        qDebug() << "send data!";
-        std::lock_guard<std::mutex> srd_lock(g_sessionMutex);
+        // Other stacks keep decoding in parallel with this one
+        const auto sendStart = std::chrono::steady_clock::now();
+        {
+            DecoderEngine::SendScope scope(DecoderEngine::getInstance());
+
+            // The capture is not contiguous, send it one segment at a time
+            for (uint64_t pos = start; pos < stop; ) {
+                // Dropped by a continuous capture in the meantime
+                if (pos < chunk.capture->firstSample()) {
+                    break;
+                }
 
-        if (srd_session_send(m_srdSession, start, stop, reinterpret_cast<uint8_t*>(
-                                 chunk.get()), chunkSize, sizeof(uint16_t)) != SRD_OK) {
-//            qDebug() << "No bueno!";
+                uint64_t length;
+                const uint16_t *data = chunk.capture->segment(pos, length);
+
+                length = std::min(length, stop - pos);
+
+                DecoderEngine::PythonLock python;
+
+                if (srd_session_send(m_srdSession, pos - m_sessionStart,
+                                     pos + length - m_sessionStart,
+                                     reinterpret_cast<const uint8_t*>(data),
+                                     length, sizeof(uint16_t)) != SRD_OK) {
+//                    qDebug() << "No bueno!";
+                }
+
+                pos += length;
+                m_sessionEnd = pos;
+            }
         }
+        m_decodeTimeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - sendStart).count();
+        m_samplesDecoded += chunkSize;
+
+        m_annotationCurve->pruneAnnotations(chunk.capture->firstSample());
 
         // Notify curve that annotations are now available to be drawn on the plot
         // srd_session_send blocks untill all samples are processed
@@ -34,6 +34,7 @@
 #include <libsigrokdecode/libsigrokdecode.h>
 
 #include "annotationcurve.h"
+#include "capturebuffer.h"
 #include "decoder.h"
 
 namespace adiscope {
@@ -63,11 +64,20 @@ public:
     void reset();
 
     int getNrOfChannels() const;
+
+    // Decoding throughput of this stack, measured over the time spent
+    // inside libsigrokdecode since the last (re)start
+    double getSamplesPerSecond() const;
+    double getAnnotationsPerSecond() const;
 private:
     void stackChanged();
 
     void decodeProc();
 
+    void resetStats();
+    void queueChunk(uint64_t from, uint64_t to, const logic::CaptureBuffer::sptr &capture);
+    static void annotationCallback(srd_proto_data *pdata, void *annotationDecoder);
+
 
 private:
     AnnotationCurve *m_annotationCurve;
@@ -85,9 +95,27 @@ private:
     std::atomic<bool> m_decodeCanceled;
     std::mutex m_newDataMutex;
     std::condition_variable m_newDataCv;
-    static std::mutex g_sessionMutex;
-    std::queue<std::pair<uint64_t, uint64_t>> m_newDataQueue;
+
+    // Samples are sent to libsigrokdecode straight out of the capture
+    // buffer; each queued chunk keeps the buffer it refers to alive
+    struct DecodeChunk {
+        uint64_t start;
+        uint64_t stop;
+        logic::CaptureBuffer::sptr capture;
+    };
+    std::queue<DecodeChunk> m_newDataQueue;
+    uint64_t m_captureVersion;
+
+    // libsigrokdecode counts samples from 0 at the start of a session. A
+    // continuous capture may drop samples before they are decoded; the
+    // session is then started again at the first sample still held.
+    uint64_t m_sessionStart;
+    uint64_t m_sessionEnd;
     void initDecoderChannels();
+
+    std::atomic<uint64_t> m_samplesDecoded;
+    std::atomic<uint64_t> m_annotationsDecoded;
+    std::atomic<uint64_t> m_decodeTimeNs;
 };
 }
 
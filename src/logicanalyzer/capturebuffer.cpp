@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "capturebuffer.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <set>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+using namespace adiscope::logic;
+
+constexpr uint64_t CaptureBuffer::SEGMENT_SIZE;
+
+/* What the segments that were never written read as */
+static const uint16_t zeroSegment[CaptureBuffer::SEGMENT_SIZE] = {};
+
+/* Segments a ring keeps on top of its history: the capture thread writes
+ * up to 2M samples at a time and the curves read the last announced ones
+ * while it does */
+static const uint64_t ringSpareSegments = 8;
+
+/* Chosen capture files that a live buffer still maps */
+static std::mutex mappedPathsMutex;
+static std::set<QString> mappedPaths;
+
+/* The chosen path, or name_N.ext next to it while a previous capture
+ * still maps the file */
+static QString claimPath(const QString &path)
+{
+	std::lock_guard<std::mutex> lock(mappedPathsMutex);
+	const QFileInfo info(path);
+	QString claimed = info.absoluteFilePath();
+
+	for (unsigned int i = 1; mappedPaths.count(claimed); i++) {
+		claimed = info.absolutePath() + "/" + info.completeBaseName()
+				+ "_" + QString::number(i);
+		if (!info.suffix().isEmpty()) {
+			claimed += "." + info.suffix();
+		}
+	}
+
+	mappedPaths.insert(claimed);
+
+	return claimed;
+}
+
+static void releasePath(const QString &path)
+{
+	std::lock_guard<std::mutex> lock(mappedPathsMutex);
+
+	mappedPaths.erase(path);
+}
+
+static QTemporaryFile *openTemporaryFile()
+{
+	std::unique_ptr<QTemporaryFile> file(
+		new QTemporaryFile(QDir::tempPath() + "/scopy_capture_XXXXXX.bin"));
+
+	if (!file->open()) {
+		qDebug() << "Can't create a temporary capture file";
+		return nullptr;
+	}
+
+	return file.release();
+}
+
+CaptureBuffer::CaptureBuffer(uint64_t size, uint64_t segments, uint64_t version,
+			     QFile *file, bool keepFile)
+	: m_segments(segments)
+	, m_file(file)
+	, m_keepFile(keepFile)
+	, m_size(size)
+	, m_first(0)
+	, m_written(0)
+	, m_version(version)
+{
+	for (auto &segment : m_segments) {
+		segment = nullptr;
+	}
+}
+
+CaptureBuffer::~CaptureBuffer()
+{
+	if (!m_file) {
+		for (const auto &segment : m_segments) {
+			delete[] segment.load();
+		}
+		return;
+	}
+
+	// Mapped segments go away along with the file. A chosen file is
+	// kept, cut down to the samples that were written.
+	if (m_keepFile) {
+		for (const auto &segment : m_segments) {
+			uint16_t *data = segment.load();
+
+			if (data) {
+				m_file->unmap(reinterpret_cast<uchar *>(data));
+			}
+		}
+
+		m_file->resize(written() * sizeof(uint16_t));
+		m_file->close();
+		releasePath(m_file->fileName());
+	}
+}
+
+uint64_t CaptureBuffer::nextVersion()
+{
+	static std::atomic<uint64_t> lastVersion(0);
+
+	return ++lastVersion;
+}
+
+CaptureBuffer::sptr CaptureBuffer::make(uint64_t size)
+{
+	const uint64_t segments = (size + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+
+	return sptr(new CaptureBuffer(size, segments, nextVersion()));
+}
+
+CaptureBuffer::sptr CaptureBuffer::makeMapped(uint64_t size, const QString &path)
+{
+	const uint64_t segments = (size + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+
+	if (path.isEmpty()) {
+		QTemporaryFile *file = openTemporaryFile();
+
+		return file ? sptr(new CaptureBuffer(size, segments, nextVersion(), file))
+			    : nullptr;
+	}
+
+	// Nothing maps the claimed file, what it held before can go
+	std::unique_ptr<QFile> file(new QFile(claimPath(path)));
+
+	if (!file->open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+		qDebug() << "Can't open capture file" << file->fileName();
+		releasePath(file->fileName());
+		return nullptr;
+	}
+
+	return sptr(new CaptureBuffer(size, segments, nextVersion(),
+				      file.release(), true));
+}
+
+CaptureBuffer::sptr CaptureBuffer::makeRing(uint64_t history)
+{
+	const uint64_t segments = (history + SEGMENT_SIZE - 1) / SEGMENT_SIZE
+			+ ringSpareSegments;
+
+	return sptr(new CaptureBuffer(std::numeric_limits<uint64_t>::max(),
+				      segments, nextVersion()));
+}
+
+CaptureBuffer::sptr CaptureBuffer::makeMappedRing(uint64_t history)
+{
+	// The samples wrap around in the file, a chosen one would be of no
+	// use once the capture is over
+	const uint64_t segments = (history + SEGMENT_SIZE - 1) / SEGMENT_SIZE
+			+ ringSpareSegments;
+	QTemporaryFile *file = openTemporaryFile();
+
+	return file ? sptr(new CaptureBuffer(std::numeric_limits<uint64_t>::max(),
+					     segments, nextVersion(), file))
+		    : nullptr;
+}
+
+uint16_t *CaptureBuffer::allocateSegment(uint64_t slot)
+{
+	// Running out of memory fails the write instead of throwing on the
+	// capture thread
+	if (!m_file) {
+		return new (std::nothrow) uint16_t[SEGMENT_SIZE];
+	}
+
+	// Each segment gets its own region of the file. The blocks are
+	// reserved before mapping: a sparse file that can't be filled in
+	// would only fail once the samples are stored, with a SIGBUS.
+	const qint64 bytes = SEGMENT_SIZE * sizeof(uint16_t);
+	const qint64 offset = slot * bytes;
+
+#ifdef Q_OS_LINUX
+	const bool reserved = !posix_fallocate(m_file->handle(), offset, bytes);
+#else
+	const bool reserved = m_file->seek(offset)
+			&& m_file->write(reinterpret_cast<const char *>(zeroSegment), bytes) == bytes
+			&& m_file->flush();
+#endif
+	if (!reserved) {
+		qDebug() << "Can't grow capture file (disk full?)" << m_file->fileName();
+		return nullptr;
+	}
+
+	return reinterpret_cast<uint16_t *>(m_file->map(offset, bytes));
+}
+
+bool CaptureBuffer::write(uint64_t from, const uint16_t *samples, uint64_t count)
+{
+	count = std::min(count, m_size - std::min(from, m_size));
+
+	while (count) {
+		const uint64_t segment = from / SEGMENT_SIZE;
+		const uint64_t offset = from % SEGMENT_SIZE;
+		const uint64_t length = std::min(count, SEGMENT_SIZE - offset);
+		const uint64_t slotIdx = segment % m_segments.size();
+		std::atomic<uint16_t *> &slot = m_segments[slotIdx];
+		uint16_t *data = slot.load(std::memory_order_relaxed);
+
+		if (!data) {
+			data = allocateSegment(slotIdx);
+			if (!data) {
+				return false;
+			}
+			slot.store(data, std::memory_order_release);
+		}
+
+		// Entering a reused ring segment drops the samples it held;
+		// readers stop looking at them before they are overwritten
+		if (segment >= m_segments.size()) {
+			const uint64_t first = (segment - m_segments.size() + 1) * SEGMENT_SIZE;
+
+			if (first > m_first.load(std::memory_order_relaxed)) {
+				m_first.store(first, std::memory_order_release);
+			}
+		}
+
+		memcpy(data + offset, samples, length * sizeof(uint16_t));
+
+		from += length;
+		samples += length;
+		count -= length;
+
+		m_written.store(std::max(m_written.load(std::memory_order_relaxed), from),
+				std::memory_order_release);
+	}
+
+	return true;
+}
+
+const uint16_t *CaptureBuffer::segmentData(uint64_t idx) const
+{
+	const uint64_t segment = idx / SEGMENT_SIZE;
+
+	// A ring slot past the written samples still holds an older segment
+	if (idx < firstSample() || segment * SEGMENT_SIZE >= written()) {
+		return nullptr;
+	}
+
+	return m_segments[segment % m_segments.size()].load(std::memory_order_acquire);
+}
+
+uint16_t CaptureBuffer::sample(uint64_t idx) const
+{
+	const uint16_t *data = segmentData(idx);
+
+	return data ? data[idx % SEGMENT_SIZE] : 0;
+}
+
+const uint16_t *CaptureBuffer::segment(uint64_t idx, uint64_t &length) const
+{
+	const uint64_t offset = idx % SEGMENT_SIZE;
+	const uint16_t *data = segmentData(idx);
+
+	length = SEGMENT_SIZE - offset;
+
+	return (data ? data : zeroSegment) + offset;
+}
+
+void CaptureBuffer::copy(uint64_t from, uint64_t count, uint16_t *dest) const
+{
+	while (count) {
+		uint64_t length;
+		const uint16_t *run = segment(from, length);
+
+		length = std::min(length, count);
+		memcpy(dest, run, length * sizeof(uint16_t));
+
+		from += length;
+		dest += length;
+		count -= length;
+	}
+}
+
+uint64_t CaptureBuffer::size() const
+{
+	return m_size;
+}
+
+uint64_t CaptureBuffer::firstSample() const
+{
+	return m_first.load(std::memory_order_acquire);
+}
+
+bool CaptureBuffer::isRing() const
+{
+	return m_size == std::numeric_limits<uint64_t>::max();
+}
+
+uint64_t CaptureBuffer::written() const
+{
+	return m_written.load(std::memory_order_acquire);
+}
+
+uint64_t CaptureBuffer::version() const
+{
+	return m_version;
+}
+
+LogicEdges &CaptureBuffer::edges()
+{
+	return m_edges;
+}
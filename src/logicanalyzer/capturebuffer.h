@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CAPTUREBUFFER_H
+#define CAPTUREBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "logicedges.h"
+
+class QFile;
+class QString;
+
+namespace adiscope {
+namespace logic {
+
+/*
+ * Samples of one logic capture. Every capture gets a new buffer with a new
+ * version number; readers (decoders, curves, exporters) keep a reference to
+ * the buffer they were told about, so starting a new capture never frees
+ * memory under their feet.
+ *
+ * The samples are stored in fixed size segments that are only allocated
+ * once the capture reaches them, so a long capture does not need one huge
+ * contiguous block and memory is only taken for the data that actually came
+ * in. A ring buffer follows an unbounded stream: once it runs out of
+ * segments it reuses the oldest one, and the samples before firstSample()
+ * are gone. It keeps a few segments more than the history it was made for,
+ * so readers that lag a couple of chunks behind the stream still find their
+ * samples.
+ *
+ * The segments either live in RAM or are mapped from a file, for captures
+ * that do not fit in memory. Readers can't tell the difference.
+ *
+ * Only the capture thread writes to the buffer, and only past the last
+ * sample announced through dataAvailable(); everything before that is
+ * read-only and can be read without any locking, until a ring drops it.
+ * A buffer is only handed to the readers once its first samples are
+ * written, and samples that are not written yet, or no longer held, read
+ * as zero.
+ */
+class CaptureBuffer
+{
+public:
+	typedef std::shared_ptr<CaptureBuffer> sptr;
+
+	/* Samples per segment */
+	static constexpr uint64_t SEGMENT_SIZE = 1 << 20;
+
+	/* Buffer that holds up to 'size' samples */
+	static sptr make(uint64_t size);
+
+	/* Buffer of 'size' samples backed by the given file; null if it
+	 * can't be opened. The file is kept and, once the buffer goes away,
+	 * holds the captured samples as raw 16 bit words. While an earlier
+	 * capture still maps it, name_1.ext, name_2.ext... are used instead.
+	 * With an empty path the buffer is backed by a temporary file that
+	 * is removed along with it. */
+	static sptr makeMapped(uint64_t size, const QString &path);
+
+	/* Buffer that holds an unbounded stream, keeping at least the
+	 * last 'history' samples */
+	static sptr makeRing(uint64_t history);
+
+	/* Ring buffer backed by a temporary file; null if it can't be
+	 * created */
+	static sptr makeMappedRing(uint64_t history);
+
+	~CaptureBuffer();
+
+	/* Stores 'count' samples starting at sample index 'from'; fails
+	 * if a segment can't be allocated (e.g. the disk is full) */
+	bool write(uint64_t from, const uint16_t *samples, uint64_t count);
+
+	uint16_t sample(uint64_t idx) const;
+
+	/* Samples from 'idx' up to the end of its segment; 'length' is set
+	 * to the number of samples in the returned run. A segment that was
+	 * never written reads as zeros. */
+	const uint16_t *segment(uint64_t idx, uint64_t &length) const;
+
+	void copy(uint64_t from, uint64_t count, uint16_t *dest) const;
+
+	/* Number of samples the buffer can hold; unbounded for a ring */
+	uint64_t size() const;
+
+	/* Oldest sample still held; always 0 unless the buffer is a ring */
+	uint64_t firstSample() const;
+
+	bool isRing() const;
+
+	/* End of the samples written so far */
+	uint64_t written() const;
+
+	uint64_t version() const;
+
+	/* Transitions found so far, shared by all the curves of the capture */
+	LogicEdges &edges();
+
+private:
+	CaptureBuffer(uint64_t size, uint64_t segments, uint64_t version,
+		      QFile *file = nullptr, bool keepFile = false);
+	CaptureBuffer(const CaptureBuffer &) = delete;
+	CaptureBuffer &operator=(const CaptureBuffer &) = delete;
+
+	static uint64_t nextVersion();
+
+	uint16_t *allocateSegment(uint64_t slot);
+
+	/* Segment holding the given sample; null if it was never written
+	 * or a ring no longer holds it */
+	const uint16_t *segmentData(uint64_t idx) const;
+
+	std::vector<std::atomic<uint16_t *>> m_segments;
+	std::unique_ptr<QFile> m_file;
+	bool m_keepFile;
+	uint64_t m_size;
+	std::atomic<uint64_t> m_first;
+	std::atomic<uint64_t> m_written;
+	uint64_t m_version;
+	LogicEdges m_edges;
+};
+} // namespace logic
+} // namespace adiscope
+
+#endif // CAPTUREBUFFER_H
@@ -38,6 +38,7 @@
  */
 
 #include "decoder.h"
+#include "decoderengine.h"
 
 #include <libsigrokdecode/libsigrokdecode.h>
 
@@ -117,6 +118,7 @@ void Decoder::apply_all_options()
                 option.first.c_str()), value);
         }
 
+        DecoderEngine::PythonLock python;
         srd_inst_option_set(decoder_inst_, opt_hash);
         g_hash_table_destroy(opt_hash);
     }
@@ -146,6 +148,7 @@ srd_decoder_inst* Decoder::create_decoder_inst(srd_session *session)
     if (decoder_inst_)
         qDebug() << "WARNING: previous decoder instance" << decoder_inst_ << "exists";
 
+    DecoderEngine::PythonLock python;
     decoder_inst_ = srd_inst_new(session, decoder_->id, opt_hash);
     g_hash_table_destroy(opt_hash);
 
@@ -143,18 +143,26 @@ QVector<QPair<uint64_t, uint64_t>> DecoderTable::getSearchSampleMask()
 	// convert the table row search mask to a sample area mask
 
 	auto curve = dynamic_cast<AnnotationCurve *>(getDecoderCruves().at(tableModel->getCurrentColumn()));
-	std::map<Row, RowData> decoder(curve->getAnnotationRows());
-	vector<Annotation> row;
+	const std::map<Row, RowData> &decoder = curve->getAnnotationRows();
+	static const vector<Annotation> no_annotations;
+	const vector<Annotation> *primary = &no_annotations;
 	QVector<QPair<uint64_t, uint64_t>> sampleMask;
 
-	for (auto row_map: decoder) {
+	for (const auto &row_map: decoder) {
 		if (row_map.first.index() == tableModel->getPrimaryAnnotationIndex()) {
-			row = row_map.second.get_annotations();
+			primary = &row_map.second.get_annotations();
 			break;
 		}
 	}
+	const vector<Annotation> &row = *primary;
+
+	const QBitArray &searchMask = tableModel->getSearchMask();
+
+	for (int index = 0; index < searchMask.size(); index++) {
+		if (!searchMask.testBit(index)) {
+			continue;
+		}
 
-	for (auto index: tableModel->getSearchMask()) {
 		int size = m_logicAnalyzer->getGroupSize();
 		int off = (m_logicAnalyzer->getGroupOffset() == 0) ? size : m_logicAnalyzer->getGroupOffset();
 
@@ -178,17 +186,17 @@ bool DecoderTable::exportTxt(QString fileName)
 	fm.open(fileName, FileManager::EXPORT);
 	QVector<QVector<QString>> decoder_data;
 	auto curve = dynamic_cast<AnnotationCurve *>(getDecoderCruves().at(tableModel->getCurrentColumn()));
-	std::map<Row, RowData> decoder(curve->getAnnotationRows());
+	const std::map<Row, RowData> &decoder = curve->getAnnotationRows();
 	auto sampleMask = getSearchSampleMask();
 
 	// set decoder data
-	std::map<Row, RowData>::iterator it;
+	std::map<Row, RowData>::const_iterator it;
 	for (it = decoder.begin(); it != decoder.end(); it++) {
-		auto annotations = it->second.get_annotations();
+		const auto &annotations = it->second.get_annotations();
 		QString title = curve->fromTitleToRowType(it->first.title());
 		if (tableModel->getFiltered().value(tableModel->getCurrentColumn()).contains(title)) continue;
 
-		for (auto ann: annotations) {
+		for (const auto &ann: annotations) {
 			QVector<QString> str = {QString::number(ann.start_sample()) + "-" + QString::number(ann.end_sample()), ann.row()->title(), ann.annotations()[0]};
 			decoder_data.append(str);
 		}
@@ -207,13 +215,13 @@ bool DecoderTable::exportCsv(QString fileName)
 	fm.open(fileName, FileManager::EXPORT);
 
 	QStringList columnNames;
-	std::map<Row, RowData>::iterator it;
+	std::map<Row, RowData>::const_iterator it;
 	int col = tableModel->getCurrentColumn();
 	uint64_t last_sample = 0;
 
 	QVector<QVector<QString>> decoder_data;
 	AnnotationCurve *curve = dynamic_cast<AnnotationCurve *>(getDecoderCruves().at(col));
-	std::map<Row, RowData> decoder(curve->getAnnotationRows());
+	const std::map<Row, RowData> &decoder = curve->getAnnotationRows();
 	QRegExp rx =  QRegExp(tableModel->getsearchString(), Qt::CaseInsensitive);
 	int row_count = 0;
 	int primaryCol = 0;
@@ -251,7 +259,7 @@ bool DecoderTable::exportCsv(QString fileName)
 
 	// populate decoder_data
 	for (it = decoder.begin(); it != decoder.end(); it++) {
-		auto row = it->second.get_annotations();
+		const auto &row = it->second.get_annotations();
 		auto title = curve->fromTitleToRowType(it->first.title());
 		if (tableModel->getFiltered()[col].contains(title) || row.empty()) continue;
 		row_count++;
@@ -145,7 +145,7 @@ void DecoderTableItem::paint(
 		curve->drawAnnotationInfo(offset, startSample, endSample, painter, xmap, ymap, rect);
 	}
 	for (int row = 0; row < curve->getAnnotationRows().size(); ++row) {
-		auto entry = *std::find_if(curve->getAnnotationRows().begin(), curve->getAnnotationRows().end(),
+		const auto &entry = *std::find_if(curve->getAnnotationRows().begin(), curve->getAnnotationRows().end(),
 				       [row](const std::pair<const Row, RowData> &t) -> bool{
 			return t.first.index() == row;
 		});
@@ -160,7 +160,7 @@ void DecoderTableItem::paint(
 			data.get_annotation_subset(range, startSample - 1, endSample);
 		}
 
-		for (auto ann: range) {
+		for (const auto &ann: range) {
 			curve->drawAnnotation(
 						offset, ann, painter, xmap, ymap, rect, mapper,
 						interval, titleSize);
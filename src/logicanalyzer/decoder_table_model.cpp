@@ -24,6 +24,7 @@
 #include <QDebug>
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QHash>
 #include <QHeaderView>
 #include <QRegExp>
 
@@ -48,9 +49,9 @@ void DecoderTableModel::setDefaultPrimaryAnnotations()
 {
 	for (int i=DIGITAL_NR_CHANNELS; i<m_plotCurves.size(); i++) {
 		int count = 0;
-		std::map<Row, RowData>::iterator it;
+		std::map<Row, RowData>::const_iterator it;
 		AnnotationCurve *curve = dynamic_cast<AnnotationCurve *>(m_plotCurves[i]);
-		std::map<Row, RowData> decoder(curve->getAnnotationRows());
+		const std::map<Row, RowData> &decoder = curve->getAnnotationRows();
 
 		for (it = decoder.begin(); it != decoder.end(); it++) {
 			if (!it->second.get_annotations().empty()) {
@@ -172,7 +173,7 @@ void DecoderTableModel::setSearchString(QString str) const
 	searchString = str;
 }
 
-QVector<int> DecoderTableModel::getSearchMask()
+const QBitArray &DecoderTableModel::getSearchMask() const
 {
 	return searchMask;
 }
@@ -250,8 +251,8 @@ void DecoderTableModel::refreshColumn(double column) const
 	int rowHeight = 25;
 
 	int row_count = 0;
-	std::map<Row, RowData>::iterator it;
-	std::map<Row, RowData> decoder(curve->getAnnotationRows());
+	std::map<Row, RowData>::const_iterator it;
+	const std::map<Row, RowData> &decoder = curve->getAnnotationRows();
 
 	for (it = decoder.begin(); it != decoder.end(); it++) {
 		if (!it->second.get_annotations().empty()) {
@@ -274,7 +275,7 @@ void DecoderTableModel::refreshColumn(double column) const
 	}
 
 	for (int row = 0; row < rowCount(); row++) {
-		if (row < index && !searchMask.contains(row) && row < grouped_rows) {
+		if (row < index && !(row < searchMask.size() && searchMask.testBit(row)) && row < grouped_rows) {
 			m_decoderTable->showRow(row);
 			no_rows = false;
 		} else {
@@ -307,12 +308,11 @@ void DecoderTableModel::populateFilter(int index) const
 {
 	if (index < 0 || m_plotCurves.empty()) return;
 	auto temp_curve = dynamic_cast<AnnotationCurve *>(m_plotCurves.at(index));
-	std::map<Row, RowData> decoder(temp_curve->getAnnotationRows());
 	m_logic->clearFilter();
 
 	int count = 0;
 	for (int row = 0; row < temp_curve->getAnnotationRows().size(); ++row) {
-		auto row_map = *std::find_if(temp_curve->getAnnotationRows().begin(), temp_curve->getAnnotationRows().end(),
+		const auto &row_map = *std::find_if(temp_curve->getAnnotationRows().begin(), temp_curve->getAnnotationRows().end(),
 					     [row](const std::pair<const Row, RowData> &t) -> bool{
 			return t.first.index() == row;
 		});
@@ -346,19 +346,20 @@ QVariant DecoderTableModel::data(const QModelIndex &index, int role) const
 			!m_decoderTable->isVisible()) return QVariant();
 
 	auto temp_curve = dynamic_cast<AnnotationCurve *>(m_plotCurves.at(index.column()));
-	std::map<Row, RowData> decoder(temp_curve->getAnnotationRows());
-	vector<Annotation> row;
+	const std::map<Row, RowData> &decoder = temp_curve->getAnnotationRows();
+	const vector<Annotation> *primary = nullptr;
 
-	for (auto row_map: decoder) {
-		row = row_map.second.get_annotations();
-		if (!row.empty() && row_map.first.index() == getPrimaryAnnotationIndex()) {
+	for (const auto &row_map: decoder) {
+		primary = &row_map.second.get_annotations();
+		if (!primary->empty() && row_map.first.index() == getPrimaryAnnotationIndex()) {
 			break;
 		}
 	}
 
-	if (row.empty()) {
+	if (!primary || primary->empty()) {
 		return QVariant();
 	}
+	const vector<Annotation> &row = *primary;
 
 	if (to_be_refreshed) {
 		refreshColumn(col);
@@ -371,7 +372,7 @@ QVariant DecoderTableModel::data(const QModelIndex &index, int role) const
 	if ((row.size() - m_logic->getGroupOffset()) % m_logic->getGroupSize() != 0) {
 		total_rows++;
 	}
-	if (searchMask.count() == total_rows) {
+	if (searchMask.count(true) == total_rows) {
 		return QVariant();
 	}
 
@@ -394,16 +395,99 @@ QVariant DecoderTableModel::data(const QModelIndex &index, int role) const
 					   ));
 }
 
+const RowData *DecoderTableModel::primaryRow(const std::map<Row, RowData> &rows,
+					     int column, QString *title) const
+{
+	const RowData *primary = nullptr;
+
+	auto temp_curve = dynamic_cast<AnnotationCurve *>(m_plotCurves.at(column));
+
+	for (const auto &row_map: rows) {
+		primary = &row_map.second;
+		if (title) {
+			*title = temp_curve->fromTitleToRowType(row_map.first.title());
+		}
+
+		if (primary->size() && row_map.first.index() == m_primary_annoations->value(column)) {
+			break;
+		}
+	}
+
+	return primary;
+}
+
+QVector<qint64> DecoderTableModel::searchContext(const RowData *primary) const
+{
+	// Everything that decides which annotations end up in which table row
+	if (m_plotCurves.empty()) {
+		return QVector<qint64>();
+	}
+
+	return QVector<qint64>({m_current_column, m_primary_annoations->value(m_current_column),
+				m_logic->getGroupSize(), m_logic->getGroupOffset(),
+				qint64(primary ? primary->size() : 0)});
+}
+
 void DecoderTableModel::searchBoxSlot(QString text)
 {
-	if (m_decoderTable->signalsBlocked()) return;
+	// A new query supersedes the one being searched, which gives up as
+	// soon as it notices
+	const unsigned int generation = ++m_searchGeneration;
+
 	m_decoderTable->blockSignals(true);
+	setSearchString(text);
+
+	// The decoder keeps adding annotations while the search runs, so the
+	// search gets its own copy of the rows, along with everything else it
+	// needs from the GUI
+	SearchJob job;
+
+	job.text = text;
+	job.generation = generation;
+	job.primary = nullptr;
+	job.groupSize = m_logic->getGroupSize();
+	job.groupOffset = m_logic->getGroupOffset();
+
+	if (!text.isEmpty() && !m_plotCurves.empty()) {
+		auto temp_curve = dynamic_cast<AnnotationCurve *>(m_plotCurves.at(m_current_column));
+		QString primary_title;
+
+		job.rows = temp_curve->snapshotAnnotationRows();
+		job.primary = primaryRow(*job.rows, m_current_column, &primary_title);
+
+		// Rows to look into, with their titles resolved once
+		for (const auto &row_map: *job.rows) {
+			if (!row_map.second.size()) continue;
+			QString title = temp_curve->fromTitleToRowType(row_map.first.title());
+			if (m_filteredMessages.value(m_current_column).contains(title)) continue;
+
+			job.searchRows.push_back({&row_map.second, title == primary_title});
+		}
+	}
+
+	// Typing on: a plain text query that extends the previous one can
+	// only hide more rows, so the rows hidden already are skipped
+	const QVector<qint64> context = searchContext(job.primary);
+
+	if (!m_searchMaskString.isEmpty() && context == m_searchMaskContext &&
+			text.startsWith(m_searchMaskString, Qt::CaseInsensitive) &&
+			QRegExp::escape(text) == text) {
+		job.previous = searchMask;
+	}
 
 	m_logic->setStatusLabel("Searching ...");
-	QFuture<void> future = QtConcurrent::run(this, &DecoderTableModel::searchTable, text);
-	QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
+	QFuture<QBitArray> future = QtConcurrent::run(this, &DecoderTableModel::searchTable, job);
+	QFutureWatcher<QBitArray> *watcher = new QFutureWatcher<QBitArray>(this);
+
+	connect(watcher, &QFutureWatcher<QBitArray>::finished, this, [=](){
+		if (generation != m_searchGeneration) {
+			return;
+		}
+
+		searchMask = watcher->result();
+		m_searchMaskString = text;
+		m_searchMaskContext = context;
 
-	connect(watcher, &QFutureWatcher<void>::finished, this, [=](){
 		m_decoderTable->blockSignals(false);
 
 		beginResetModel();
@@ -416,79 +500,105 @@ void DecoderTableModel::searchBoxSlot(QString text)
 	watcher->setFuture(future);
 }
 
-void DecoderTableModel::searchTable(QString text)
+QBitArray DecoderTableModel::searchTable(SearchJob job)
 {
-	setSearchString(text);
-	searchMask.clear();
+	QBitArray mask;
 
-	if (!searchString.isEmpty()) {
-		QRegExp rx =  QRegExp(searchString, Qt::CaseInsensitive);
+	if (job.text.isEmpty() || !job.primary) {
+		return mask;
+	}
 
-		auto temp_curve = dynamic_cast<AnnotationCurve *>(m_plotCurves.at(m_current_column));
-		std::map<Row, RowData> decoder(temp_curve->getAnnotationRows());
-		vector<Annotation> row;
-		int row_index = -1;
-		QString primary_title;
+	QRegExp rx =  QRegExp(job.text, Qt::CaseInsensitive);
 
-		// get primary annotation
-		for (auto row_map: decoder) {
-			row = row_map.second.get_annotations();
-			primary_title = temp_curve->fromTitleToRowType(row_map.first.title());
+	const vector<Annotation> &row = job.primary->get_annotations();
+	QBitArray &previous = job.previous;
 
-			if (!row.empty() && row_map.first.index() == m_primary_annoations->value(m_current_column)) {
+	// Annotation texts are interned, so each distinct text is matched
+	// against the query only once no matter how often it shows up
+	QHash<const vector<QString> *, bool> text_matches;
+	auto matches = [&](const Annotation &ann) -> bool {
+		const vector<QString> *key = &ann.annotations();
+		auto it = text_matches.constFind(key);
+		if (it != text_matches.constEnd()) {
+			return it.value();
+		}
+
+		bool found = false;
+		for (const auto &value: *key) {
+			if (rx.indexIn(value) != -1) {
+				found = true;
 				break;
 			}
 		}
+		text_matches.insert(key, found);
 
-		uint64_t i = 0;
-		uint64_t end_sample;
-		uint64_t start_sample;
-		while(i < row.size()) {
-			start_sample = row[i].start_sample();
+		return found;
+	};
 
-			if (i == 0 && m_logic->getGroupOffset() != 0) {
-				end_sample = row[m_logic->getGroupOffset() - 1].end_sample();
-			} else {
-				end_sample = row[std::min(uint64_t(i + m_logic->getGroupSize() - 1), uint64_t(row.size() - 1))].end_sample();
-			}
-			row_index++;
+	const uint64_t group_size = job.groupSize;
+	const uint64_t group_offset = job.groupOffset;
 
-			for (auto row_map: decoder) {
-				if (row_map.second.get_annotations().empty()) continue;
-				QString title = temp_curve->fromTitleToRowType(row_map.first.title());
-				if (m_filteredMessages.value(m_current_column).contains(title)) continue;
+	// One bit per table row, set for the rows without a match
+	int table_rows = 0;
+	for (uint64_t i = 0; i < row.size(); table_rows++) {
+		i = (i == 0 && group_offset != 0) ? group_offset : i + group_size;
+	}
+	mask.resize(table_rows);
 
-				auto index_range = row_map.second.get_annotation_subset(start_sample, end_sample);
-				uint64_t j = index_range.first;
+	if (previous.size() != table_rows) {
+		previous.clear();
+	}
+
+	uint64_t i = 0;
+	uint64_t end_sample;
+	uint64_t start_sample;
+	for (int row_index = 0; i < row.size(); row_index++) {
+		if (job.generation != m_searchGeneration) {
+			return QBitArray();
+		}
 
-				while (j <= index_range.second && j < row_map.second.size()) {
-					auto ann = row_map.second.getAnnAt(j);
+		start_sample = row[i].start_sample();
 
-					if ((title != primary_title &&
+		if (i == 0 && group_offset != 0) {
+			end_sample = row[group_offset - 1].end_sample();
+		} else {
+			end_sample = row[std::min(uint64_t(i + group_size - 1), uint64_t(row.size() - 1))].end_sample();
+		}
+
+		bool found = false;
+
+		if (previous.isEmpty() || !previous.testBit(row_index)) {
+			for (const SearchRow &search_row: job.searchRows) {
+				const RowData &data = *search_row.data;
+				auto index_range = data.get_annotation_subset(start_sample, end_sample);
+
+				for (uint64_t j = index_range.first; j <= index_range.second && j < data.size() && !found; j++) {
+					const Annotation &ann = *data.annAt(j);
+
+					if ((!search_row.primary &&
 					     (((unsigned)(ann.end_sample()-start_sample-1) <= (end_sample-start_sample-1) ||
 					      (unsigned)(ann.start_sample()-start_sample) < (end_sample-start_sample)) ||
 					     (ann.start_sample() <= start_sample && ann.end_sample() >= end_sample))) ||
 							(start_sample <= ann.start_sample() && ann.end_sample() <= end_sample)) {
-
-						for (auto value: ann.annotations()) {
-							if (rx.indexIn(value) != -1) {
-								goto skip_loop;
-							}
-						}
+						found = matches(ann);
 					}
-					j++;
 				}
-			}
-			// add to mask if not found
-			searchMask.append(row_index);
-skip_loop:
-			if (i == 0 && m_logic->getGroupOffset() != 0) {
-				i = m_logic->getGroupOffset();
-			} else {
-				i += m_logic->getGroupSize();
+
+				if (found) {
+					break;
+				}
 			}
 		}
+
+		// add to mask if not found
+		if (!found) {
+			mask.setBit(row_index);
+		}
+
+		i = (i == 0 && group_offset != 0) ? group_offset : i + group_size;
 	}
+
+	return mask;
 }
 
 } // namespace logic
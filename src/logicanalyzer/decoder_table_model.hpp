@@ -21,8 +21,10 @@
 #ifndef DECODER_TABLE_MODEL_H
 #define DECODER_TABLE_MODEL_H
 
+#include <atomic>
 #include <bitset>
 #include <QAbstractTableModel>
+#include <QBitArray>
 #include <QMap>
 #include "annotationcurve.h"
 #include "decoder_table.hpp"
@@ -66,7 +68,8 @@ public:
     mutable int to_be_refreshed;
     void refreshSettings(int column = -1);
     void setSearchString(QString str) const;
-    QVector<int> getSearchMask();
+    // One bit per table row, set for the rows hidden by the search
+    const QBitArray &getSearchMask() const;
     QString getsearchString();
     int getPrimaryAnnotationIndex() const;
 
@@ -94,9 +97,37 @@ protected:
     QMap<int, QVector<QString>> m_filteredMessages;
     mutable int max_row_count = 0;
     mutable QString searchString;
-    QVector<int> searchMask;
+    QBitArray searchMask;
 private:
-    void searchTable(QString text);
+    struct SearchRow {
+        const RowData *data;
+        bool primary;
+    };
+
+    // What a search runs on, gathered on the GUI thread. The rows are a
+    // snapshot that the decoder does not touch.
+    struct SearchJob {
+        QString text;
+        QBitArray previous;
+        unsigned int generation;
+        std::shared_ptr<const std::map<Row, RowData>> rows;
+        const RowData *primary;
+        QVector<SearchRow> searchRows;
+        uint64_t groupSize;
+        uint64_t groupOffset;
+    };
+
+    // Runs on a worker thread; returns early, with an empty mask, once a
+    // newer search is started. Rows set in 'previous' are known misses.
+    QBitArray searchTable(SearchJob job);
+
+    const RowData *primaryRow(const std::map<Row, RowData> &rows, int column,
+                              QString *title = nullptr) const;
+    QVector<qint64> searchContext(const RowData *primary) const;
+
+    std::atomic<unsigned int> m_searchGeneration{0};
+    QString m_searchMaskString;
+    QVector<qint64> m_searchMaskContext;
 };
 
 } // namespace logic
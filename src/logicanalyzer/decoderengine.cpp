@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Python.h>
+
+#include "decoderengine.h"
+
+#include <libsigrokdecode/libsigrokdecode.h>
+
+using namespace adiscope;
+
+DecoderEngine *DecoderEngine::getInstance()
+{
+	static DecoderEngine engine;
+	return &engine;
+}
+
+DecoderEngine::DecoderEngine()
+	: m_sending(0)
+	, m_loading(false)
+	, m_loaded(false)
+	, m_mainThreadState(nullptr)
+{
+}
+
+DecoderEngine::~DecoderEngine()
+{
+}
+
+std::mutex &DecoderEngine::globalMutex()
+{
+	return m_globalMutex;
+}
+
+bool DecoderEngine::isLoaded()
+{
+	std::lock_guard<std::mutex> lock(m_globalMutex);
+	return m_loaded;
+}
+
+void DecoderEngine::unload()
+{
+	if (!m_loaded) {
+		return;
+	}
+
+	// srd_exit() takes the GIL itself; give it back to this thread first
+	// if it was parked here after srd_init()
+	if (m_mainThreadState) {
+		PyEval_RestoreThread(m_mainThreadState);
+		m_mainThreadState = nullptr;
+	}
+
+	srd_exit();
+	m_loaded = false;
+}
+
+bool DecoderEngine::load(const std::string &path)
+{
+	std::unique_lock<std::mutex> lock(m_globalMutex);
+
+	// Keep new sends out and let the ones in flight finish
+	m_loading = true;
+	m_idleCv.wait(lock, [&]{ return m_sending == 0; });
+
+	unload();
+
+	bool ok = srd_init(path.c_str()) == SRD_OK;
+
+	if (ok) {
+		{
+			PythonLock python;
+			srd_decoder_load_all();
+		}
+
+		// Older libsigrokdecode versions return from srd_init() with the
+		// GIL still held by the calling thread. The decoder instances
+		// run on their own threads and would block on it forever.
+		if (PyGILState_Check()) {
+			m_mainThreadState = PyEval_SaveThread();
+		}
+
+		m_loaded = true;
+	}
+
+	m_loading = false;
+	m_idleCv.notify_all();
+
+	return ok;
+}
+
+DecoderEngine::PythonLock::PythonLock()
+	: m_locked(Py_IsInitialized())
+	, m_state(0)
+{
+	if (m_locked) {
+		m_state = PyGILState_Ensure();
+	}
+}
+
+DecoderEngine::PythonLock::~PythonLock()
+{
+	if (m_locked) {
+		PyGILState_Release(static_cast<PyGILState_STATE>(m_state));
+	}
+}
+
+DecoderEngine::SendScope::SendScope(DecoderEngine *engine)
+	: m_engine(engine)
+{
+	std::unique_lock<std::mutex> lock(m_engine->m_globalMutex);
+
+	m_engine->m_idleCv.wait(lock, [&]{ return !m_engine->m_loading; });
+	m_engine->m_sending++;
+}
+
+DecoderEngine::SendScope::~SendScope()
+{
+	std::lock_guard<std::mutex> lock(m_engine->m_globalMutex);
+
+	if (--m_engine->m_sending == 0) {
+		m_engine->m_idleCv.notify_all();
+	}
+}
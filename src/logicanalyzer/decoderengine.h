@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DECODERENGINE_H
+#define DECODERENGINE_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+struct srd_session;
+struct _ts;
+
+namespace adiscope {
+
+/*
+ * Owns the process-wide libsigrokdecode state.
+ *
+ * Every decoder stack gets its own srd session, fed by its own thread.
+ * Sessions are independent: inside libsigrokdecode each decoder instance
+ * runs on a worker thread which only takes the Python GIL while it executes
+ * decoder code, so srd_session_send() calls on different sessions can run
+ * at the same time. What is not thread safe is the global state (the
+ * session list, the loaded decoders, srd_init()/srd_exit()); anything that
+ * touches it has to hold globalMutex().
+ */
+class DecoderEngine
+{
+public:
+	static DecoderEngine *getInstance();
+
+	/* (Re)initializes libsigrokdecode and loads all the decoders found in
+	 * path. Waits for the sessions that are decoding to finish sending. */
+	bool load(const std::string &path);
+	bool isLoaded();
+
+	/* Lock required by session creation/destruction and instance stacking */
+	std::mutex &globalMutex();
+
+	/*
+	 * Holds the Python GIL for the calling thread. Every libsigrokdecode
+	 * call that can run decoder code is made under one: older versions
+	 * expect the caller to hold the GIL and only give it up while they
+	 * wait for their decoder threads, newer ones take it themselves and
+	 * do not mind it being held already.
+	 */
+	class PythonLock
+	{
+	public:
+		PythonLock();
+		~PythonLock();
+
+	private:
+		bool m_locked;
+		int m_state;
+	};
+
+	/*
+	 * Held by a decoding thread around srd_session_send(). Any number of
+	 * sessions can be sending at once; load() waits for all of them.
+	 */
+	class SendScope
+	{
+	public:
+		explicit SendScope(DecoderEngine *engine);
+		~SendScope();
+
+	private:
+		DecoderEngine *m_engine;
+	};
+
+private:
+	DecoderEngine();
+	~DecoderEngine();
+	DecoderEngine(const DecoderEngine &) = delete;
+	DecoderEngine &operator=(const DecoderEngine &) = delete;
+
+	void unload();
+
+	std::mutex m_globalMutex;
+	std::condition_variable m_idleCv;
+	int m_sending;
+	bool m_loading;
+	bool m_loaded;
+
+	/* State of the thread that initialized Python, saved while the GIL
+	 * is released so that the decoder threads can take it */
+	struct _ts *m_mainThreadState;
+};
+}
+
+#endif // DECODERENGINE_H
@@ -21,6 +21,7 @@
 
 #include "genericlogicplotcurve.h"
 #include <qwt_plot.h>
+#include <algorithm>
 #include <qwt_scale_map.h>
 
 
@@ -37,6 +38,7 @@ GenericLogicPlotCurve::GenericLogicPlotCurve(const QString &name, const QString
 	m_sampleRate(sampleRate),
 	m_timeTriggerOffset(timeTriggerOffset),
 	m_bufferSize(bufferSize),
+	m_firstSample(0),
 	m_type(type)
 {
 }
@@ -89,6 +91,11 @@ uint64_t GenericLogicPlotCurve::getBufferSize() const
 	return m_bufferSize;
 }
 
+uint64_t GenericLogicPlotCurve::getFirstSample() const
+{
+	return m_firstSample;
+}
+
 LogicPlotCurveType GenericLogicPlotCurve::getType() const
 {
 	return m_type;
@@ -155,11 +162,17 @@ void GenericLogicPlotCurve::setBufferSize(uint64_t bufferSize)
 	}
 }
 
+void GenericLogicPlotCurve::setLastSample(uint64_t sample)
+{
+	m_firstSample = sample > m_bufferSize ? sample - m_bufferSize : 0;
+}
+
 uint64_t GenericLogicPlotCurve::fromTimeToSample(double time) const
 {
 	const double totalTime = getTotalTime();
 	const double tmin = (m_timeTriggerOffset * (1.0 / m_sampleRate));
 	const double tmax = totalTime + (m_timeTriggerOffset * (1.0 / m_sampleRate));
+	const uint64_t first = m_firstSample;
 	const double smin = 0;
 	const double smax = m_bufferSize;
 
@@ -171,7 +184,7 @@ uint64_t GenericLogicPlotCurve::fromTimeToSample(double time) const
 		time = tmin;
 	}
 
-	return (time - tmin) / (tmax - tmin) * (smax - smin) + smin;
+	return first + static_cast<uint64_t>((time - tmin) / (tmax - tmin) * (smax - smin) + smin);
 }
 
 double GenericLogicPlotCurve::fromSampleToTime(uint64_t sample) const
@@ -179,9 +192,13 @@ double GenericLogicPlotCurve::fromSampleToTime(uint64_t sample) const
 	const double totalTime = getTotalTime();
 	const double tmin = (m_timeTriggerOffset * (1.0 / m_sampleRate));
 	const double tmax = totalTime + (m_timeTriggerOffset * (1.0 / m_sampleRate));
+	const uint64_t first = m_firstSample;
 	const double smin = 0;
 	const double smax = m_bufferSize;
 
+	// Relative to the start of the time axis
+	sample -= std::min(sample, first);
+
 	if (sample > smax) {
 		sample = smax;
 	}
@@ -27,6 +27,8 @@
 #include <QColor>
 #include <QObject>
 
+#include <atomic>
+
 enum class LogicPlotCurveType : int {
 	Data = 0,
 	Annotations = 1,
@@ -49,6 +51,7 @@ public:
 	double getTotalTime() const;
 	double getTimeTriggerOffset() const;
 	uint64_t getBufferSize() const;
+	uint64_t getFirstSample() const;
 
 	LogicPlotCurveType getType() const;
 
@@ -61,6 +64,10 @@ public:
 	void setTimeTriggerOffset(double timeTriggerOffset);
 	void setBufferSize(uint64_t bufferSize);
 
+	// The time axis covers the buffer size. A continuous capture goes
+	// past it, the axis then follows its last samples up to 'sample'.
+	void setLastSample(uint64_t sample);
+
 	// Classes who inherit from GenericLogicPlotCurve must provide their
 	// own behaviour for these methods
 	virtual void dataAvailable(uint64_t from, uint64_t to) {}
@@ -90,6 +97,7 @@ protected:
 	double m_sampleRate;
 	double m_timeTriggerOffset;
 	uint64_t m_bufferSize;
+	std::atomic<uint64_t> m_firstSample;
 	LogicPlotCurveType m_type;
 };
 
@@ -31,6 +31,7 @@
 #include "logicanalyzer/logicdatacurve.h"
 #include "logicanalyzer/annotationcurve.h"
 #include "logicanalyzer/decoder.h"
+#include "logicanalyzer/decoderengine.h"
 #include "logicanalyzer/decoder_table_model.hpp"
 
 #include "gui/basemenu.h"
@@ -264,6 +265,9 @@ LogicAnalyzer::LogicAnalyzer(struct iio_context *ctx, adiscope::Filter *filt,
 
 LogicAnalyzer::~LogicAnalyzer()
 {
+	m_exportCancelled = true;
+	m_exportFuture.waitForFinished();
+
 	if (saveOnExit) {
 		api->save(*settings);
 	}
@@ -285,10 +289,7 @@ LogicAnalyzer::~LogicAnalyzer()
 		delete curve;
 	}
 
-	if (m_buffer) {
-		delete[] m_buffer;
-		m_buffer = nullptr;
-	}
+	setCapture(nullptr);
 
 	delete cr_ui;
 	delete ui;
@@ -305,14 +306,10 @@ void LogicAnalyzer::setData(const uint16_t * const data, int size)
 
 	qDebug() << "Set data arrived: ";
 
-	if (m_buffer) {
-		delete m_buffer;
-		m_buffer = nullptr;
-	}
-
-	m_buffer = new uint16_t[size];
+	CaptureBuffer::sptr capture = CaptureBuffer::make(size);
 
-	memcpy(m_buffer, data, size * sizeof(uint16_t));
+	capture->write(0, data, size);
+	setCapture(capture);
 	Q_EMIT dataAvailable(0, size);
 
 //	if (m_oscPlot) {
@@ -1521,7 +1518,6 @@ bool LogicAnalyzer::setPrimaryAnntations(int column, int index)
 	bool changed = false;
 	ui->primaryAnnotationComboBox->clear();
 	auto curve = dynamic_cast<AnnotationCurve *>(getPlotCurves(true)[DIGITAL_NR_CHANNELS + column]);
-	std::map<Row, RowData> decoder(curve->getAnnotationRows());
 
 	for (int row = 0; row < curve->getAnnotationRows().size(); ++row) {
 		auto it = std::find_if(curve->getAnnotationRows().begin(), curve->getAnnotationRows().end(),
@@ -1690,6 +1686,19 @@ void LogicAnalyzer::connectSignalsAndSlots()
 		ui->decoderTableView->decoderModel()->searchBoxSlot(text);
 	});
 
+	// Search as the user types, once the typing pauses; a new query
+	// cancels the one still being searched
+	QTimer *searchTimer = new QTimer(this);
+	searchTimer->setSingleShot(true);
+	searchTimer->setInterval(250);
+	connect(ui->searchBox, &QLineEdit::textEdited, searchTimer,
+		static_cast<void (QTimer::*)()>(&QTimer::start));
+	connect(searchTimer, &QTimer::timeout, [=](){
+		if (ui->decoderTableView->decoderModel()) {
+			emitSearchSignal();
+		}
+	});
+
 	connect(ui->runSingleWidget, &RunSingleWidget::toggled,
 		[=](bool checked){
 		auto btn = dynamic_cast<CustomPushButton *>(run_button);
@@ -1925,15 +1934,17 @@ void LogicAnalyzer::updateBufferPreviewer(int64_t min, int64_t max)
 	// Time interval within the plot canvas
 	QwtInterval plotInterval = m_plot.axisInterval(QwtAxis::XBottom);
 
-	// Time interval that represents the captured data
+	// Time interval that represents the captured data. A continuous
+	// capture shows its last buffer of samples
 	QwtInterval dataInterval(0.0, 0.0);
 	long long totalSamples = m_bufferSize;
+	const int64_t first = max > totalSamples ? max - totalSamples : 0;
 
 	if (totalSamples > 0) {
 		const int offset = ui->btnStreamOneShot->isChecked() ? m_timePositionButton->value()
 								     : 0;
 		dataInterval.setMinValue(offset / m_sampleRate);
-		dataInterval.setMaxValue((offset + max) / m_sampleRate);
+		dataInterval.setMaxValue((offset + max - first) / m_sampleRate);
 	}
 
 	// Use the two intervals to determine the width and position of the
@@ -1962,6 +1973,13 @@ void LogicAnalyzer::updateBufferPreviewer(int64_t min, int64_t max)
 	m_bufferPreviewer->setHighlightWidth(hWidth);
 	m_bufferPreviewer->setHighlightPos(hPos);
 	m_bufferPreviewer->setCursorPos(cPos);
+
+	// This also runs on the capture thread, the waveform is built on
+	// the GUI thread
+	const CaptureBuffer::sptr capture = getCapture();
+	QMetaObject::invokeMethod(m_bufferPreviewer, [=](){
+		m_bufferPreviewer->setCapture(capture, first, max);
+	}, Qt::QueuedConnection);
 }
 
 void LogicAnalyzer::initBufferScrolling()
@@ -2105,6 +2123,14 @@ void LogicAnalyzer::startStop(bool start)
 		const bool oneShotOrStream = ui->btnStreamOneShot->isChecked();
 		qDebug() << "stream one shot is set to: " << oneShotOrStream;
 
+		const bool captureToDisk = m_captureToDisk;
+		const QString captureFile = m_captureFile;
+
+		// Streaming in run mode goes on until stopped, keeping the last
+		// buffer of samples
+		const bool continuous = !oneShotOrStream && m_continuousStream &&
+			ui->runSingleWidget->runButtonChecked();
+
 		const double delay = oneShotOrStream ? m_timeTriggerOffset * m_sampleRate
 					       : 0;
 
@@ -2127,12 +2153,11 @@ void LogicAnalyzer::startStop(bool start)
 
 		m_captureThread = new std::thread([=](){
 
-			if (m_buffer) {
-				delete[] m_buffer;
-				m_buffer = nullptr;
-			}
-
-			m_buffer = new uint16_t[bufferSizeAdjusted];
+			// Readers of the previous capture keep their own reference to
+			// it; this one is handed to them once its first chunk is in
+			CaptureBuffer::sptr capture = makeCaptureBuffer(bufferSizeAdjusted,
+									captureToDisk, captureFile,
+									continuous);
 			QMetaObject::invokeMethod(this, [=](){
 				m_exportSettings->enableExportButton(true);
 			}, Qt::DirectConnection);
@@ -2219,6 +2244,7 @@ void LogicAnalyzer::startStop(bool start)
 			}
 
 			uint64_t absIndex = 0;
+			bool storeFailed = false;
 
 			// notify that the acquisition started one waiting for it
 			// to start, in order to correctly stop it
@@ -2240,10 +2266,23 @@ void LogicAnalyzer::startStop(bool start)
 					}
 
 					const uint16_t * const temp = m_m2kDigital->getSamplesP(chunk_size);
-					memcpy(m_buffer + absIndex, temp, sizeof(uint16_t) * captureSize);
+					if (!capture->write(absIndex, temp, captureSize)) {
+						qDebug() << "Can't store the capture (disk full?), stopping";
+						storeFailed = true;
+						break;
+					}
+
+					// The samples announced so far belong to the previous
+					// capture, they are dropped before the switch
+					if (getCapture() != capture) {
+						m_lastCapturedSample = 0;
+						setCapture(capture);
+					}
 
 					absIndex += captureSize;
-					totalSamples -= captureSize;
+					if (!continuous) {
+						totalSamples -= captureSize;
+					}
 
 					if (m_autoMode) {
 						QMetaObject::invokeMethod(this, [=](){
@@ -2303,6 +2342,12 @@ void LogicAnalyzer::startStop(bool start)
 					totalSamples = bufferSizeAdjusted;
 					absIndex = 0;
 
+					// Every acquisition gets its own buffer, the previous
+					// one may still be read by the decoders
+					capture = makeCaptureBuffer(bufferSizeAdjusted,
+								    captureToDisk, captureFile,
+								    continuous);
+
 					int ms = (int)(1000.0 / getScopyPreferences()->getTarget_fps());
 					std::this_thread::sleep_for(std::chrono::milliseconds(ms));
 				}
@@ -2310,7 +2355,16 @@ void LogicAnalyzer::startStop(bool start)
 
 			m_started = false;
 
-			if (ui->runSingleWidget->singleButtonChecked()) {
+			// Out of memory or disk space: the run stops as well, and
+			// the reason is shown on the plot until the next one
+			if (storeFailed) {
+				QMetaObject::invokeMethod(this, [=](){
+					m_plot.setMaxBufferSizeErrorLabel(true,
+						tr("Capture stopped: not enough memory or disk space"));
+				}, Qt::QueuedConnection);
+			}
+
+			if (storeFailed || ui->runSingleWidget->singleButtonChecked()) {
 				QMetaObject::invokeMethod(ui->runSingleWidget,
 							  "toggle",
 							  Qt::QueuedConnection,
@@ -2357,8 +2411,12 @@ void LogicAnalyzer::startStop(bool start)
 
 void LogicAnalyzer::setupDecoders()
 {
-	if (srd_decoder_load_all() != SRD_OK) {
-		qDebug() << "Error: srd_decoder_load_all failed!";
+	{
+		DecoderEngine::PythonLock python;
+
+		if (srd_decoder_load_all() != SRD_OK) {
+			qDebug() << "Error: srd_decoder_load_all failed!";
+		}
 	}
 
 	ui->addDecoderComboBox->addItem(tr("Select a decoder to add"));
@@ -2810,10 +2868,40 @@ void LogicAnalyzer::restoreTriggerState()
 	}
 }
 
+uint64_t LogicAnalyzer::capturedSamples(const CaptureBuffer::sptr &capture) const
+{
+	// The count may still be the one of the capture before
+	return capture ? std::min<uint64_t>(m_lastCapturedSample, capture->written()) : 0;
+}
+
+CaptureBuffer::sptr LogicAnalyzer::makeCaptureBuffer(uint64_t size, bool toDisk,
+						     const QString &file,
+						     bool continuous) const
+{
+	CaptureBuffer::sptr capture;
+
+	if (continuous) {
+		if (toDisk) {
+			capture = CaptureBuffer::makeMappedRing(size);
+		}
+
+		return capture ? capture : CaptureBuffer::makeRing(size);
+	}
+
+	if (toDisk) {
+		capture = CaptureBuffer::makeMapped(size, file);
+	}
+
+	return capture ? capture : CaptureBuffer::make(size);
+}
+
 void LogicAnalyzer::readPreferences()
 {
 	bool showFps = prefPanel->getShow_plot_fps();
 	m_tableInfo = prefPanel->getTableInfo();
+	m_captureToDisk = prefPanel->getLogicCaptureToDisk();
+	m_captureFile = prefPanel->getLogicCaptureFile();
+	m_continuousStream = prefPanel->getLogicContinuousStream();
 	m_separateAnnotations = prefPanel->getSeparateAnnotations();
 	m_plot.setVisibleFpsLabel(showFps);
 
@@ -2841,6 +2929,12 @@ void LogicAnalyzer::exportData()
 	bool done = false;
 	bool noChannelEnabled = true;
 
+	// A continuous capture would overwrite the samples being exported
+	const CaptureBuffer::sptr running = getCapture();
+	if (m_started && running && running->isRing()) {
+		ui->runSingleWidget->toggle(false);
+	}
+
 	m_exportConfig = m_exportSettings->getExportConfig();
 	auto keys = m_exportConfig.keys();
 	for (auto x : qAsConst(keys)) {
@@ -2863,7 +2957,7 @@ void LogicAnalyzer::exportData()
 	tr("Export"), "", filter.join(";;"),
 	    &selectedFilter, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
 
-	if (fileName.isEmpty()) {
+	if (fileName.isEmpty() || m_exportFuture.isRunning()) {
 		return;
 	}
 
@@ -2899,10 +2993,14 @@ void LogicAnalyzer::exportData()
 
 		QTextStream out(&file);
 
+		const CaptureBuffer::sptr capture = getCapture();
+		const uint64_t samples = capture ? capturedSamples(capture) -
+			std::min(capture->firstSample(), capturedSamples(capture)) : m_bufferSize;
+
 		/* Write the general information */
 		out << startRow << "date " << QDateTime::currentDateTime().toString() << endRow;
 		out << startRow << "version Scopy - " << QString(SCOPY_VERSION_GIT) << endRow;
-		out << startRow << "comment " << QString::number(m_bufferSize) <<
+		out << startRow << "comment " << QString::number(samples) <<
 		       " samples acquired at " << QString::number(m_sampleRate) <<
 		       " Hz " << endRow;
 
@@ -2915,59 +3013,81 @@ void LogicAnalyzer::exportData()
 
 bool LogicAnalyzer::exportTabCsv(const QString &separator, const QString &fileName)
 {
-	FileManager fm("Logic Analyzer");
-	fm.open(fileName, FileManager::EXPORT);
+	const CaptureBuffer::sptr capture = getCapture();
+
+	if (!capture) {
+		return false;
+	}
+
+	std::shared_ptr<FileManager> fm = std::make_shared<FileManager>("Logic Analyzer");
+	fm->open(fileName, FileManager::EXPORT);
+
+	// The channels are read from the capture while the file is written,
+	// the samples it holds never change. A continuous capture only holds
+	// its last samples, the export starts at the oldest one
+	const uint64_t last = capturedSamples(capture);
+	const uint64_t offset = std::min(capture->firstSample(), last);
 
-	QStringList chNames;
 	for (unsigned int ch = 0; ch < DIGITAL_NR_CHANNELS; ch++) {
 		if (m_exportConfig[ch]) {
-			chNames.push_back("Channel " + QString::number(ch));
+			fm->save([capture, ch, offset](size_t first, size_t count, double *dest) {
+				for (size_t i = 0; i < count; ++i) {
+					dest[i] = (capture->sample(offset + first + i) >> ch) & 1;
+				}
+			}, last - offset, "Channel " + QString::number(ch));
 		}
 	}
+
+	QStringList chNames;
 	for (unsigned int ch = DIGITAL_NR_CHANNELS; ch < m_plotCurves.size(); ch++){
 		auto *curve = dynamic_cast<AnnotationCurve *>(m_plotCurves[ch]);
-		auto rows = curve->getAnnotationRows();
+		const auto &rows = curve->getAnnotationRows();
 
 		for (const auto& [key, value] : rows) {
 			vector<Annotation> dest;
-			value.get_annotation_subset(dest, 0, m_lastCapturedSample);
+			value.get_annotation_subset(dest, offset, last);
 			if (!dest.empty()) {
 				chNames.push_back(key.title());
 			}
 		}
 	}
 
-	QVector<QVector<double>> data;
+	fm->setSampleRate(m_sampleRate);
 
-	if (!m_buffer) {
-		return false;
-	} else {
-		for (unsigned int i = 0; i < m_lastCapturedSample; ++i) {
-			uint64_t sample = m_buffer[i];
-			QVector<double> line;
-			for (unsigned int ch = 0; ch < DIGITAL_NR_CHANNELS; ++ch) {
-				int bit = (sample >> ch) & 1;
-				if(m_exportConfig[ch]) {
-					line.push_back(bit);
-				}
-			}
-			data.push_back(line);
-		}
-	}
+	fm->save(QVector<QVector<double>>(),
+		 createDecoderData(m_separateAnnotations, offset, last), chNames);
 
-	fm.setSampleRate(m_sampleRate);
+	fm->setProgressHandler([=](int percent) {
+		QMetaObject::invokeMethod(m_exportSettings, "setExportProgress",
+					  Qt::QueuedConnection, Q_ARG(int, percent));
+		return !m_exportCancelled;
+	});
 
-	fm.save(data, createDecoderData(m_separateAnnotations), chNames);
+	m_exportSettings->setExportProgress(0);
 
-	fm.performWrite();
+	QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+	connect(watcher, &QFutureWatcher<bool>::finished, this, [=](){
+		if (!watcher->result()) {
+			qDebug() << "Export to" << fileName << "failed";
+		}
+		m_exportSettings->setExportProgress(100);
+		watcher->deleteLater();
+	});
+
+	m_exportFuture = QtConcurrent::run([fm](){
+		return fm->performWrite();
+	});
+	watcher->setFuture(m_exportFuture);
 
 	return true;
 }
 
-QVector<QVector<QString>> LogicAnalyzer::createDecoderData(bool separate_annotations)
+QVector<QVector<QString>> LogicAnalyzer::createDecoderData(bool separate_annotations,
+							   uint64_t first_sample,
+							   uint64_t last_sample)
 {
 	QVector<QVector<QString>> decoder_data;
-	QVector<vector<Annotation>> rows;
+	QVector<const RowData *> rows;
 	QVector<QString> decoder_line;
 	QString new_value;
 	uint64_t start_sample = 0;
@@ -2981,45 +3101,53 @@ QVector<QVector<QString>> LogicAnalyzer::createDecoderData(bool separate_annotat
 
 	for (int ch=DIGITAL_NR_CHANNELS; ch < m_plotCurves.size(); ch++) {
 		AnnotationCurve *curve = dynamic_cast<AnnotationCurve *>(m_plotCurves[ch]);
-		std::map<Row, RowData> decoder(curve->getAnnotationRows());
-		std::map<Row, RowData>::iterator it;
+		const std::map<Row, RowData> &decoder = curve->getAnnotationRows();
 
-		for (it = decoder.begin(); it != decoder.end(); it++) {
-			vector<Annotation> row;
-			it->second.get_annotation_subset(row, 0, m_lastCapturedSample);
+		for (const auto &entry : decoder) {
+			const RowData &data = entry.second;
 
-			if (!row.empty()) {
-				rows.push_back(row);
+			if (data.first_ending_after(first_sample) < data.first_starting_after(last_sample)) {
+				rows.push_back(&data);
 			}
 		}
 	}
 
-	for (unsigned int i = 0; i < m_lastCapturedSample; ++i) {
+	for (uint64_t i = first_sample; i < last_sample; ++i) {
 		decoder_line.clear();
 
 		for (unsigned int row_index = 0; row_index < rows.size(); row_index++) {
+			const vector<Annotation> &row = rows[row_index]->get_annotations();
 			colum_is_visible = false;
 
-			for(unsigned int col=0; col < rows[row_index].size(); col++){
-				start_sample = rows[row_index][col].start_sample();
-				end_sample = rows[row_index][col].end_sample();
+			// Annotations are sorted by start sample: skip the ones
+			// that ended before this sample and stop at the first one
+			// that starts after it
+			const uint64_t first = (i == 0) ? 0 : rows[row_index]->first_ending_after(i - 1);
+
+			for (uint64_t col = first; col < row.size() && row[col].start_sample() <= i; col++) {
+				start_sample = row[col].start_sample();
+				end_sample = row[col].end_sample();
 				new_value = "";
 
+				if (!end_sample) {
+					continue;
+				}
+
 				if (separate_annotations) {
 					// overlapping annotations
-					if ((col + 1) < rows[row_index].size()) {
-						if(end_sample == rows[row_index][col + 1].start_sample()) {
+					if ((col + 1) < row.size()) {
+						if(end_sample == row[col + 1].start_sample()) {
 							end_sample --;
 						}
 					}
 
-					new_value = (start_sample == i && end_sample == i) ? start_separator + rows[row_index][col].annotations()[0] + end_separator
-							: (start_sample == i && end_sample > i) ? start_separator + rows[row_index][col].annotations()[0]
-							: (end_sample == i && start_sample < i) ? rows[row_index][col].annotations()[0] + end_separator
+					new_value = (start_sample == i && end_sample == i) ? start_separator + row[col].annotations()[0] + end_separator
+							: (start_sample == i && end_sample > i) ? start_separator + row[col].annotations()[0]
+							: (end_sample == i && start_sample < i) ? row[col].annotations()[0] + end_separator
 							: (start_sample < i && end_sample > i) ? repeated_value
 												   : "";
 				} else if ((start_sample <= i && end_sample > i) || (start_sample == i && end_sample == i)) {
-					new_value = rows[row_index][col].annotations()[0];
+					new_value = row[col].annotations()[0];
 				}
 				if (!new_value.isEmpty()) {
 					decoder_line.push_back(new_value);
@@ -3088,14 +3216,16 @@ bool LogicAnalyzer::exportVcd(const QString &fileName, const QString &startSep,
 	out << startSep << "enddefinitions" << endSep;
 
 	/* Write the values */
-	if (m_buffer) {
-		for (uint64_t i = 0; i < m_lastCapturedSample; i++) {
-			current_sample = m_buffer[i];
-			if (i == 0) {
-				prev_sample = current_sample;
-			} else {
-				prev_sample = m_buffer[i - 1];
-			}
+	const CaptureBuffer::sptr capture = getCapture();
+	if (capture) {
+		const uint64_t samples = capturedSamples(capture);
+		const uint64_t first = std::min(capture->firstSample(), samples);
+
+		// Timestamps stay those of the capture, a continuous one starts
+		// at its oldest sample still held
+		for (uint64_t i = first; i < samples; i++) {
+			prev_sample = i != first ? current_sample : capture->sample(first);
+			current_sample = capture->sample(i);
 			timestamp_written = false;
 			p = 0;
 			for (unsigned int ch = 0; ch < DIGITAL_NR_CHANNELS; ch++) {
@@ -3103,7 +3233,7 @@ bool LogicAnalyzer::exportVcd(const QString &fileName, const QString &startSep,
 				current_bit = (current_sample >> ch) & 1;
 				prev_bit = (prev_sample >> ch) & 1;
 
-				if ((current_bit == prev_bit) && (i != 0)) {
+				if ((current_bit == prev_bit) && (i != first)) {
 					p++;
 					continue;
 				}
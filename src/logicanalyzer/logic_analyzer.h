@@ -22,10 +22,12 @@
 #ifndef LOGIC_ANALYZER_H
 #define LOGIC_ANALYZER_H
 
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 
+#include <QFuture>
 #include <QList>
 #include <QQueue>
 #include <QScrollBar>
@@ -177,10 +179,22 @@ private:
 
 	void setupTriggerMenu();
 
-	QVector<QVector<QString>> createDecoderData(bool separate_annotations);
+	QVector<QVector<QString>> createDecoderData(bool separate_annotations,
+						    uint64_t first, uint64_t last);
 
 	void waitForDecoders();
 
+	// Samples of the given capture announced to the readers
+	uint64_t capturedSamples(const CaptureBuffer::sptr &capture) const;
+
+	// Capture buffer in RAM or, if enabled in the preferences, mapped
+	// from a file; falls back to RAM if the file can't be used. A
+	// continuous capture keeps its last 'size' samples in a ring, mapped
+	// from a temporary file rather than the chosen one
+	CaptureBuffer::sptr makeCaptureBuffer(uint64_t size, bool toDisk,
+					      const QString &file,
+					      bool continuous) const;
+
 private:
 	// TODO: consisten naming (m_ui, m_crUi)
 	Ui::LogicAnalyzer *ui;
@@ -191,7 +205,7 @@ private:
 	QQueue<QPair<CustomPushButton *, bool>> m_menuButtonActions;
 
 	CapturePlot m_plot;
-	BufferPreviewer *m_bufferPreviewer;
+	DigitalBufferPreviewer *m_bufferPreviewer;
 	QScrollBar *m_plotScrollBar;
 
 	ScaleSpinButton *m_sampleRateButton;
@@ -199,7 +213,7 @@ private:
 	PositionSpinButton *m_timePositionButton;
 	double m_sampleRate;
 	uint64_t m_bufferSize;
-	uint64_t m_lastCapturedSample;
+	std::atomic<uint64_t> m_lastCapturedSample;
 
 	M2k* m_m2k_context;
 	M2kDigital *m_m2kDigital;
@@ -212,6 +226,9 @@ private:
 	bool m_resetHorizAxisOffset;
 	bool m_separateAnnotations;
 	bool m_tableInfo;
+	bool m_captureToDisk;
+	QString m_captureFile;
+	bool m_continuousStream;
 
 	// capture
 	std::thread *m_captureThread;
@@ -240,6 +257,10 @@ private:
 	ExportSettings *m_exportSettings;
 	QMap<int, bool> m_exportConfig;
 
+	/* CSV/TXT export running on a worker thread */
+	QFuture<bool> m_exportFuture;
+	std::atomic<bool> m_exportCancelled{false};
+
 	/* mixed signal view */
 	std::unique_ptr<SaveRestoreToolSettings> m_saveRestoreSettings;
 	CapturePlot *m_oscPlot;
@@ -245,6 +245,36 @@ void LogicAnalyzer_API::setDecoderStack(const QList<QStringList> &decoderStack)
 	}
 }
 
+QList<double> LogicAnalyzer_API::getDecoderSamplesPerSecond() const
+{
+	QList<double> rates;
+	for (int i = 16; i < m_logic->m_plotCurves.size(); ++i) {
+		auto annCurve = dynamic_cast<adiscope::AnnotationCurve *>(m_logic->m_plotCurves[i]);
+		if (!annCurve) {
+			continue;
+		}
+
+		rates.push_back(annCurve->getAnnotationDecoder()->getSamplesPerSecond());
+	}
+
+	return rates;
+}
+
+QList<double> LogicAnalyzer_API::getDecoderAnnotationsPerSecond() const
+{
+	QList<double> rates;
+	for (int i = 16; i < m_logic->m_plotCurves.size(); ++i) {
+		auto annCurve = dynamic_cast<adiscope::AnnotationCurve *>(m_logic->m_plotCurves[i]);
+		if (!annCurve) {
+			continue;
+		}
+
+		rates.push_back(annCurve->getAnnotationDecoder()->getAnnotationsPerSecond());
+	}
+
+	return rates;
+}
+
 QList<QStringList> LogicAnalyzer_API::getDecoderSettings() const
 {
 	QList<QStringList> decoderSettings;
@@ -53,6 +53,8 @@ class LogicAnalyzer_API : public ApiObject
 								WRITE setAssignedDecoderChannels)
 	Q_PROPERTY(QList<QStringList> decoderStack READ getDecoderStack WRITE setDecoderStack)
 	Q_PROPERTY(QList<QStringList> decoderSettings READ getDecoderSettings WRITE setDecoderSettings)
+	Q_PROPERTY(QList<double> decoderSamplesPerSecond READ getDecoderSamplesPerSecond STORED false)
+	Q_PROPERTY(QList<double> decoderAnnotationsPerSecond READ getDecoderAnnotationsPerSecond STORED false)
 
 	/* common decoders + channels */
 	Q_PROPERTY(QStringList channelNames READ getChannelNames WRITE setChannelNames)
@@ -123,6 +125,9 @@ public:
 	QList<QStringList> getDecoderSettings() const;
 	void setDecoderSettings(const QList<QStringList> &decoderSettings);
 
+	QList<double> getDecoderSamplesPerSecond() const;
+	QList<double> getDecoderAnnotationsPerSecond() const;
+
 	QVector<QVector<int>> getCurrentGroups() const;
 	void setCurrentGroups(const QVector<QVector<int> > &groups);
 
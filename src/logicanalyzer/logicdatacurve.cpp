@@ -32,6 +32,8 @@
 
 #include <QPainter>
 
+using adiscope::logic::LogicEdges;
+
 static const QColor EdgeColor(0x80, 0x80, 0x80);
 static const QColor HighColor(0x00, 0xC0, 0x00);
 static const QColor LowColor(0xC0, 0x00, 0x00);
@@ -64,35 +66,47 @@ void LogicDataCurve::dataAvailable(uint64_t from, uint64_t to)
 	    reset();
     }
 
-    m_data = m_logic->getData();
+    m_capture = m_logic->getCapture();
 
-    // Take into account the last pushed edge from the previous chunk of
-    // available data
-    uint64_t currentSample = from;
-    if (from > 0) {
-	    currentSample--;
+    if (!m_capture) {
+	    return;
     }
 
-    if (from == to) {
+    // The announcement may be about the capture before this one
+    to = std::min(to, m_capture->written());
+
+    if (from >= to) {
 	    return;
     }
 
-    for (; currentSample < to - 1; ++currentSample) {
-        bool transition = (m_data[currentSample] & (1 << m_bit)) ^ (m_data[currentSample + 1] & (1 << m_bit));
-        bool high = (m_data[currentSample] & (1 << m_bit)) > (m_data[currentSample + 1] & (1 << m_bit));
-        if (transition) {
-            m_edges.emplace_back(currentSample, high);
-        }
-    }
+    // The edges of all the channels are extracted together by whichever
+    // curve gets here first; the others find them already there
+    m_capture->edges().extend(*m_capture, to);
 
+    setLastSample(to);
+    m_startSample = getFirstSample();
     m_endSample = to;
 }
 
+LogicEdges::Channel LogicDataCurve::visibleEdges() const
+{
+	// Must be called with the edges mutex held
+	if (!m_capture || m_endSample < 2) {
+		return LogicEdges::Channel();
+	}
+
+	const LogicEdges::Channel all = m_capture->edges().channel(m_bit);
+
+	// Ignore the edges found past the data announced to this curve, and
+	// the ones a continuous capture left behind the time axis
+	return all.range(all.lowerBound(m_startSample), all.lowerBound(m_endSample - 1));
+}
+
 void LogicDataCurve::reset()
 {
-	m_edges.clear();
 	m_startSample = 0;
 	m_endSample = 0;
+	m_capture.reset();
 }
 
 uint8_t LogicDataCurve::getBitId() const
@@ -119,9 +133,16 @@ void LogicDataCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap,
 
 	const double heightInPoints = yMap.invTransform(0) - yMap.invTransform(m_traceHeight);
 
-    if (!m_edges.size()) {
+    std::unique_lock<std::mutex> edgesLock;
+    if (m_capture) {
+	    edgesLock = std::unique_lock<std::mutex>(m_capture->edges().mutex());
+    }
+
+    const LogicEdges::Channel channelEdges = visibleEdges();
+
+    if (!channelEdges.size()) {
 	    if (m_startSample != m_endSample) {
-		const bool logicLevel = (m_logic->getData()[m_startSample] & (1 << m_bit)) >> m_bit;
+		const bool logicLevel = (m_capture->sample(m_startSample) & (1 << m_bit)) >> m_bit;
 		displayedData += QPointF(fromSampleToTime(m_startSample), logicLevel * heightInPoints + m_pixelOffset);
 		displayedData += QPointF(fromSampleToTime(m_endSample), logicLevel * heightInPoints + m_pixelOffset);
 
@@ -141,15 +162,15 @@ void LogicDataCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap,
     }
 
     std::vector<std::pair<uint64_t, bool>> edges;
-    getSubsampledEdges(edges, xMap);
+    getSubsampledEdges(edges, xMap, channelEdges);
 
 
     if (!edges.size()) {
         return;
     }
 
-    if (edges.front().first > 0) {
-	displayedData += QPointF(fromSampleToTime(0), edges.front().second * heightInPoints + m_pixelOffset);
+    if (edges.front().first > m_startSample) {
+	displayedData += QPointF(fromSampleToTime(m_startSample), edges.front().second * heightInPoints + m_pixelOffset);
     }
 
     for (const auto & edge : edges) {
@@ -182,7 +203,7 @@ void LogicDataCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap,
     // Draw sampling points
     // Optimize for each segment we can draw the points connecting it
     // knowing from segment.second if it is "1" or "0"
-    double dist = xMap.transform(fromSampleToTime(1)) - xMap.transform(fromSampleToTime(0));
+    double dist = xMap.transform(fromSampleToTime(m_startSample + 1)) - xMap.transform(fromSampleToTime(m_startSample));
 
 
     if (dist <= 4.0 || !m_displaySampling) {
@@ -191,15 +212,15 @@ void LogicDataCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap,
 
     QwtInterval interval = plot()->axisInterval(QwtAxis::XBottom);
 
-    int start = fromTimeToSample(interval.minValue());
-    int end = fromTimeToSample(interval.maxValue());
+    uint64_t start = fromTimeToSample(interval.minValue());
+    uint64_t end = fromTimeToSample(interval.maxValue());
 
-    start = start < 0 ? 0 : start;
-    end = end > (m_endSample - 1) ? (m_endSample - 1) : end;
+    start = std::max(start, m_startSample);
+    end = std::min(end, m_endSample - 1);
 
     QVector<QPointF> points;
     for (; start <= end; ++start) {
-	double y = ((m_logic->getData()[start] & (1 << m_bit)) >> m_bit) * heightInPoints + m_pixelOffset;
+	double y = ((m_capture->sample(start) & (1 << m_bit)) >> m_bit) * heightInPoints + m_pixelOffset;
 	points += QPointF(fromSampleToTime(start), y);
     }
 
@@ -219,82 +240,90 @@ void LogicDataCurve::drawLines(QPainter *painter, const QwtScaleMap &xMap,
 
 }
 
-void LogicDataCurve::getSubsampledEdges(std::vector<std::pair<uint64_t, bool>> &edges, const QwtScaleMap &xMap) const {
+void LogicDataCurve::getSubsampledEdges(std::vector<std::pair<uint64_t, bool>> &edges, const QwtScaleMap &xMap,
+					const LogicEdges::Channel &channelEdges) const {
 
 
 
-	double dist = xMap.transform(fromSampleToTime(1)) - xMap.transform(fromSampleToTime(0));
+	double dist = xMap.transform(fromSampleToTime(m_startSample + 1)) - xMap.transform(fromSampleToTime(m_startSample));
 
 	QwtInterval interval = plot()->axisInterval(QwtAxis::XBottom);
-	uint64_t firstEdge = edgeAtX(fromTimeToSample(interval.minValue()), m_edges);
-	uint64_t lastEdge = edgeAtX(fromTimeToSample(interval.maxValue()), m_edges);
+	uint64_t firstEdge = edgeAtX(fromTimeToSample(interval.minValue()), channelEdges);
+	uint64_t lastEdge = edgeAtX(fromTimeToSample(interval.maxValue()), channelEdges);
 
 	if (firstEdge > 0) {
 		firstEdge--;
 	}
 
-	if (lastEdge < m_edges.size() - 1) {
+	if (lastEdge < channelEdges.size() - 1) {
 		lastEdge++;
 	}
 
-	if (m_edges.size() == 1) { // corner case
-		edges.emplace_back(m_edges.front());
+	if (channelEdges.size() == 1) { // corner case
+		edges.emplace_back(channelEdges[0]);
 		return;
 	}
 
 	// If plot is zoomed in / not so many edges close together
 	// draw them all
 	if (dist > 0.10) {
-		if (lastEdge == m_edges.size() - 1) {
-			lastEdge = m_edges.size();
+		if (lastEdge == channelEdges.size() - 1) {
+			lastEdge = channelEdges.size();
 		}
 
 		for (; firstEdge < lastEdge; ++firstEdge) {
-			edges.emplace_back(m_edges[firstEdge]);
+			edges.emplace_back(channelEdges[firstEdge]);
 		}
 	} else {
+		// Too many edges to look at one by one: walk the pixel columns
+		// and ask the transition index whether the channel toggles
+		// within each of them. A busy column is drawn as a full swing,
+		// the level in between is read from the samples at its ends.
+		const LogicEdges &index = m_capture->edges();
+		const uint16_t bitMask = 1 << m_bit;
+		const uint64_t lastSample = m_endSample - 1;
+
+		const int firstColumn = static_cast<int>(std::min(xMap.p1(), xMap.p2()));
+		const int lastColumn = static_cast<int>(std::max(xMap.p1(), xMap.p2()));
+
+		uint64_t s0 = std::min<uint64_t>(fromTimeToSample(xMap.invTransform(firstColumn)), lastSample);
+
+		// Keep the edge right before the view, the line starts from it
+		const size_t before = channelEdges.lowerBound(s0);
+		if (before > 0) {
+			edges.emplace_back(channelEdges[before - 1]);
+		}
 
-		const uint64_t pointsPerPixel = 1.0 / dist;
-
-		// always add the first edge
-		edges.emplace_back(m_edges[firstEdge]);
-
-		for (; firstEdge < lastEdge; ) {
-			// Find the next edge that is at least "pointsPerPixel" away
-			// from the current one
-			auto next = std::upper_bound(m_edges.begin(), m_edges.end(),
-				std::make_pair(edges.back().first + pointsPerPixel - 1, false),
-				[=](const std::pair<uint64_t, bool> &lhs, const std::pair<uint64_t, bool> &rhs) -> bool {
-			return lhs.first < rhs.first;
-			});
+		for (int column = firstColumn; column <= lastColumn && s0 < lastSample; column++) {
+			const uint64_t s1 = std::min<uint64_t>(fromTimeToSample(xMap.invTransform(column + 1)),
+							       lastSample);
 
-			bool didReachEnd = false;
-			if (next == m_edges.end()) {
-				next = m_edges.end() - 1;
-				didReachEnd = true;
+			if (s1 <= s0) {
+				continue;
 			}
 
-			if (next->second == edges.back().second) {
-				std::advance(next, -1);
-				if (didReachEnd) {
-					// If the end is reached (next == last edge) and it has the same transition as the last
-					// edge in the "edges" vector we have to add "next - 1" and "next" to the "edges" array
-					// in order to have valid transition, and also plot the last edge.
-					edges.emplace_back(*next);
-					std::advance(next, 1);
-					edges.emplace_back(*next);
-					break;
+			if (index.transitions(s0, s1, *m_capture) & bitMask) {
+				const bool levelBefore = m_capture->sample(s0) & bitMask;
+				const bool levelAfter = m_capture->sample(s1) & bitMask;
+
+				edges.emplace_back(s0, levelBefore);
+				if (levelAfter == levelBefore && s1 - s0 > 1) {
+					edges.emplace_back(s1 - 1, !levelBefore);
 				}
 			}
 
-			edges.emplace_back(*next);
+			s0 = s1;
+		}
 
-			firstEdge = std::distance(m_edges.begin(), next);
+		// And the one right after it, the line goes on to it
+		const size_t after = channelEdges.lowerBound(s0);
+		if (after < channelEdges.size()) {
+			edges.emplace_back(channelEdges[after]);
 		}
 	}
 }
 
-uint64_t LogicDataCurve::edgeAtX(int x, const std::vector<std::pair<uint64_t, bool>> &edges) const {
+uint64_t LogicDataCurve::edgeAtX(uint64_t x, const LogicEdges::Channel &edges) const {
     // returns position of edge close to x value
     // O(log N)
 
@@ -306,13 +335,9 @@ uint64_t LogicDataCurve::edgeAtX(int x, const std::vector<std::pair<uint64_t, bo
     while (end >= start) {
         mid = start + (end - start) / 2;
 
-	if (mid >= m_edges.size()) {
-//		qDebug() << "mid: " << mid << " m_edges.size():" << m_edges.size();
-	}
-
-        if (edges[mid].first < x) {
+        if (edges.position(mid) < x) {
             start = mid + 1;
-        } else if (edges[mid].first > x) {
+        } else if (edges.position(mid) > x) {
             end = mid - 1;
         } else {
             return mid;
@@ -47,25 +47,24 @@ protected:
         const QRectF &canvasRect, int from, int to ) const;
 
 private:
-    void getSubsampledEdges(std::vector<std::pair<uint64_t, bool> > &edges, const QwtScaleMap &xMap) const;
-    uint64_t edgeAtX(int x, const std::vector<std::pair<uint64_t, bool> > &edges) const;
+    adiscope::logic::LogicEdges::Channel visibleEdges() const;
+    void getSubsampledEdges(std::vector<std::pair<uint64_t, bool> > &edges, const QwtScaleMap &xMap,
+                            const adiscope::logic::LogicEdges::Channel &channelEdges) const;
+    uint64_t edgeAtX(uint64_t x, const adiscope::logic::LogicEdges::Channel &edges) const;
 
 
 private:
 
 	adiscope::logic::LogicTool *m_logic;
 
-    // pointer to data which this curve listens to
-    uint16_t *m_data;
+    // capture which this curve listens to
+    adiscope::logic::CaptureBuffer::sptr m_capture;
     // bit to watch in each sample from m_data
     uint8_t m_bit;
 
     uint64_t m_startSample;
     uint64_t m_endSample;
 
-    // false -> ,,|'' true -> ''|,,
-    std::vector<std::pair<uint64_t, bool>> m_edges;
-
     bool m_displaySampling;
 
     mutable std::mutex m_dataAvailableMutex;
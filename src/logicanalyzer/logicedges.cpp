@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logicedges.h"
+#include "capturebuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace adiscope::logic;
+using adiscope::TransitionIndex;
+
+/* Samples checked at once when looking for a transition */
+#define EDGE_SCAN_BLOCK 32
+
+constexpr int LogicEdges::NR_CHANNELS;
+
+LogicEdges::Channel::Channel()
+	: m_positions(nullptr)
+	, m_count(0)
+	, m_initialLevel(false)
+	, m_base(0)
+{
+}
+
+LogicEdges::Channel::Channel(const uint32_t *positions, size_t count, bool initialLevel,
+			     uint64_t base)
+	: m_positions(positions)
+	, m_count(count)
+	, m_initialLevel(initialLevel)
+	, m_base(base)
+{
+}
+
+size_t LogicEdges::Channel::lowerBound(uint64_t sample) const
+{
+	if (sample <= m_base) {
+		return 0;
+	}
+
+	return std::lower_bound(m_positions, m_positions + m_count, sample - m_base) - m_positions;
+}
+
+LogicEdges::Channel LogicEdges::Channel::range(size_t first, size_t last) const
+{
+	return Channel(m_positions + first, last - first, levelBefore(first), m_base);
+}
+
+LogicEdges::LogicEdges()
+	: m_initialLevels(0)
+	, m_base(0)
+	, m_scanned(0)
+{
+}
+
+std::mutex &LogicEdges::mutex() const
+{
+	return m_mutex;
+}
+
+LogicEdges::Channel LogicEdges::channel(int ch) const
+{
+	return Channel(m_positions[ch].data(), m_positions[ch].size(),
+		       (m_initialLevels >> ch) & 1, m_base);
+}
+
+static inline uint64_t load4(const uint16_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+void LogicEdges::restart(const CaptureBuffer &buffer, uint64_t sample)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (auto &positions : m_positions) {
+		positions.clear();
+	}
+	m_transitions.clear();
+
+	m_initialLevels = buffer.sample(sample);
+	m_base = sample;
+	m_scanned = sample + 1;
+}
+
+void LogicEdges::dropFront(uint64_t sample)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const uint64_t delta = sample - m_base;
+
+	for (int ch = 0; ch < NR_CHANNELS; ch++) {
+		std::vector<uint32_t> &positions = m_positions[ch];
+		const size_t dropped = std::lower_bound(positions.begin(), positions.end(), delta)
+				- positions.begin();
+
+		positions.erase(positions.begin(), positions.begin() + dropped);
+		for (uint32_t &position : positions) {
+			position -= delta;
+		}
+
+		// The level before the first edge that is left
+		if (dropped & 1) {
+			m_initialLevels ^= 1 << ch;
+		}
+	}
+
+	m_transitions.dropFront(delta);
+	m_base = sample;
+}
+
+void LogicEdges::extend(const CaptureBuffer &buffer, uint64_t to)
+{
+	std::lock_guard<std::mutex> extendLock(m_extendMutex);
+
+	// The first sample is segment aligned, so it is a valid base for the
+	// transition index as well. Dropping the edges in front of it only
+	// once they are as many samples as the ones after it takes amortized
+	// constant time per edge.
+	const uint64_t first = buffer.firstSample();
+
+	if (m_scanned <= first) {
+		// Nothing scanned yet, or a ring dropped the samples right
+		// after the scanned ones
+		if (to <= first) {
+			return;
+		}
+		restart(buffer, first);
+	} else if (first - m_base >= m_scanned - first) {
+		dropFront(first);
+	}
+
+	// Positions are stored in 32 bits from the base; a ring keeps them
+	// within that by dropping the old ones
+	to = std::min<uint64_t>(to, m_base + std::numeric_limits<uint32_t>::max());
+
+	if (to <= m_scanned) {
+		return;
+	}
+
+	// Collect the new edges without blocking the readers, they are
+	// published all at once at the end
+	std::vector<uint32_t> found[NR_CHANNELS];
+
+	// Toggled channels of each index bucket, starting with the one that
+	// holds the first new edge position
+	const uint64_t firstBucket = (m_scanned - 1 - m_base) / TransitionIndex::BASE_SIZE;
+	std::vector<uint16_t> toggled((to - 2 - m_base) / TransitionIndex::BASE_SIZE - firstBucket + 1, 0);
+
+	auto addEdges = [&](uint64_t position, unsigned int diff) {
+		position -= m_base;
+		toggled[position / TransitionIndex::BASE_SIZE - firstBucket] |= diff;
+
+		while (diff) {
+			const int ch = __builtin_ctz(diff);
+
+			found[ch].push_back(static_cast<uint32_t>(position));
+			diff &= diff - 1;
+		}
+	};
+
+	uint64_t i = m_scanned;
+	uint16_t prev = buffer.sample(i - 1);
+
+	// Walk the buffer one contiguous segment at a time; the pair of
+	// samples that straddles two segments is compared on its own
+	while (i < to) {
+		uint64_t length;
+		const uint16_t *run = buffer.segment(i, length);
+
+		length = std::min(length, to - i);
+		addEdges(i - 1, prev ^ run[0]);
+
+		uint64_t k = 1;
+
+		while (k < length) {
+			// XOR each sample with the previous one, 4 samples per
+			// 64 bit word; a block without any transition is
+			// skipped as a whole
+			if (k + EDGE_SCAN_BLOCK <= length) {
+				uint64_t diff = 0;
+
+				for (int j = 0; j < EDGE_SCAN_BLOCK; j += 4) {
+					diff |= load4(run + k + j - 1) ^ load4(run + k + j);
+				}
+
+				if (!diff) {
+					k += EDGE_SCAN_BLOCK;
+					continue;
+				}
+			}
+
+			const uint64_t end = std::min<uint64_t>(k + EDGE_SCAN_BLOCK, length);
+
+			for (; k < end; k++) {
+				addEdges(i + k - 1, run[k - 1] ^ run[k]);
+			}
+		}
+
+		prev = run[length - 1];
+		i += length;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (int ch = 0; ch < NR_CHANNELS; ch++) {
+		m_positions[ch].insert(m_positions[ch].end(), found[ch].begin(), found[ch].end());
+	}
+
+	for (size_t b = 0; b < toggled.size(); b++) {
+		m_transitions.baseBucket((firstBucket + b) * TransitionIndex::BASE_SIZE).mask |= toggled[b];
+	}
+	m_transitions.commit(firstBucket * TransitionIndex::BASE_SIZE);
+
+	m_scanned = to;
+}
+
+uint16_t LogicEdges::transitions(uint64_t first, uint64_t last, const CaptureBuffer &buffer) const
+{
+	// Edge positions go from the first sample still held up to the last
+	// pair of scanned samples
+	if (!m_scanned) {
+		return 0;
+	}
+	first = std::max(first, std::max(m_base, buffer.firstSample()));
+	last = std::min(last, m_scanned - 1);
+
+	if (first >= last) {
+		return 0;
+	}
+
+	size_t headEnd, tailStart;
+	uint16_t mask = m_transitions.query(first - m_base, last - m_base, headEnd, tailStart).mask;
+
+	headEnd += m_base;
+	tailStart += m_base;
+
+	for (uint64_t p = first; p < headEnd; p++) {
+		mask |= buffer.sample(p) ^ buffer.sample(p + 1);
+	}
+	for (uint64_t p = std::max<uint64_t>(tailStart, headEnd); p < last; p++) {
+		mask |= buffer.sample(p) ^ buffer.sample(p + 1);
+	}
+
+	return mask;
+}
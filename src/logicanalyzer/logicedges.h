@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOGICEDGES_H
+#define LOGICEDGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "lod_index.h"
+
+namespace adiscope {
+namespace logic {
+
+class CaptureBuffer;
+
+/*
+ * Transitions of all 16 channels of a logic capture, extracted in a single
+ * pass over the samples.
+ *
+ * An edge at position p means that sample p and sample p + 1 differ on that
+ * channel. Edges of a channel always alternate, so only their positions are
+ * stored (4 bytes each, relative to a base sample); whether an edge is
+ * rising or falling follows from the initial level of the channel and the
+ * parity of the edge index.
+ *
+ * On a ring buffer, the edges of the samples it no longer holds are dropped
+ * once they make up half of the stored ones, and the base moves up. The
+ * stored range is at most twice the history of the ring, which keeps the
+ * positions within 32 bits however long the stream runs.
+ *
+ * Alongside the edges, a level of detail index tells which channels toggle
+ * within any range of samples, for views that are too zoomed out to look
+ * at the edges one by one.
+ */
+class LogicEdges
+{
+public:
+	static constexpr int NR_CHANNELS = 16;
+
+	/* Read-only view over the edges of one channel */
+	class Channel
+	{
+	public:
+		Channel();
+		Channel(const uint32_t *positions, size_t count, bool initialLevel,
+			uint64_t base = 0);
+
+		size_t size() const { return m_count; }
+		uint64_t position(size_t idx) const { return m_base + m_positions[idx]; }
+
+		/* Level right before the edge; true for a falling edge */
+		bool levelBefore(size_t idx) const { return m_initialLevel ^ (idx & 1); }
+
+		std::pair<uint64_t, bool> operator[](size_t idx) const
+		{
+			return std::make_pair(position(idx), levelBefore(idx));
+		}
+
+		/* Index of the first edge at or after the given sample */
+		size_t lowerBound(uint64_t sample) const;
+
+		/* View over the edges [first, last) of this one */
+		Channel range(size_t first, size_t last) const;
+
+	private:
+		const uint32_t *m_positions;
+		size_t m_count;
+		bool m_initialLevel;
+		uint64_t m_base;
+	};
+
+	LogicEdges();
+
+	/* Scans the samples up to (not including) 'to' that were not scanned
+	 * yet, starting at the first one the buffer holds */
+	void extend(const CaptureBuffer &buffer, uint64_t to);
+
+	/* Views are only valid while the mutex is held */
+	std::mutex &mutex() const;
+	Channel channel(int ch) const;
+
+	/* Channels with at least one edge at a position in [first, last) */
+	uint16_t transitions(uint64_t first, uint64_t last, const CaptureBuffer &buffer) const;
+
+private:
+	/* Starts over at the given sample, dropping all the edges */
+	void restart(const CaptureBuffer &buffer, uint64_t sample);
+
+	/* Drops the edges before the given sample, which becomes the base */
+	void dropFront(uint64_t sample);
+
+	mutable std::mutex m_mutex;
+	std::mutex m_extendMutex;
+
+	std::vector<uint32_t> m_positions[NR_CHANNELS];
+	adiscope::TransitionIndex m_transitions;
+	uint16_t m_initialLevels;
+	uint64_t m_base;
+	uint64_t m_scanned;
+};
+} // namespace logic
+} // namespace adiscope
+
+#endif // LOGICEDGES_H
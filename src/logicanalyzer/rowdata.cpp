@@ -39,27 +39,32 @@
 
 #include "rowdata.h"
 
-#include <QDebug>
+#include <algorithm>
+
+RowData::RowData() :
+    strings_(std::make_shared<AnnotationStrings>())
+{
+}
 
 uint64_t RowData::get_max_sample() const
 {
-    if (annotations_.empty())
+    if (max_end_.empty())
         return 0;
-    return annotations_.back().end_sample();
-//    return 0;
+    return max_end_.back();
 }
 
 void RowData::get_annotation_subset(
     vector<Annotation> &dest,
     uint64_t start_sample, uint64_t end_sample) const
 {
-    for (const auto& annotation : annotations_)
-        if (annotation.end_sample() > start_sample &&
-            annotation.start_sample() <= end_sample)
-            dest.push_back(annotation);
+    const uint64_t last = first_starting_after(end_sample);
+
+    for (uint64_t i = first_ending_after(start_sample); i < last; ++i)
+        if (annotations_[i].end_sample() > start_sample)
+            dest.push_back(annotations_[i]);
 }
 
-vector<Annotation> RowData::get_annotations() const {
+const vector<Annotation> &RowData::get_annotations() const {
 	return annotations_;
 }
 
@@ -80,43 +85,89 @@ void RowData::sort_annotations() {
     std::stable_sort(annotations_.begin(), annotations_.end(), [](const Annotation &a, const Annotation &b){
         return a.start_sample() < b.start_sample();
     });
+
+    max_end_.resize(annotations_.size());
+    uint64_t max_end = 0;
+    for (size_t i = 0; i < annotations_.size(); ++i) {
+        max_end = std::max(max_end, annotations_[i].end_sample());
+        max_end_[i] = max_end;
+    }
 }
 
-std::pair<uint64_t, uint64_t> RowData::get_annotation_subset(uint64_t start_sample, uint64_t end_sample) const
+uint64_t RowData::first_ending_after(uint64_t sample) const
 {
+    return std::upper_bound(max_end_.begin(), max_end_.end(), sample) - max_end_.begin();
+}
 
-//    qDebug() << start_sample << " " << end_sample;
+uint64_t RowData::first_starting_after(uint64_t sample) const
+{
+    return std::upper_bound(annotations_.begin(), annotations_.end(), sample,
+                            [](uint64_t s, const Annotation &a) {
+        return s < a.start_sample();
+    }) - annotations_.begin();
+}
 
-    uint64_t first = 0, last = 0;
+std::pair<uint64_t, uint64_t> RowData::get_annotation_subset(uint64_t start_sample, uint64_t end_sample) const
+{
+    if (annotations_.empty())
+        return std::make_pair(0, 0);
 
-    bool found = false;
-    for (size_t i = 0; i < annotations_.size(); ++i) {
-        if (annotations_[i].end_sample() > start_sample &&
-            annotations_[i].start_sample() <= end_sample) {
-            if (!found) {
-                first = i;
-                found = true;
-            } else {
-                last = i;
-            }
-        }
-    }
+    uint64_t first = first_ending_after(start_sample);
+    uint64_t last = first_starting_after(end_sample);
 
-    if (!last && first > 0) {
-	    last = (first < annotations_.size() - 1) ? first + 1
-			    : first;
-    }
+    // Nothing in range: fall back to the annotations around it
+    if (last <= first)
+        last = first + 1;
 
     // let s adjust the edges a bit
     if (first > 0) first--;
-    if (last < annotations_.size() - 1) last++;
+    if (last < annotations_.size()) last++;
+
+    first = std::min<uint64_t>(first, annotations_.size() - 1);
 
-    return std::make_pair(first, last);
+    return std::make_pair(first, std::min<uint64_t>(last, annotations_.size()) - 1);
 }
 
-void RowData::emplace_annotation(srd_proto_data *pdata, const Row *row)
+void RowData::emplace_annotation(srd_proto_data *pdata, const Row *row,
+                                 uint64_t sample_offset)
 {
-    annotations_.emplace_back(pdata, row);
+    Annotation annotation(pdata, row, *strings_, sample_offset);
+
+    if (annotations_.empty() ||
+            annotations_.back().start_sample() <= annotation.start_sample()) {
+        const uint64_t max_end = max_end_.empty() ? annotation.end_sample()
+                : std::max(max_end_.back(), annotation.end_sample());
+
+        annotations_.push_back(annotation);
+        max_end_.push_back(max_end);
+        return;
+    }
+
+    // Out of order: insert after the annotations starting at the same
+    // sample, like a stable sort would, and fix the end index from there
+    const uint64_t pos = first_starting_after(annotation.start_sample());
+    annotations_.insert(annotations_.begin() + pos, annotation);
+    max_end_.insert(max_end_.begin() + pos, 0);
+
+    uint64_t max_end = pos ? max_end_[pos - 1] : 0;
+    for (size_t i = pos; i < annotations_.size(); ++i) {
+        max_end = std::max(max_end, annotations_[i].end_sample());
+        max_end_[i] = max_end;
+    }
 }
 
+bool RowData::drop_annotations_before(uint64_t sample)
+{
+    const uint64_t count = first_ending_after(sample);
 
+    if (!count || count < annotations_.size() - count)
+        return false;
+
+    // The largest end of the annotations left is past the sample, so it
+    // is theirs alone and max_end_ stays as it is
+    annotations_.erase(annotations_.begin(), annotations_.begin() + count);
+    max_end_.erase(max_end_.begin(), max_end_.begin() + count);
+    strings_->prune();
+
+    return true;
+}
@@ -45,15 +45,30 @@
 
 #include "annotation.h"
 
+#include <memory>
 #include <vector>
-#include <set>
 
 class Row;
 
+/*
+ * Annotations of one row, kept sorted by start sample. Decoders emit the
+ * annotations of a row in order, so they are appended at the end and keep
+ * their index; the odd one that comes out of order is inserted in place.
+ *
+ * Next to every annotation is the largest end sample of all the annotations
+ * up to it. Both that and the start samples never decrease, which lets a
+ * range query find its annotations with two binary searches even when the
+ * annotations overlap.
+ *
+ * Copies share the pool of annotation texts.
+ *
+ * A continuous capture drops the annotations that fell behind its buffer,
+ * a big block at a time so that each annotation is moved only a few times.
+ */
 class RowData
 {
 public:
-    RowData() = default;
+    RowData();
 
 public:
     uint64_t get_max_sample() const;
@@ -63,34 +78,57 @@ public:
     }
 
     /**
-     * Extracts annotations between the given sample range into a vector.
-     * Note: The annotations are unsorted and only annotations that fully
-     * fit into the sample range are considered.
+     * Extracts annotations between the given sample range into a vector,
+     * sorted by start sample.
      */
     void get_annotation_subset(
         vector<Annotation> &dest,
         uint64_t start_sample, uint64_t end_sample) const;
 
-    vector<Annotation> get_annotations() const;
+    const vector<Annotation> &get_annotations() const;
 
-    void emplace_annotation(srd_proto_data *pdata, const Row *row);
+    /**
+     * Adds an annotation of a decoder session that started at the given
+     * sample of the capture.
+     */
+    void emplace_annotation(srd_proto_data *pdata, const Row *row,
+                            uint64_t sample_offset = 0);
+
+    /**
+     * Drops the annotations that end at or before the given sample, once
+     * they are at least half of the row. Returns whether it dropped any;
+     * the indices of the remaining annotations then change.
+     */
+    bool drop_annotations_before(uint64_t sample);
 
+    /**
+     * Index range (inclusive, widened by one annotation at each end) of
+     * the annotations that end after start_sample and start at or before
+     * end_sample.
+     */
     std::pair<uint64_t, uint64_t> get_annotation_subset(uint64_t start_sample,
                                                         uint64_t end_sample) const;
 
+    /**
+     * Index of the first annotation that may end after the given sample;
+     * all the annotations before it end at or before it.
+     */
+    uint64_t first_ending_after(uint64_t sample) const;
+
+    /**
+     * Index of the first annotation that starts after the given sample.
+     */
+    uint64_t first_starting_after(uint64_t sample) const;
+
     Annotation getAnnAt(uint64_t index) const;
     const Annotation* annAt(uint64_t index) const;
 
     void sort_annotations();
 
 private:
-    struct annotation_compare {
-        bool operator() (const Annotation &a, const Annotation &b) const {
-            return a.start_sample() < b.start_sample();
-        }
-    };
-
-    std::vector<Annotation/*, annotation_compare*/> annotations_;
+    std::vector<Annotation> annotations_;
+    std::vector<uint64_t> max_end_;
+    std::shared_ptr<AnnotationStrings> strings_;
 };
 
 #endif // ROWDATA_H
@@ -61,12 +61,10 @@ mixed_signal_sink_impl::mixed_signal_sink_impl(adiscope::logic::LogicAnalyzer *l
 		d_analog_buffer.push_back(
 					static_cast<float*>(volk_malloc(d_buffer_size * sizeof(float), volk_get_alignment())));
 		memset(d_analog_buffer[i], 0, d_buffer_size * sizeof(float));
-
-		d_analog_plot_buffers.push_back(
-					static_cast<double*>(volk_malloc(d_buffer_size * sizeof(double), volk_get_alignment())));
-		memset(d_analog_plot_buffers[i], 0, d_buffer_size * sizeof(double));
 	}
 
+	d_frame_pool = adiscope::SampleFramePool<float>::make();
+
 	set_update_time(1/60.0);
 }
 
@@ -113,18 +111,19 @@ int mixed_signal_sink_impl::work(int noutput_items,
 			}
 		}
 
-		for (int i = 0; i < 2; ++i) {
-			volk_32f_convert_64f(d_analog_plot_buffers[i], &d_analog_buffer[i][d_start], nitemsToSend);
-		}
-
 		if (gr::high_res_timer_now() - d_last_time > d_update_time
 				|| !d_cleanBuffers) {
 
+			adiscope::SampleFrame<float>::sptr frame =
+					d_frame_pool->acquire(2, nitemsToSend);
+			for (int i = 0; i < 2; ++i) {
+				memcpy(frame->channel(i), &d_analog_buffer[i][d_start], sizeof(float) * nitemsToSend);
+			}
+
 			d_last_time = gr::high_res_timer_now();
 			d_logic_analyzer->setData(d_digital_buffer + d_start, nitemsToSend);
 			qApp->postEvent(d_osc_plot,
-					new IdentifiableTimeUpdateEvent(d_analog_plot_buffers,
-									nitemsToSend,
+					new IdentifiableTimeUpdateEvent(frame,
 									d_tags,
 									"Osc Time"));
 		}
@@ -150,7 +149,6 @@ void mixed_signal_sink_impl::clean_buffers()
 
 	for (int i = 0; i < 2; ++i) {
 		memset(d_analog_buffer[i], 0, d_buffer_size * sizeof(float));
-		memset(d_analog_plot_buffers[i], 0, d_buffer_size * sizeof(double));
 	}
 
 	_reset();
@@ -170,11 +168,8 @@ void mixed_signal_sink_impl::set_nsamps(int newsize)
 		volk_free(d_digital_buffer);
 		for (int i = 0; i < 2; ++i) {
 			volk_free(d_analog_buffer[i]);
-			volk_free(d_analog_plot_buffers[i]);
-
 		}
 		d_analog_buffer.clear();
-		d_analog_plot_buffers.clear();
 
 		// create new buffers
 		d_digital_buffer = static_cast<uint16_t*>(volk_malloc(d_buffer_size * sizeof(uint16_t), volk_get_alignment()));
@@ -184,9 +179,6 @@ void mixed_signal_sink_impl::set_nsamps(int newsize)
 			d_analog_buffer.push_back(
 						static_cast<float*>(volk_malloc(d_buffer_size * sizeof(float), volk_get_alignment())));
 			memset(d_analog_buffer[i], 0, d_buffer_size * sizeof(float));
-			d_analog_plot_buffers.push_back(
-						static_cast<double*>(volk_malloc(d_buffer_size * sizeof(double), volk_get_alignment())));
-			memset(d_analog_plot_buffers[i], 0, d_buffer_size * sizeof(double));
 		}
 
 		_reset();
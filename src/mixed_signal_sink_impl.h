@@ -22,6 +22,7 @@
 #define MIXED_SIGNAL_SINK_IMPL_H
 
 #include "mixed_signal_sink.h"
+#include "sample_frame.h"
 
 class mixed_signal_sink_impl : public mixed_signal_sink
 {
@@ -48,7 +49,7 @@ private:
 	adiscope::TimeDomainDisplayPlot *d_osc_plot;
 
 	std::vector<float*> d_analog_buffer;
-	std::vector<double*> d_analog_plot_buffers;
+	adiscope::SampleFramePool<float>::sptr d_frame_pool;
 	uint16_t *d_digital_buffer;
 
 	int d_size;
@@ -44,9 +44,11 @@
 #include <boost/make_shared.hpp>
 #include <gnuradio/blocks/stream_to_vector.h>
 #include <gnuradio/blocks/vector_to_stream.h>
-#include <gnuradio/scopy/goertzel_scopy_fc.h>
+
+#include "bin_dft.h"
 
 #include <algorithm>
+#include <complex>
 
 #include <QThread>
 #include <QFileDialog>
@@ -67,6 +69,12 @@
 
 static const int KERNEL_BUFFERS_DEFAULT = 4;
 
+// Most settling time, in samples, taken out of a capture instead of slept
+static const size_t MAX_SETTLE_SAMPLES = 1024 * 1024;
+
+// Largest DAC buffer played during a sweep
+static const size_t MAX_DAC_BUFFER_SIZE = 128 * 1024;
+
 using namespace adiscope;
 using namespace gr;
 using namespace libm2k::context;
@@ -89,82 +97,13 @@ void NetworkAnalyzer::_configureDacFlowgraph()
 void NetworkAnalyzer::_configureAdcFlowgraph(size_t buffer_size)
 {
 	if (m_initFlowgraph) {
-
-
-		capture_top_block = make_top_block("Network capture processing");
-
 		// Get the available sample rates for the m2k-adc
 		// Make sure the values are sorted in ascending order (1000,..,100e6)
 		sampleRates = m_m2k_analogin->getAvailableSampleRates();
-
-		dc_cancel1 = gnuradio::get_initial_sptr(
-					new cancel_dc_offset_block(1, false));
-		dc_cancel2 = gnuradio::get_initial_sptr(
-					new cancel_dc_offset_block(1, false));
-
-		capture1 = gr::blocks::vector_source_s::make(std::vector<short>(), false, 1);
-		capture2 = gr::blocks::vector_source_s::make(std::vector<short>(), false, 1);
-		f11 = adiscope::frequency_compensation_filter::make(false);
-		f12 = adiscope::frequency_compensation_filter::make(false);
-		f21 = adiscope::frequency_compensation_filter::make(false);
-		f22 = adiscope::frequency_compensation_filter::make(false);
-		s2f1 = gr::blocks::short_to_float::make();
-		s2f2 = gr::blocks::short_to_float::make();
-		goertzel1 = gr::scopy::goertzel_scopy_fc::make(1, 1, 1);
-		goertzel2 = gr::scopy::goertzel_scopy_fc::make(1, 1, 1);
-		copy1 = gr::blocks::copy::make(sizeof(float));
-		copy2 = gr::blocks::copy::make(sizeof(float));
-		head1 = gr::blocks::head::make(sizeof(float), 1);
-		head2 = gr::blocks::head::make(sizeof(float), 1);
-		sink1 = gr::blocks::vector_sink_f::make();
-		sink2 = gr::blocks::vector_sink_f::make();
-		c2m1 = gr::blocks::complex_to_mag_squared::make();
-		c2m2 = gr::blocks::complex_to_mag_squared::make();
-		conj = gr::blocks::multiply_conjugate_cc::make();
-		c2a = gr::blocks::complex_to_arg::make();
-		signal = std::make_shared<signal_sample>();
-		adc_conv1 = gr::blocks::multiply_const_ff::make(
-			m_m2k_analogin->getScalingFactor(static_cast<ANALOG_IN_CHANNEL>(0)));
-		adc_conv2 = gr::blocks::multiply_const_ff::make(
-			m_m2k_analogin->getScalingFactor(static_cast<ANALOG_IN_CHANNEL>(1)));
-
-		capture_top_block->connect(capture1, 0, f11, 0);
-		capture_top_block->connect(capture2, 0, f21, 0);
-		capture_top_block->connect(f11, 0, f12, 0);
-		capture_top_block->connect(f21, 0, f22, 0);
-		capture_top_block->connect(f12, 0, s2f1, 0);
-		capture_top_block->connect(f22, 0, s2f2, 0);
-		capture_top_block->connect(s2f1, 0, dc_cancel1, 0);
-		capture_top_block->connect(s2f2, 0, dc_cancel2, 0);
-
-		capture_top_block->connect(dc_cancel1, 0, goertzel1, 0);
-		capture_top_block->connect(dc_cancel2, 0, goertzel2, 0);
-		capture_top_block->connect(goertzel1, 0, c2m1, 0);
-		capture_top_block->connect(c2m1, 0, signal, 0);
-		capture_top_block->connect(goertzel2, 0, c2m2, 0);
-		capture_top_block->connect(c2m2, 0, signal, 1);
-
-		capture_top_block->connect(goertzel1, 0, conj, 0);
-		capture_top_block->connect(goertzel2, 0, conj, 1);
-		capture_top_block->connect(conj, 0, c2a, 0);
-		capture_top_block->connect(c2a, 0, signal, 2);
-
-		mag1 = 0.0, mag2 = 0.0, phase = 0.0;
-		connect(&*signal, &signal_sample::triggered,
-		[&](const std::vector<float> values) {
-			mag1 = values[0];
-			mag2 = values[1];
-			phase = values[2];
-			captureDone = true;
-		});
-
-		capture_top_block->connect(dc_cancel1, 0, adc_conv1, 0);
-		capture_top_block->connect(dc_cancel2, 0, adc_conv2, 0);
-		capture_top_block->connect(adc_conv1, 0, sink1, 0);
-		capture_top_block->connect(adc_conv2, 0, sink2, 0);
 	}
 
-	// Build the flowgraph only once
+	// The captures are analysed by BinDft, straight from the
+	// buffers of the ADC
 	m_initFlowgraph = false;
 
 	ui->btnHelp->setUrl("https://wiki.analog.com/university/tools/m2k/scopy/networkanalyzer");
@@ -191,7 +130,8 @@ NetworkAnalyzer::NetworkAnalyzer(struct iio_context *ctx, Filter *filt,
 	filterDc(false), m_initFlowgraph(true), m_hasReference(false),
 	m_importDataLoaded(false),
 	m_nb_averaging(1),
-	m_nb_periods(2)
+	m_nb_periods(2),
+	m_nb_tones(1)
 {
 	if (ctx) {
 		iio = iio_manager::get_instance(ctx,
@@ -641,6 +581,7 @@ NetworkAnalyzer::NetworkAnalyzer(struct iio_context *ctx, Filter *filt,
 	});
 	connect(ui->btnApplyAverage, SIGNAL(clicked()), this, SLOT(validateSpinboxAveraging()));
 	connect(ui->btnApplyPeriod, SIGNAL(clicked()), this, SLOT(validateSpinboxPeriods()));
+	connect(ui->btnApplyTones, SIGNAL(clicked()), this, SLOT(validateSpinboxTones()));
 
 	ui->btnSettings->setProperty("id",QVariant(-1));
 	ui->btnGeneralSettings->setProperty("id",QVariant(-2));
@@ -732,11 +673,7 @@ NetworkAnalyzer::NetworkAnalyzer(struct iio_context *ctx, Filter *filt,
 		}
 	});
 	connect(ui->dcFilterBtn, &QPushButton::toggled, [=](bool checked){
-		if (checked != filterDc) {
-			filterDc = checked;
-			dc_cancel1->set_enabled(filterDc);
-			dc_cancel2->set_enabled(filterDc);
-		}
+		filterDc = checked;
 	});
 
 	connect(ui->responseGainCmb, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -1105,7 +1042,7 @@ unsigned long NetworkAnalyzer::_getBestSampleRate(double frequency, unsigned int
 size_t NetworkAnalyzer::_getSamplesCount(double frequency, unsigned long rate, bool perfect)
 {
 	size_t minBufferSize = SignalGenerator::min_buffer_size;
-	size_t maxBufferSize = 128 * 1024;
+	size_t maxBufferSize = MAX_DAC_BUFFER_SIZE;
 
 	double ratio = static_cast<double>(rate) / frequency;
 
@@ -1196,55 +1133,132 @@ void NetworkAnalyzer::computeFrequencyArray()
 	iterationsReadyCv.notify_one();
 }
 
-void NetworkAnalyzer::setFilterParameters()
+void NetworkAnalyzer::computeCaptures()
 {
-	f11->set_enable(iio->freq_comp_filt[0][0]->get_enable());
-	f12->set_enable(iio->freq_comp_filt[0][1]->get_enable());
-	f21->set_enable(iio->freq_comp_filt[1][0]->get_enable());
-	f22->set_enable(iio->freq_comp_filt[1][1]->get_enable());
+	captures.clear();
 
-	f11->set_TC(iio->freq_comp_filt[0][0]->get_TC());
-	f12->set_TC(iio->freq_comp_filt[0][1]->get_TC());
-	f21->set_TC(iio->freq_comp_filt[1][0]->get_TC());
-	f22->set_TC(iio->freq_comp_filt[1][1]->get_TC());
+	for (int step = 0; step < iterations.size();) {
+		networkCapture capture;
+		int tones = std::min<int>(m_nb_tones, iterations.size() - step);
 
-	f11->set_filter_gain(iio->freq_comp_filt[0][0]->get_filter_gain());
-	f12->set_filter_gain(iio->freq_comp_filt[0][1]->get_filter_gain());
-	f21->set_filter_gain(iio->freq_comp_filt[1][0]->get_filter_gain());
-	f22->set_filter_gain(iio->freq_comp_filt[1][1]->get_filter_gain());
+		// Fewer tones are tried when they cannot share a buffer
+		while (tones > 1 && !_planMultisine(step, tones, capture)) {
+			tones--;
+		}
 
-	if (m_m2k_analogin) {
-		try {
-			double adc_samplerate = m_m2k_analogin->getSampleRate();
-			f11->set_sample_rate(adc_samplerate);
-			f12->set_sample_rate(adc_samplerate);
-			f21->set_sample_rate(adc_samplerate);
-			f22->set_sample_rate(adc_samplerate);
-
-			libm2k::analog::M2K_RANGE range0 = m_m2k_analogin->getRange(static_cast<ANALOG_IN_CHANNEL>(0));
-			libm2k::analog::M2K_RANGE range1 = m_m2k_analogin->getRange(static_cast<ANALOG_IN_CHANNEL>(1));
-			f11->set_high_gain(range0);
-			f12->set_high_gain(range0);
-			f21->set_high_gain(range1);
-			f22->set_high_gain(range1);
-		} catch (libm2k::m2k_exception &e) {
-			HANDLE_EXCEPTION(e)
-			qDebug(CAT_NETWORK_ANALYZER) << e.what();
+		if (tones == 1) {
+			capture.steps = { step };
+			capture.frequencies = { iterations[step].frequency };
+			capture.rate = iterations[step].rate;
+			capture.bufferSize = iterations[step].bufferSize;
+			capture.adcRate = 0;
+			capture.captureSize = 0;
+
+			computeCaptureParams(iterations[step].frequency,
+					     capture.captureSize, capture.adcRate);
 		}
+
+		captures.push_back(capture);
+		step += tones;
 	}
 }
 
+bool NetworkAnalyzer::_planMultisine(int step, int tones, networkCapture &capture)
+{
+	const double lowest = iterations[step].frequency;
+	const double highest = iterations[step + tones - 1].frequency;
+
+	// The tones are moved onto a grid fine enough to give the lowest
+	// one the periods asked for and to keep the others apart
+	double resolution = lowest / m_nb_periods;
+
+	for (int i = step + 1; i < step + tones; i++) {
+		resolution = std::min(resolution, (iterations[i].frequency -
+						   iterations[i - 1].frequency) / 2);
+	}
+
+	if (resolution <= 0) {
+		return false;
+	}
+
+	// The DAC rate of the highest tone suits all the lower ones; the ADC
+	// rate comes from the highest tone as well
+	const size_t rate = iterations[step + tones - 1].rate;
+	size_t adc_rate = 0;
+	size_t buffer_size = 0;
+
+	computeCaptureParams(highest, buffer_size, adc_rate);
+
+	if (!rate || !adc_rate) {
+		return false;
+	}
+
+	// Both the DAC buffer and the capture have to last a whole number
+	// of grid periods, and the DAC buffer size must be a multiple of 4
+	size_t gcd = rate, rest = adc_rate;
+
+	while (rest) {
+		const size_t r = gcd % rest;
+		gcd = rest;
+		rest = r;
+	}
+
+	size_t multiple = rate / gcd;
+
+	if (multiple % 4) {
+		multiple *= (multiple % 2) ? 4 : 2;
+	}
+
+	size_t size = std::ceil(rate / resolution / multiple) * multiple;
+
+	while (size < SignalGenerator::min_buffer_size) {
+		size += multiple;
+	}
+
+	if (size > MAX_DAC_BUFFER_SIZE) {
+		return false;
+	}
+
+	std::vector<double> frequencies;
+	size_t prev_cycles = 0;
+
+	for (int i = step; i < step + tones; i++) {
+		const size_t cycles = std::lround(iterations[i].frequency *
+						  size / rate);
+
+		if (cycles <= prev_cycles || 2 * cycles >= size) {
+			return false;
+		}
+
+		frequencies.push_back(static_cast<double>(cycles) * rate / size);
+		prev_cycles = cycles;
+	}
+
+	capture.steps.clear();
+	for (int i = step; i < step + tones; i++) {
+		capture.steps.push_back(i);
+	}
+	capture.frequencies = frequencies;
+	capture.rate = rate;
+	capture.bufferSize = size;
+	capture.adcRate = adc_rate;
+	capture.captureSize = size / (rate / gcd) * (adc_rate / gcd);
+
+	return true;
+}
+
 void NetworkAnalyzer::goertzel()
 {
-	float mag1_averaged_sum = 0;
-	float mag2_averaged_sum = 0;
-	float dcOffset_averaged_sum = 0;
-	unsigned int m_averaged_count = 0;
-	// Network Analyzer run method using the Goertzel Algorithm (single bin DFT)
+	// Network Analyzer run method using DFT bins
+	//
+	// The DAC buffers of the next capture are synthesized on the global
+	// thread pool while the current one is captured. The captures are
+	// analysed straight from the buffers of the ADC. With more than one
+	// tone per capture the DACs play a multisine and a few consecutive
+	// sweep steps are measured from each capture.
 
 	// Adjust the gain of the ADC channels based on sweep settings
 	updateGainMode();
-	setFilterParameters();
 
 	// Wait for the iterations thread to finish
 	boost::unique_lock<boost::mutex> lock(iterationsReadyMutex);
@@ -1263,167 +1277,278 @@ void NetworkAnalyzer::goertzel()
 		}
 	}
 
+	computeCaptures();
+	stepTiming.fill(networkStepTiming(), captures.size());
+
+	QFuture<std::vector<double>> dacBuffer;
+	int step = 0;
+
+	// Nothing that the synthesis uses may go away before it is done
+	auto finish = [&]() {
+		dacBuffer.waitForFinished();
+		logSweepTiming(step);
+	};
+
+	auto synthesize = [&](int i) {
+		const std::vector<double> frequencies = captures[i].frequencies;
+		const unsigned long rate = captures[i].rate;
+		const size_t samples_count = captures[i].bufferSize;
+		const double amplitudeValue = amplitude->value();
+		const double offsetValue = offset->value();
+
+		dacBuffer = QtConcurrent::run([=]() {
+			QElapsedTimer t;
+			t.start();
+
+			auto buffer = frequencies.size() == 1 ?
+				generateSinWave(frequencies[0], amplitudeValue,
+						offsetValue, rate, samples_count) :
+				generateMultisine(frequencies, amplitudeValue,
+						  offsetValue, rate, samples_count);
+
+			stepTiming[i].synthesis = t.nsecsElapsed() / 1000;
+			return buffer;
+		});
+	};
+
 	Q_EMIT sweepStart();
-	for (int i = 0; !m_stop && i < iterations.size(); ++i) {
+
+	if (!captures.isEmpty()) {
+		synthesize(0);
+	}
+
+	for (; !m_stop && step < captures.size(); ++step) {
+		networkStepTiming &timing = stepTiming[step];
+		QElapsedTimer t;
 
 		// Get current sweep settings
-		unsigned long rate = iterations[i].rate;
-		size_t samples_count = iterations[i].bufferSize;
-		double frequency = iterations[i].frequency;
+		const networkCapture &capture = captures[step];
+		unsigned long rate = capture.rate;
+		const size_t tones = capture.frequencies.size();
+
+		timing.frequency = capture.frequencies[0];
+		timing.tones = tones;
 
-		double amplitudeValue = amplitude->value();
-		double offsetValue = offset->value();
+		// Push the buffer synthesized during the previous capture to
+		// the DACs, then start on the one of the next capture
+		t.start();
+		const std::vector<double> buffer = dacBuffer.result();
+		timing.synthesisWait = t.nsecsElapsed() / 1000;
 
-		// Create and push the generated sine waves to the DACs
-		std::vector<std::vector<double>> buffers;
+		if (step + 1 < captures.size()) {
+			synthesize(step + 1);
+		}
 
+		t.start();
 		if (m_m2k_analogout) {
 			try {
 				for (unsigned int chn_idx = 0; chn_idx < m_dac_nb_channels; chn_idx++) {
 					m_m2k_analogout->enableChannel(chn_idx, true);
-					std::vector<double> buf_dac = generateSinWave(chn_idx,
-										      frequency, amplitudeValue, offsetValue,
-										      rate, samples_count);
-					buffers.push_back(buf_dac);
+					m_m2k_analogout->setSampleRate(chn_idx, rate);
+					m_m2k_analogout->setOversamplingRatio(chn_idx, 1);
 				}
 				// Sleep before DACs start
 				QThread::msleep(pushDelay->value());
-				m_m2k_analogout->push(buffers);
+				m_m2k_analogout->push(std::vector<std::vector<double>>(
+							      m_dac_nb_channels, buffer));
 			} catch (libm2k::m2k_exception &e) {
 				HANDLE_EXCEPTION(e)
+				finish();
 				return;
 			}
 		}
+		timing.push = t.nsecsElapsed() / 1000;
 
-
-		size_t buffer_size = 0;
-		size_t adc_rate = 0;
-
-		// Compute capture params for the ADC
-		computeCaptureParams(frequency, buffer_size, adc_rate);
+		// Capture params for the ADC, worked out with the plan
+		size_t buffer_size = capture.captureSize;
+		size_t adc_rate = capture.adcRate;
 
 		if (buffer_size == 0) {
 			qDebug(CAT_NETWORK_ANALYZER) << "buffer size 0";
+			finish();
 			return;
 		}
 
-		dc_cancel1->set_buffer_size(buffer_size);
-		dc_cancel2->set_buffer_size(buffer_size);
-
-		goertzel1->set_freq(frequency);
-		goertzel2->set_freq(frequency);
-		goertzel1->set_len(buffer_size);
-		goertzel2->set_len(buffer_size);
-		goertzel1->set_rate(adc_rate);
-		goertzel2->set_rate(adc_rate);
+		BinDft dft(capture.frequencies, adc_rate, buffer_size);
+		double dcZeroVolts = 0.0;
+		double dcVoltsPerRaw = 1.0;
+		double scale[2] = { 1.0, 1.0 };
 
+		dft.setRemoveDc(filterDc);
 
+		t.start();
 		if (m_m2k_analogin) {
 			try {
 				m_m2k_analogin->setOversamplingRatio(1);
 				m_m2k_analogin->setSampleRate(adc_rate);
+
+				// The compensation of the front end of each channel,
+				// as set up in the oscilloscope for its current range
+				for (unsigned int chn_idx = 0; chn_idx < 2; chn_idx++) {
+					const ANALOG_IN_CHANNEL chn = static_cast<ANALOG_IN_CHANNEL>(chn_idx);
+					const int gain_mode = m_m2k_analogin->getRange(chn);
+
+					for (unsigned int stage = 0; stage < 2; stage++) {
+						const auto &filt = iio->freq_comp_filt[chn_idx][stage];
+
+						dft.setCompensation(chn_idx, stage,
+								    filt->get_enable(gain_mode),
+								    filt->get_TC(gain_mode),
+								    filt->get_filter_gain(gain_mode));
+					}
+					scale[chn_idx] = m_m2k_analogin->getScalingFactor(chn);
+				}
+				dcZeroVolts = m_m2k_analogin->convertRawToVolts(1, 0);
+				dcVoltsPerRaw = m_m2k_analogin->convertRawToVolts(1, 1) - dcZeroVolts;
 			} catch (libm2k::m2k_exception &e) {
 				HANDLE_EXCEPTION(e)
 				qDebug(CAT_NETWORK_ANALYZER) << e.what();
 			}
 		}
+		timing.configure = t.nsecsElapsed() / 1000;
 
+		// The settling time after the buffer is taken out of the
+		// first capture as whole samples; only what would not fit in
+		// a capture is slept
+		const double settle_samples = captureDelay->value() * adc_rate / 1000.0;
+		const size_t discard = std::min(settle_samples,
+						(double)MAX_SETTLE_SAMPLES);
 
-		setFilterParameters();
+		t.start();
+		QThread::usleep((settle_samples - discard) * 1e6 / adc_rate);
+		timing.settle = t.nsecsElapsed() / 1000;
 
-		// Sleep before ADC capture
-		QThread::msleep(captureDelay->value());
+		std::vector<double> mag1_averaged_sum(tones, 0.0);
+		std::vector<double> mag2_averaged_sum(tones, 0.0);
+		double dcOffset_averaged_sum = 0;
 
 		for (unsigned int avg = 1; avg <= m_nb_averaging; avg++) {
+			const size_t skip = (avg == 1) ? discard : 0;
 			const short* buffer_p = nullptr;
+
+			t.start();
 			if (m_m2k_analogin) {
 				try {
-					buffer_p = m_m2k_analogin->getSamplesRawInterleaved(buffer_size);
+					buffer_p = m_m2k_analogin->getSamplesRawInterleaved(
+						skip + buffer_size);
 				} catch (libm2k::m2k_exception &e) {
 					HANDLE_EXCEPTION(e)
 					qDebug(CAT_NETWORK_ANALYZER) << e.what();
+					finish();
 					return;
 				}
 				if (m_stop) {
+					finish();
 					return;
 				}
 			}
+			timing.capture += t.nsecsElapsed() / 1000;
 
-			std::vector<short> data0;
-			std::vector<short> data1;
-			for (unsigned int data_i = 0; data_i < buffer_size; data_i++) {
-				data0.push_back(buffer_p[data_i * 2]);
-				data1.push_back(buffer_p[data_i * 2 + 1]);
-			}
-
-			capture1->rewind();
-			capture1->set_data(data0);
-			capture2->rewind();
-			capture2->set_data(data1);
-			{
-				boost::unique_lock<boost::mutex> lock(bufferMutex);
-				sink1->reset();
-				sink2->reset();
+			if (!buffer_p) {
+				continue;
 			}
+			buffer_p += 2 * skip;
 
-			captureDone = false;
-
-			QElapsedTimer t;
 			t.start();
+			dft.compute(buffer_p);
 
-			capture_top_block->run();
+			for (size_t tone = 0; tone < tones; tone++) {
+				mag1_averaged_sum[tone] += std::norm(dft.bin(0, tone));
+				mag2_averaged_sum[tone] += std::norm(dft.bin(1, tone));
+			}
+			dcOffset_averaged_sum += dft.dc(1);
 
-			float dcOffset = 0.0;
-			dcOffset = dc_cancel2->get_dc_offset();
+			QMetaObject::invokeMethod(ui->currentAverageLabel,
+						  "setText",
+						  Qt::QueuedConnection,
+						  Q_ARG(QString, tr("Average: ") + QString::number(avg)
+							+ " / " + QString::number(m_nb_averaging)));
 
-			mag1_averaged_sum += mag1;
-			mag2_averaged_sum += mag2;
-			dcOffset_averaged_sum += dcOffset;
-			ui->currentAverageLabel->setText(QString(tr("Average: ") + QString::number(avg)
-								 + " / " + QString::number(m_nb_averaging)));
 			if (avg == m_nb_averaging) {
-				mag1 = mag1_averaged_sum / m_nb_averaging;
-				mag2 = mag2_averaged_sum / m_nb_averaging;
-				dcOffset = dcOffset_averaged_sum / m_nb_averaging;
-
-				dcOffset = m_m2k_analogin->convertRawToVolts(1, dcOffset);
-
-				QMetaObject::invokeMethod(this,
-							  "_saveChannelBuffers",
-							  Qt::QueuedConnection,
-							  Q_ARG(double, frequency),
-							  Q_ARG(double, adc_rate),
-							  Q_ARG(std::vector<float>, sink1->data()),
-							  Q_ARG(std::vector<float>, sink2->data()));
-
-				// Plot the data captured for this iteration
-				QMetaObject::invokeMethod(this,
-							  "plot",
-							  Qt::QueuedConnection,
-							  Q_ARG(double, frequency),
-							  Q_ARG(double, mag1),
-							  Q_ARG(double, mag2),
-							  Q_ARG(double, phase),
-							  Q_ARG(float, dcOffset));
-
-				mag1_averaged_sum = 0;
-				mag2_averaged_sum = 0;
-				dcOffset_averaged_sum = 0;
-				m_averaged_count = 0;
-
+				float dcOffset = dcZeroVolts + dcVoltsPerRaw *
+					dcOffset_averaged_sum / m_nb_averaging;
+				std::vector<float> data1, data2;
+
+				dft.samples(buffer_p, 0, scale[0], data1);
+				dft.samples(buffer_p, 1, scale[1], data2);
+
+				// Every tone of the capture is a point of the sweep
+				for (size_t tone = 0; tone < tones; tone++) {
+					const double frequency = capture.frequencies[tone];
+					const double mag1 = mag1_averaged_sum[tone] / m_nb_averaging;
+					const double mag2 = mag2_averaged_sum[tone] / m_nb_averaging;
+					const double phase = std::arg(dft.bin(0, tone) *
+								      std::conj(dft.bin(1, tone)));
+
+					QMetaObject::invokeMethod(this,
+								  "_saveChannelBuffers",
+								  Qt::QueuedConnection,
+								  Q_ARG(double, frequency),
+								  Q_ARG(double, adc_rate),
+								  Q_ARG(std::vector<float>, data1),
+								  Q_ARG(std::vector<float>, data2));
+
+					// Plot the data captured for this iteration
+					QMetaObject::invokeMethod(this,
+								  "plot",
+								  Qt::QueuedConnection,
+								  Q_ARG(double, frequency),
+								  Q_ARG(double, mag1),
+								  Q_ARG(double, mag2),
+								  Q_ARG(double, phase),
+								  Q_ARG(float, dcOffset));
+				}
 			}
+			timing.analysis += t.nsecsElapsed() / 1000;
 		}
 
 		m_m2k_analogout->stop();
 
 		// Process was cancelled
 		if (m_stop) {
+			finish();
 			return;
 		}
 	}
+
+	finish();
 	Q_EMIT sweepDone();
 }
 
+void NetworkAnalyzer::logSweepTiming(int steps)
+{
+	networkStepTiming total = networkStepTiming();
+
+	for (int i = 0; i < steps && i < stepTiming.size(); i++) {
+		const networkStepTiming &timing = stepTiming[i];
+
+		qDebug(CAT_NETWORK_ANALYZER) << "Capture" << i << timing.frequency << "Hz,"
+			<< timing.tones << "tones:"
+			<< "synthesis" << timing.synthesis << "us (waited" << timing.synthesisWait << "us),"
+			<< "push" << timing.push << "us,"
+			<< "configure" << timing.configure << "us,"
+			<< "settle" << timing.settle << "us,"
+			<< "capture" << timing.capture << "us,"
+			<< "analysis" << timing.analysis << "us";
+
+		total.synthesis += timing.synthesis;
+		total.synthesisWait += timing.synthesisWait;
+		total.push += timing.push;
+		total.configure += timing.configure;
+		total.settle += timing.settle;
+		total.capture += timing.capture;
+		total.analysis += timing.analysis;
+	}
+
+	qDebug(CAT_NETWORK_ANALYZER) << "Sweep of" << steps << "captures:"
+		<< "synthesis" << total.synthesis / 1000 << "ms (waited" << total.synthesisWait / 1000 << "ms),"
+		<< "push" << total.push / 1000 << "ms,"
+		<< "configure" << total.configure / 1000 << "ms,"
+		<< "settle" << total.settle / 1000 << "ms,"
+		<< "capture" << total.capture / 1000 << "ms,"
+		<< "analysis" << total.analysis / 1000 << "ms";
+}
+
 void NetworkAnalyzer::onFrequencyBarMoved(int pos)
 {
 	d_frequencyHandle->setPositionSilenty(pos);
@@ -1720,6 +1845,8 @@ void NetworkAnalyzer::startStop(bool pressed)
 	ui->btnApplyPeriod->setEnabled(!pressed);
 	ui->spinBox_averaging->setEnabled(!pressed);
 	ui->spinBox_periods->setEnabled(!pressed);
+	ui->btnApplyTones->setEnabled(!pressed);
+	ui->spinBox_tones->setEnabled(!pressed);
 
 	if (pressed) {
 		m_m2k_analogin->setKernelBuffersCount(1);
@@ -1761,25 +1888,10 @@ void NetworkAnalyzer::startStop(bool pressed)
 	}
 }
 
-std::vector<double> NetworkAnalyzer::generateSinWave(
-	unsigned int chn_idx, double frequency,
+std::vector<double> NetworkAnalyzer::generateSinWave(double frequency,
 	double amplitude, double offset,
 	unsigned long rate, size_t samples_count)
 {
-
-	if (m_m2k_analogout) {
-		try {
-			m_m2k_analogout->setSampleRate(chn_idx, rate);
-			m_m2k_analogout->setOversamplingRatio(chn_idx, 1);
-			if (!m_m2k_analogout->isChannelEnabled(chn_idx)) {
-				return {};
-			}
-		} catch (libm2k::m2k_exception &e) {
-			HANDLE_EXCEPTION(e)
-			qDebug(CAT_NETWORK_ANALYZER) << e.what();
-		}
-	}
-
 	// Make sure to clear everything left from the last
 	// sine generation iteration
 	vector_block->reset();
@@ -1800,6 +1912,58 @@ std::vector<double> NetworkAnalyzer::generateSinWave(
 	return samples;
 }
 
+std::vector<double> NetworkAnalyzer::generateMultisine(const std::vector<double> &frequencies,
+	double amplitude, double offset,
+	unsigned long rate, size_t samples_count)
+{
+	std::vector<double> samples(samples_count, 0.0);
+
+	if (frequencies.empty() || samples_count < 4) {
+		return samples;
+	}
+
+	// Every tone has a whole number of periods in the buffer, so each
+	// sample of a tone is a sample of one period of a sine; the cosine
+	// is the same table a quarter of a period later
+	std::vector<double> table(samples_count);
+
+	for (size_t n = 0; n < samples_count; n++) {
+		table[n] = std::sin(2.0 * M_PI * n / samples_count);
+	}
+
+	// Schroeder phases keep the tones from lining up, which keeps the
+	// crest factor of the sum low and so the level of each tone high
+	const size_t tones = frequencies.size();
+
+	for (size_t k = 0; k < tones; k++) {
+		const size_t cycles = std::lround(frequencies[k] * samples_count / rate);
+		const double phase = -M_PI * k * (k + 1) / tones;
+		const double c = std::cos(phase);
+		const double s = std::sin(phase);
+		size_t index = 0;
+
+		for (size_t n = 0; n < samples_count; n++) {
+			samples[n] += c * table[index] +
+				s * table[(index + samples_count / 4) % samples_count];
+			index = (index + cycles) % samples_count;
+		}
+	}
+
+	double peak = 0;
+
+	for (double sample : samples) {
+		peak = std::max(peak, std::fabs(sample));
+	}
+
+	const double gain = peak > 0 ? amplitude / 2.0 / peak : 0.0;
+
+	for (double &sample : samples) {
+		sample = sample * gain + offset;
+	}
+
+	return samples;
+}
+
 void NetworkAnalyzer::configHwForNetworkAnalyzing()
 {
 	if (m_m2k_analogin) {
@@ -1875,3 +2039,13 @@ void NetworkAnalyzer::validateSpinboxPeriods()
 {
 	on_spinBox_periods_valueChanged(ui->spinBox_periods->value());
 }
+
+void NetworkAnalyzer::on_spinBox_tones_valueChanged(int n)
+{
+	m_nb_tones = n;
+}
+
+void NetworkAnalyzer::validateSpinboxTones()
+{
+	on_spinBox_tones_valueChanged(ui->spinBox_tones->value());
+}
@@ -31,7 +31,6 @@
 #include <QtConcurrentRun>
 #include "gui/customPushButton.hpp"
 #include "scroll_filter.hpp"
-#include <gnuradio/scopy/goertzel_scopy_fc.h>
 #include <gnuradio/top_block.h>
 #include <gnuradio/blocks/head.h>
 #include <gnuradio/blocks/vector_sink.h>
@@ -48,7 +47,6 @@
 #include <gnuradio/blocks/moving_average.h>
 #include <gnuradio/blocks/moving_average.h>
 #include <gnuradio/blocks/skiphead.h>
-#include "cancel_dc_offset_block.h"
 #include <gnuradio/blocks/vector_source.h>
 #include "frequency_compensation_filter.h"
 
@@ -145,8 +143,37 @@ private:
 		bool hasError;
 	} NetworkIterationStats;
 
+	/* The sweep steps measured together from one capture. With more
+	 * than one tone the DAC plays a multisine and the frequencies are
+	 * moved onto the bins of the DAC buffer and of the capture. */
+	typedef struct NetworkAnalyzerCapture {
+		QVector<int> steps;
+		std::vector<double> frequencies;
+		size_t rate;
+		size_t bufferSize;
+		size_t adcRate;
+		size_t captureSize;
+	} networkCapture;
+
+	/* Where the time of a capture goes, in microseconds. The DAC
+	 * buffers of a capture are synthesized during the one before it;
+	 * the wait is the time the sweep spent blocked on them. */
+	typedef struct NetworkAnalyzerStepTiming {
+		double frequency;
+		int tones;
+		qint64 synthesis;
+		qint64 synthesisWait;
+		qint64 push;
+		qint64 configure;
+		qint64 settle;
+		qint64 capture;
+		qint64 analysis;
+	} networkStepTiming;
+
 	QVector<networkIteration> iterations;
+	QVector<networkCapture> captures;
 	QVector<NetworkIterationStats> iterationStats;
+	QVector<networkStepTiming> stepTiming;
 
 	std::thread *iterationsThread;
 	bool iterationsThreadCanceled;
@@ -155,34 +182,6 @@ private:
 	bool isIterationsThreadReady();
 	bool isIterationsThreadCanceled();
 
-	gr::top_block_sptr capture_top_block;
-	gr::blocks::vector_source_s::sptr capture1;
-	gr::blocks::vector_source_s::sptr capture2;
-	adiscope::frequency_compensation_filter::sptr f11,f12,f21,f22;
-	gr::blocks::short_to_float::sptr s2f1;
-	gr::blocks::short_to_float::sptr s2f2;
-	gr::scopy::goertzel_scopy_fc::sptr goertzel1;
-	gr::scopy::goertzel_scopy_fc::sptr goertzel2;
-	gr::blocks::copy::sptr copy1;
-	gr::blocks::copy::sptr copy2;
-	iio_manager::port_id id1;
-	iio_manager::port_id id2;
-	gr::blocks::head::sptr head1;
-	gr::blocks::head::sptr head2;
-	gr::blocks::vector_sink_f::sptr sink1;
-	gr::blocks::vector_sink_f::sptr sink2;
-	gr::blocks::complex_to_mag_squared::sptr c2m1;
-	gr::blocks::complex_to_mag_squared::sptr c2m2;
-	gr::blocks::multiply_conjugate_cc::sptr conj;
-	gr::filter::dc_blocker_ff::sptr dcBlocker1;
-	gr::filter::dc_blocker_ff::sptr dcBlocker2;
-	gr::blocks::complex_to_arg::sptr c2a;
-	std::shared_ptr<signal_sample> signal;
-	gr::blocks::multiply_const_ff::sptr adc_conv1, adc_conv2;
-	std::shared_ptr<cancel_dc_offset_block> dc_cancel1;
-	std::shared_ptr<cancel_dc_offset_block> dc_cancel2;
-	float mag1, mag2, phase;
-	bool captureDone;
 	bool filterDc;
 
 	boost::mutex iterationsReadyMutex;
@@ -228,14 +227,17 @@ private:
 	QVector<QVector<double>> m_importData;
 	unsigned int m_nb_averaging;
 	unsigned int m_nb_periods;
+	unsigned int m_nb_tones;
 
 	void goertzel();
-	void setFilterParameters();
+	void logSweepTiming(int steps);
 
-	std::vector<double> generateSinWave(unsigned int chn_idx,
-					    double frequency,
+	std::vector<double> generateSinWave(double frequency,
 					    double amplitude, double offset,
 					    unsigned long rate, size_t samples_count);
+	std::vector<double> generateMultisine(const std::vector<double> &frequencies,
+					      double amplitude, double offset,
+					      unsigned long rate, size_t samples_count);
 
 	void configHwForNetworkAnalyzing();
 
@@ -256,6 +258,8 @@ private:
 	unsigned long _getBestSampleRate(double frequency, unsigned int chn_idx);
 	size_t _getSamplesCount(double frequency, unsigned long rate, bool perfect = false);
 	void computeFrequencyArray();
+	void computeCaptures();
+	bool _planMultisine(int step, int tones, networkCapture &capture);
 
 	bool _checkMagForOverrange(double magnitude);
 private Q_SLOTS:
@@ -279,6 +283,8 @@ private Q_SLOTS:
 	void on_spinBox_averaging_valueChanged(int n);
 	void on_spinBox_periods_valueChanged(int n);
 	void validateSpinboxPeriods();
+	void on_spinBox_tones_valueChanged(int n);
+	void validateSpinboxTones();
 public Q_SLOTS:
 
 	void showEvent(QShowEvent *event);
@@ -263,6 +263,16 @@ void NetworkAnalyzer_API::setPeriods(int val)
 	net->ui->spinBox_periods->setValue(val);
 }
 
+int NetworkAnalyzer_API::getTones() const
+{
+	return net->ui->spinBox_tones->value();
+}
+
+void NetworkAnalyzer_API::setTones(int val)
+{
+	net->ui->spinBox_tones->setValue(val);
+}
+
 int NetworkAnalyzer_API::getLineThickness() const
 {
 	return net->ui->cbLineThickness->currentIndex();
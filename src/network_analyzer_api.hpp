@@ -61,6 +61,7 @@ class NetworkAnalyzer_API : public ApiObject
 	Q_PROPERTY(QList<double> freq READ freq STORED false)
 	Q_PROPERTY(int averaging READ getAveraging WRITE setAveraging)
 	Q_PROPERTY(int periods READ getPeriods WRITE setPeriods)
+	Q_PROPERTY(int tones READ getTones WRITE setTones)
 	Q_PROPERTY(QString notes READ getNotes WRITE setNotes)
 public:
 	explicit NetworkAnalyzer_API(NetworkAnalyzer *net) :
@@ -119,6 +120,9 @@ public:
 	int getPeriods() const;
 	void setPeriods(int val);
 
+	int getTones() const;
+	void setTones(int val);
+
 	Q_INVOKABLE void show();
 
 	QList<double> data() const;
@@ -82,7 +82,9 @@
 #include "ui_oscilloscope.h"
 #include "ui_trigger_settings.h"
 
+#include <algorithm>
 #include <functional>
+#include <memory>
 
 #include <gnuradio/m2k/mixed_signal_source.h>
 
@@ -1307,6 +1309,8 @@ void Oscilloscope::updateTriggerLevelValue(std::vector<float> value)
 
 Oscilloscope::~Oscilloscope()
 {
+	m_exportCancelled = true;
+	m_exportFuture.waitForFinished();
 
 	if (m_mixedSignalViewEnabled) {
 		disableMixedSignalView();
@@ -1595,6 +1599,7 @@ void Oscilloscope::init_channel_settings()
 			QStringList filter;
 			filter += QString(tr("Comma-separated values files (*.csv)"));
 			filter += QString(tr("Tab-delimited values files (*.txt)"));
+			filter += QString(tr("Scopy binary files (*.scb)"));
 			filter += QString(tr("All Files(*)"));
 
 			QString selectedFilter = filter[0];
@@ -2073,6 +2078,7 @@ void Oscilloscope::btnExport_clicked(){
 	QStringList filter;
 	filter += QString(tr("Comma-separated values files (*.csv)"));
 	filter += QString(tr("Tab-delimited values files (*.txt)"));
+	filter += QString(tr("Scopy binary files (*.scb)"));
 	filter += QString(tr("All Files(*)"));
 
 	QString selectedFilter = filter[0];
@@ -2094,39 +2100,86 @@ void Oscilloscope::btnExport_clicked(){
 			atleastOneChannelEnabled = true;
 			break;
 		}
-	if (!atleastOneChannelEnabled){
+	if (!atleastOneChannelEnabled || fileName.isEmpty() || m_exportFuture.isRunning()) {
+		pause(false);
 		return;
 	}
 
-	if (!fileName.isEmpty()){
-		FileManager fm("Oscilloscope");
-		fm.open(fileName, FileManager::EXPORT);
+	std::shared_ptr<FileManager> fm = std::make_shared<FileManager>("Oscilloscope");
+	fm->open(fileName, FileManager::EXPORT);
 
-		int channels_number = nb_channels + nb_math_channels;
-		QVector<double> time_data;
+	// The worker reads the frames the curves draw from; they are never
+	// written again and stay alive while it holds them, whatever the
+	// plot does meanwhile. Curves that don't draw from a frame are copied.
+	auto readCurve = [=](const QwtPlotCurve *curve) -> FileManager::ColumnReader {
+		const QwtSeriesData<QPointF> *data = curve->data();
+		const SampleFrame<float>::sptr frame = plot.curveFrame(curve);
 
-		for (size_t i = 0; i < plot.Curve(0)->data()->size(); ++i) {
-			time_data.push_back(plot.Curve(0)->sample(i).x());
+		if (frame) {
+			const float *samples = static_cast<const FloatSeriesData *>(data)->yData();
+
+			return [frame, samples](size_t first, size_t count, double *dest) {
+				std::copy_n(samples + first, count, dest);
+			};
+		}
+
+		auto values = std::make_shared<QVector<double>>(data->size());
+		for (size_t i = 0; i < data->size(); ++i) {
+			(*values)[i] = data->sample(i).y();
 		}
 
-		fm.save(time_data, "Time(S)");
+		return [values](size_t first, size_t count, double *dest) {
+			std::copy_n(values->constData() + first, count, dest);
+		};
+	};
 
-		for (int i = 0; i < channels_number; ++i){
-			if (exportConfig[i]){
-				QVector<double> data;
-				int samples = plot.Curve(i)->data()->size();
-				for (int j = 0; j < samples; ++j)
-					data.push_back(plot.Curve(i)->data()->sample(j).y());
-				QString chNo = (i > 1) ? QString::number(i - 1) : QString::number(i + 1);
+	long timeFirst;
+	double timeStep;
+	plot.timeAxis(plot.Curve(0), timeFirst, timeStep);
 
-				fm.save(data, ((i > 1) ? "M" : "CH") + chNo + "(V)");
-			}
+	fm->save([timeFirst, timeStep](size_t first, size_t count, double *dest) {
+		for (size_t i = 0; i < count; ++i) {
+			dest[i] = (timeFirst + long(first + i)) * timeStep;
 		}
+	}, plot.Curve(0)->data()->size(), "Time(S)");
 
-		fm.setSampleRate(active_sample_rate);
-		fm.performWrite();
+	int channels_number = nb_channels + nb_math_channels;
+
+	for (int i = 0; i < channels_number; ++i){
+		if (exportConfig[i]){
+			const QwtPlotCurve *curve = plot.Curve(i);
+			QString chNo = (i > 1) ? QString::number(i - 1) : QString::number(i + 1);
+
+			fm->save(readCurve(curve), curve->data()->size(),
+				 ((i > 1) ? "M" : "CH") + chNo + "(V)");
+		}
 	}
+
+	// The plot can go on while the file is written
 	pause(false);
+
+	fm->setSampleRate(active_sample_rate);
+	fm->setProgressHandler([=](int percent) {
+		QMetaObject::invokeMethod(exportSettings, "setExportProgress",
+					  Qt::QueuedConnection, Q_ARG(int, percent));
+		return !m_exportCancelled;
+	});
+
+	exportSettings->setExportProgress(0);
+
+	QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+	connect(watcher, &QFutureWatcher<bool>::finished, this, [=](){
+		if (!watcher->result()) {
+			qDebug(CAT_OSCILLOSCOPE) << "Export to" << fileName << "failed";
+		}
+		exportSettings->setExportProgress(100);
+		watcher->deleteLater();
+	});
+
+	m_exportFuture = QtConcurrent::run([fm](){
+		return fm->performWrite();
+	});
+	watcher->setFuture(m_exportFuture);
 }
 
 void Oscilloscope::create_add_channel_panel()
@@ -2393,7 +2446,8 @@ void Oscilloscope::import()
 {
 	QString fileName = QFileDialog::getOpenFileName(this,
 	    tr("Import"), "", tr("Comma-separated values files (*.csv);;"
-				       "Tab-delimited values files (*.txt)"),
+				       "Tab-delimited values files (*.txt);;"
+				       "Scopy binary files (*.scb)"),
 	    nullptr, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
 
 	FileManager fm("Oscilloscope");
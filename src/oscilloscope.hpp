@@ -45,6 +45,9 @@
 #include <QMap>
 #include <QQueue>
 #include <QThreadPool>
+#include <QFuture>
+
+#include <atomic>
 
 /* Local includes */
 #include "apiObject.hpp"
@@ -334,6 +337,10 @@ namespace adiscope {
 
 		QMap<int, bool> exportConfig;
 
+		// Export running on a worker thread, on its own copy of the curves
+		QFuture<bool> m_exportFuture;
+		std::atomic<bool> m_exportCancelled{false};
+
 		std::shared_ptr<SymmetricBufferMode> symmBufferMode;
 
 		adiscope::scope_sink_f::sptr qt_time_block;
@@ -30,6 +30,7 @@
 #include <QLabel>
 #include <QThread>
 #include <QDebug>
+#include <QtConcurrent>
 
 #include <algorithm>
 
@@ -76,7 +77,10 @@ CapturePlot::CapturePlot(QWidget *parent,  bool isdBgraph, unsigned int xNumDivs
 	d_startedGrouping(false),
 	d_xAxisInterval{0.0, 0.0},
 	d_currentHandleInitPx(30),
-	d_maxBufferError(nullptr)
+	d_maxBufferError(nullptr),
+	d_measurePending(false),
+	d_measureGeneration(0),
+	d_measureJobsGeneration(0)
 {
 	setMinimumHeight(200);
 	setMinimumWidth(200);
@@ -352,6 +356,8 @@ CapturePlot::CapturePlot(QWidget *parent,  bool isdBgraph, unsigned int xNumDivs
 	/* Apply measurements for every new batch of data */
 	connect(this, SIGNAL(newData()),
 		SLOT(onNewDataReceived()));
+	connect(&d_measureWatcher, SIGNAL(finished()),
+		SLOT(onMeasurementsFinished()));
 
 	/* Add offset widgets for each new channel */
 	connect(this, SIGNAL(channelAdded(int)),
@@ -396,6 +402,7 @@ CapturePlot::CapturePlot(QWidget *parent,  bool isdBgraph, unsigned int xNumDivs
 
 CapturePlot::~CapturePlot()
 {
+	d_measureWatcher.waitForFinished();
 	canvas()->removeEventFilter(d_cursorReadouts);
 	removeEventFilter(this);
 	canvas()->removeEventFilter(d_symbolCtrl);
@@ -1808,6 +1815,7 @@ void CapturePlot::onChannelAdded(int chnIdx)
 
 	measure->setAdcBitCount(12);
 	d_measureObjs.push_back(measure);
+	d_measureGeneration++;
 }
 
 void CapturePlot::computeMeasurementsForChannel(unsigned int chnIdx, unsigned int sampleRate)
@@ -1842,6 +1850,7 @@ void CapturePlot::cleanUpJustBeforeChannelRemoval(int chnIdx)
 				d_measureObjs[i]->channel() - 1);
 		}
 		d_measureObjs.removeOne(measure);
+		d_measureGeneration++;
 		delete measure;
 	}
 }
@@ -1920,29 +1929,86 @@ int CapturePlot::activeMeasurementsCount(int chnIdx)
 void CapturePlot::onNewDataReceived()
 {
 	int ref_idx = 0;
+
+	// The curves may now point to a different frame, so the data sources
+	// are refreshed even if nothing is measured right now
+	for (int i = 0; i < d_measureObjs.size(); i++) {
+		Measure *measure = d_measureObjs[i];
+		int chn = measure->channel();
+		if (isReferenceWaveform(Curve(chn))) {
+			measure->setDataSource(d_ref_ydata[ref_idx],
+								   Curve(chn)->data()->size());
+			ref_idx++;
+		} else {
+			int idx = chn - countReferenceWaveform(chn);
+			if (d_ydata_f[idx]) {
+				measure->setDataSource(d_ydata_f[idx],
+						Curve(chn)->data()->size(),
+						ydataFrame(idx));
+			} else {
+				measure->setDataSource(d_ydata[idx],
+						Curve(chn)->data()->size());
+			}
+		}
+	}
+
 	if(d_measurementsEnabled) {
 		for (int i = 0; i < d_measureObjs.size(); i++) {
 			Measure *measure = d_measureObjs[i];
 			int chn = measure->channel();
-			if (isReferenceWaveform(Curve(chn))) {
-				measure->setDataSource(d_ref_ydata[ref_idx],
-									   Curve(chn)->data()->size());
-				ref_idx++;
-			} else {
-				int count = countReferenceWaveform(chn);
-				measure->setDataSource(d_ydata[chn - count],
-						Curve(chn)->data()->size());
-			}
 
 			if (isMathWaveform(Curve(chn))) {
 				measure->setAdcBitCount(0);
 			}
 
 			measure->setSampleRate(this->sampleRate());
-			measure->measure();
 		}
 
+		startMeasurements();
+	}
+}
+
+void CapturePlot::startMeasurements()
+{
+	if (d_measureWatcher.isRunning()) {
+		d_measurePending = true;
+		return;
+	}
+
+	d_measurePending = false;
+	d_measureJobs.clear();
+	d_measureJobTargets.clear();
+
+	for (int i = 0; i < d_measureObjs.size(); i++) {
+		d_measureJobs.push_back(d_measureObjs[i]->snapshot());
+		d_measureJobTargets.push_back(d_measureObjs[i]);
+	}
+	d_measureJobsGeneration = d_measureGeneration;
+
+	d_measureWatcher.setFuture(QtConcurrent::map(d_measureJobs,
+		[](std::shared_ptr<Measure> &job) {
+			job->measure();
+		}));
+}
+
+void CapturePlot::onMeasurementsFinished()
+{
+	if (d_measureJobsGeneration == d_measureGeneration) {
+		for (int i = 0; i < d_measureJobs.size(); i++) {
+			d_measureJobTargets[i]->copyResults(*d_measureJobs[i]);
+		}
+	}
+
+	// Let go of the frames as soon as possible, the sink reuses them
+	d_measureJobs.clear();
+	d_measureJobTargets.clear();
+
+	if (d_measurementsEnabled) {
 		Q_EMIT measurementsAvailable();
+
+		if (d_measurePending) {
+			startMeasurements();
+		}
 	}
 }
 
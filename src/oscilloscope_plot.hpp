@@ -27,6 +27,9 @@
 #include "graticule.h"
 
 #include <functional>
+#include <memory>
+
+#include <QFutureWatcher>
 
 #include <qwt_plot_zoneitem.h>
 
@@ -191,10 +194,12 @@ namespace adiscope {
 		void updateBufferSizeSampleRateLabel(int nsamples, double sr);
 		void updateHandleAreaPadding(bool);
 		void updateGateMargins();
+		void startMeasurements();
 
 	private Q_SLOTS:
 		void onChannelAdded(int);
 		void onNewDataReceived();
+		void onMeasurementsFinished();
 
 		void onGateBar1PixelPosChanged(int);
 		void onGateBar2PixelPosChanged(int);
@@ -268,6 +273,17 @@ namespace adiscope {
 
 	        QList<Measure *> d_measureObjs;
 
+		// New frames are measured on the thread pool, each channel on a
+		// snapshot of its Measure. Frames that come in while that runs
+		// are not queued: the newest one is measured once it is done.
+		// The results of a run are dropped if the channels changed.
+		QFutureWatcher<void> d_measureWatcher;
+		QVector<std::shared_ptr<Measure>> d_measureJobs;
+		QVector<Measure *> d_measureJobTargets;
+		bool d_measurePending;
+		unsigned int d_measureGeneration;
+		unsigned int d_measureJobsGeneration;
+
 		double value_v1, value_v2, value_h1, value_h2;
 		double value_gateLeft, value_gateRight;
 		double d_minOffsetValue, d_maxOffsetValue;
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "peak_finder.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace adiscope;
+
+namespace {
+	/* Heap order: the worst peak kept is at the front */
+	bool higherPeak(const Peak &a, const Peak &b)
+	{
+		return a.value > b.value || (a.value == b.value && a.bin < b.bin);
+	}
+}
+
+PeakFinder::PeakFinder() :
+	m_threshold(-std::numeric_limits<double>::infinity()),
+	m_min_separation(0),
+	m_count(0),
+	m_has_pending(false)
+{
+}
+
+double PeakFinder::threshold() const
+{
+	return m_threshold;
+}
+
+void PeakFinder::setThreshold(double threshold)
+{
+	m_threshold = threshold;
+}
+
+size_t PeakFinder::minSeparation() const
+{
+	return m_min_separation;
+}
+
+void PeakFinder::setMinSeparation(size_t bins)
+{
+	m_min_separation = bins;
+}
+
+const std::vector<Peak>& PeakFinder::find(const double *data, size_t size,
+					  size_t first, size_t last, size_t count)
+{
+	m_peaks.clear();
+	m_count = count;
+	m_has_pending = false;
+
+	// Both neighbours of a peak have to exist
+	const size_t begin = std::max<size_t>(first, 1);
+	const size_t end = std::min(last, size ? size - 1 : 0);
+
+	if (!data || !count || begin >= end) {
+		return m_peaks;
+	}
+
+	// Candidates that cannot get into the heap are dropped four at a
+	// time, which is most of the curve once the heap is full
+	auto floor = [this]() {
+		return m_peaks.size() < m_count ? m_threshold :
+			std::max(m_threshold, m_peaks.front().value);
+	};
+
+	size_t i = begin;
+
+	for (; i + simd::LANES <= end; i += simd::LANES) {
+		const simd::v4df c = simd::load(data + i);
+		const simd::v4di mask = (c > simd::load(data + i - 1)) &
+			(c >= simd::load(data + i + 1)) &
+			(c > simd::broadcast(floor()));
+
+		if (!simd::any(mask)) {
+			continue;
+		}
+
+		for (unsigned int j = 0; j < simd::LANES; j++) {
+			if (mask[j]) {
+				offer({ i + j, c[j] });
+			}
+		}
+	}
+	for (; i < end; i++) {
+		if (data[i] > data[i - 1] && data[i] >= data[i + 1] &&
+				data[i] > floor()) {
+			offer({ i, data[i] });
+		}
+	}
+
+	if (m_has_pending) {
+		push(m_pending);
+	}
+
+	std::sort_heap(m_peaks.begin(), m_peaks.end(), higherPeak);
+
+	return m_peaks;
+}
+
+void PeakFinder::offer(const Peak &peak)
+{
+	if (!m_min_separation) {
+		push(peak);
+		return;
+	}
+
+	// Peaks come in bin order, so only the last one kept can be too close
+	if (m_has_pending && peak.bin - m_pending.bin < m_min_separation) {
+		if (peak.value > m_pending.value) {
+			m_pending = peak;
+		}
+		return;
+	}
+
+	if (m_has_pending) {
+		push(m_pending);
+	}
+	m_pending = peak;
+	m_has_pending = true;
+}
+
+void PeakFinder::push(const Peak &peak)
+{
+	if (m_peaks.size() < m_count) {
+		m_peaks.push_back(peak);
+		std::push_heap(m_peaks.begin(), m_peaks.end(), higherPeak);
+	} else if (higherPeak(peak, m_peaks.front())) {
+		std::pop_heap(m_peaks.begin(), m_peaks.end(), higherPeak);
+		m_peaks.back() = peak;
+		std::push_heap(m_peaks.begin(), m_peaks.end(), higherPeak);
+	}
+}
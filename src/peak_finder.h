@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PEAK_FINDER_H
+#define PEAK_FINDER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace adiscope {
+
+struct Peak {
+	size_t bin;
+	double value;
+};
+
+/*
+ * Finds the highest local maxima of a curve in one pass, keeping the best
+ * ones found so far in a heap as large as the number of peaks asked for.
+ *
+ * A local maximum is higher than the sample before it and not lower than
+ * the one after it, so a flat top counts once, at its first sample. Peaks
+ * that are not above the threshold are ignored. With a minimum separation,
+ * of two peaks closer than that many bins only the higher one is kept,
+ * going from low to high bins; equal peaks keep the lower bin.
+ */
+class PeakFinder
+{
+public:
+	PeakFinder();
+
+	double threshold() const;
+	void setThreshold(double threshold);
+	size_t minSeparation() const;
+	void setMinSeparation(size_t bins);
+
+	/*
+	 * Returns at most count peaks of data[first, last), highest first.
+	 * The neighbours of first and last are looked at when inside
+	 * data[0, size). The list is valid until the next call.
+	 */
+	const std::vector<Peak>& find(const double *data, size_t size,
+				      size_t first, size_t last, size_t count);
+
+private:
+	void offer(const Peak &peak);
+	void push(const Peak &peak);
+
+	double m_threshold;
+	size_t m_min_separation;
+
+	size_t m_count;
+	std::vector<Peak> m_peaks;
+	Peak m_pending;
+	bool m_has_pending;
+};
+}
+
+#endif // PEAK_FINDER_H
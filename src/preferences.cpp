@@ -69,6 +69,8 @@ Preferences::Preferences(QWidget *parent) :
 	m_displaySamplingPoints(false),
 	m_separateAnnotations(false),
 	m_tableInfo(true),
+	m_logicCaptureToDisk(false),
+	m_logicContinuousStream(false),
 	m_instrument_notes_active(false),
 	m_debug_messages_active(false),
 	m_attemptTempLutCalib(false),
@@ -299,6 +301,22 @@ Preferences::Preferences(QWidget *parent) :
 		Q_EMIT notify();
 	});
 
+	connect(ui->logicAnalyzerCaptureToDisk, &QCheckBox::stateChanged, [=](int state){
+		m_logicCaptureToDisk = (!state ? false : true);
+		ui->logicAnalyzerCaptureFile->setEnabled(m_logicCaptureToDisk);
+		Q_EMIT notify();
+	});
+
+	connect(ui->logicAnalyzerCaptureFile, &QLineEdit::editingFinished, [=](){
+		m_logicCaptureFile = ui->logicAnalyzerCaptureFile->text();
+		Q_EMIT notify();
+	});
+
+	connect(ui->logicAnalyzerContinuousStream, &QCheckBox::stateChanged, [=](int state){
+		m_logicContinuousStream = (!state ? false : true);
+		Q_EMIT notify();
+	});
+
 	connect(ui->useOpenGl, &QCheckBox::stateChanged, [=](int state){
 		m_use_open_gl = state;
 		qputenv("SCOPY_USE_OPENGL",QByteArray::number(state));
@@ -409,6 +427,36 @@ void Preferences::setTableInfo(bool flag)
 	m_tableInfo = flag;
 }
 
+bool Preferences::getLogicCaptureToDisk() const
+{
+	return m_logicCaptureToDisk;
+}
+
+void Preferences::setLogicCaptureToDisk(bool enabled)
+{
+	m_logicCaptureToDisk = enabled;
+}
+
+QString Preferences::getLogicCaptureFile() const
+{
+	return m_logicCaptureFile;
+}
+
+void Preferences::setLogicCaptureFile(const QString &path)
+{
+	m_logicCaptureFile = path;
+}
+
+bool Preferences::getLogicContinuousStream() const
+{
+	return m_logicContinuousStream;
+}
+
+void Preferences::setLogicContinuousStream(bool enabled)
+{
+	m_logicContinuousStream = enabled;
+}
+
 bool Preferences::getSeparateAnnotations() const
 {
 	return m_separateAnnotations;
@@ -467,6 +515,10 @@ void Preferences::initializePreferences()
 	ui->logicAnalyzerDisplaySamplingPoints->setChecked(m_displaySamplingPoints);
 	ui->logicAnalyzerSeparateAnnotations->setChecked(m_separateAnnotations);
 	ui->logicAnalyzerTableInfo->setChecked(m_tableInfo);
+	ui->logicAnalyzerCaptureToDisk->setChecked(m_logicCaptureToDisk);
+	ui->logicAnalyzerCaptureFile->setText(m_logicCaptureFile);
+	ui->logicAnalyzerCaptureFile->setEnabled(m_logicCaptureToDisk);
+	ui->logicAnalyzerContinuousStream->setChecked(m_logicContinuousStream);
 	ui->instrumentNotesCheckbox->setChecked(m_instrument_notes_active);
 	ui->debugMessagesCheckbox->setChecked(m_debug_messages_active);
 	ui->debugInstrumentCheckbox->setChecked(debugger_enabled);
@@ -1052,6 +1104,33 @@ void Preferences_API::setTableInfo(bool val)
 	preferencePanel->m_tableInfo = val;
 }
 
+bool Preferences_API::getLogicCaptureToDisk() const
+{
+	return preferencePanel->m_logicCaptureToDisk;
+}
+void Preferences_API::setLogicCaptureToDisk(bool val)
+{
+	preferencePanel->m_logicCaptureToDisk = val;
+}
+
+QString Preferences_API::getLogicCaptureFile() const
+{
+	return preferencePanel->m_logicCaptureFile;
+}
+void Preferences_API::setLogicCaptureFile(const QString &val)
+{
+	preferencePanel->m_logicCaptureFile = val;
+}
+
+bool Preferences_API::getLogicContinuousStream() const
+{
+	return preferencePanel->m_logicContinuousStream;
+}
+void Preferences_API::setLogicContinuousStream(bool val)
+{
+	preferencePanel->m_logicContinuousStream = val;
+}
+
 
 QString Preferences_API::getCurrentStylesheet() const
 {
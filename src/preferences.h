@@ -120,6 +120,15 @@ public:
 	bool getTableInfo() const;
 	void setTableInfo(bool display);
 
+	bool getLogicCaptureToDisk() const;
+	void setLogicCaptureToDisk(bool enabled);
+
+	QString getLogicCaptureFile() const;
+	void setLogicCaptureFile(const QString &path);
+
+	bool getLogicContinuousStream() const;
+	void setLogicContinuousStream(bool enabled);
+
 	bool getInstrumentNotesActive() const;
 	void setInstrumentNotesActive(bool display);
 
@@ -211,6 +220,9 @@ private:
 	bool m_displaySamplingPoints;
 	bool m_separateAnnotations;
 	bool m_tableInfo;
+	bool m_logicCaptureToDisk;
+	QString m_logicCaptureFile;
+	bool m_logicContinuousStream;
 	bool m_debug_messages_active;
 	bool m_attemptTempLutCalib;
 	bool m_skipCalIfCalibrated;
@@ -256,6 +268,9 @@ class Preferences_API : public ApiObject
 	Q_PROPERTY(bool skipCalIfCalibrated READ getSkipCalIfCalibrated WRITE setSkipCalIfCalibrated)
 	Q_PROPERTY(bool separateAnnotations READ getSeparateAnnotations WRITE setSeparateAnnotations)
 	Q_PROPERTY(bool TableInfo READ getTableInfo WRITE setTableInfo)
+	Q_PROPERTY(bool logicCaptureToDisk READ getLogicCaptureToDisk WRITE setLogicCaptureToDisk)
+	Q_PROPERTY(QString logicCaptureFile READ getLogicCaptureFile WRITE setLogicCaptureFile)
+	Q_PROPERTY(bool logicContinuousStream READ getLogicContinuousStream WRITE setLogicContinuousStream)
 	Q_PROPERTY(bool automatical_version_checking_enabled READ getAutomaticalVersionCheckingEnabled WRITE setAutomaticalVersionCheckingEnabled)
 	Q_PROPERTY(QString check_updates_url READ getCheckUpdatesUrl WRITE setCheckUpdatesUrl)
 	Q_PROPERTY(bool first_application_run READ getFirstApplicationRun WRITE setFirstApplicationRun)
@@ -345,6 +360,15 @@ public:
 	bool getTableInfo() const;
 	void setTableInfo(bool val);
 
+	bool getLogicCaptureToDisk() const;
+	void setLogicCaptureToDisk(bool val);
+
+	QString getLogicCaptureFile() const;
+	void setLogicCaptureFile(const QString &val);
+
+	bool getLogicContinuousStream() const;
+	void setLogicContinuousStream(bool val);
+
 	bool getAutomaticalVersionCheckingEnabled() const;
 	void setAutomaticalVersionCheckingEnabled(const bool& enabled);
 
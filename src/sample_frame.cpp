@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2019 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sample_frame.h"
+
+#include <volk/volk.h>
+
+#include <functional>
+
+using namespace adiscope;
+
+template <typename T>
+SampleFrame<T>::SampleFrame(size_t numChannels, size_t numPoints)
+	: d_channels(numChannels, nullptr)
+	, d_capacity(numPoints ? numPoints : 1)
+	, d_num_points(numPoints)
+{
+	for (size_t i = 0; i < numChannels; i++) {
+		d_channels[i] = static_cast<T *>(volk_malloc(d_capacity * sizeof(T),
+							     volk_get_alignment()));
+	}
+}
+
+template <typename T>
+SampleFrame<T>::~SampleFrame()
+{
+	for (size_t i = 0; i < d_channels.size(); i++) {
+		volk_free(d_channels[i]);
+	}
+}
+
+template <typename T>
+typename SampleFrame<T>::sptr SampleFrame<T>::make(size_t numChannels, size_t numPoints)
+{
+	return sptr(new SampleFrame<T>(numChannels, numPoints));
+}
+
+template <typename T>
+size_t SampleFrame<T>::numChannels() const
+{
+	return d_channels.size();
+}
+
+template <typename T>
+size_t SampleFrame<T>::numPoints() const
+{
+	return d_num_points;
+}
+
+template <typename T>
+size_t SampleFrame<T>::capacity() const
+{
+	return d_capacity;
+}
+
+template <typename T>
+T *SampleFrame<T>::channel(size_t idx)
+{
+	return d_channels[idx];
+}
+
+template <typename T>
+const T *SampleFrame<T>::channel(size_t idx) const
+{
+	return d_channels[idx];
+}
+
+template <typename T>
+const std::vector<T *> &SampleFrame<T>::channels() const
+{
+	return d_channels;
+}
+
+template <typename T>
+bool SampleFrame<T>::fits(size_t numChannels, size_t numPoints) const
+{
+	return d_channels.size() == numChannels && d_capacity >= numPoints;
+}
+
+template <typename T>
+void SampleFrame<T>::reshape(size_t numPoints)
+{
+	d_num_points = numPoints;
+}
+
+/***************************************************************************/
+
+template <typename T>
+SampleFramePool<T>::SampleFramePool(size_t maxFreeFrames)
+	: d_max_free(maxFreeFrames)
+{
+}
+
+template <typename T>
+SampleFramePool<T>::~SampleFramePool()
+{
+	clear();
+}
+
+template <typename T>
+typename SampleFramePool<T>::sptr SampleFramePool<T>::make(size_t maxFreeFrames)
+{
+	return sptr(new SampleFramePool<T>(maxFreeFrames));
+}
+
+template <typename T>
+typename SampleFrame<T>::sptr SampleFramePool<T>::acquire(size_t numChannels, size_t numPoints)
+{
+	SampleFrame<T> *frame = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(d_mutex);
+
+		for (size_t i = 0; i < d_free.size(); i++) {
+			if (d_free[i]->fits(numChannels, numPoints)) {
+				frame = d_free[i];
+				d_free.erase(d_free.begin() + i);
+				break;
+			}
+		}
+
+		// The sink was reconfigured; frames of the old shape
+		// won't be of any use anymore
+		if (!frame) {
+			for (size_t i = 0; i < d_free.size(); i++) {
+				delete d_free[i];
+			}
+			d_free.clear();
+		}
+	}
+
+	if (!frame) {
+		frame = new SampleFrame<T>(numChannels, numPoints);
+	}
+	frame->reshape(numPoints);
+
+	std::weak_ptr<SampleFramePool<T>> pool = this->shared_from_this();
+
+	return typename SampleFrame<T>::sptr(frame,
+		std::bind(&SampleFramePool<T>::recycle, pool, std::placeholders::_1));
+}
+
+template <typename T>
+void SampleFramePool<T>::clear()
+{
+	std::lock_guard<std::mutex> lock(d_mutex);
+
+	for (size_t i = 0; i < d_free.size(); i++) {
+		delete d_free[i];
+	}
+	d_free.clear();
+}
+
+template <typename T>
+void SampleFramePool<T>::recycle(std::weak_ptr<SampleFramePool<T>> pool,
+				 SampleFrame<T> *frame)
+{
+	sptr owner = pool.lock();
+
+	if (owner) {
+		std::lock_guard<std::mutex> lock(owner->d_mutex);
+
+		if (owner->d_free.size() < owner->d_max_free) {
+			owner->d_free.push_back(frame);
+			return;
+		}
+	}
+
+	delete frame;
+}
+
+namespace adiscope {
+	template class SampleFrame<double>;
+	template class SampleFrame<float>;
+	template class SampleFramePool<double>;
+	template class SampleFramePool<float>;
+}
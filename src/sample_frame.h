@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2019 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SAMPLE_FRAME_H
+#define SAMPLE_FRAME_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace adiscope {
+
+template <typename T> class SampleFramePool;
+
+/*
+ * A block of per-channel sample buffers handed from a GNU Radio sink to a
+ * plot. Frames are reference counted: the sink fills one, wraps it in an
+ * update event and forgets about it; whoever holds the last reference
+ * (the event or the plot) sends it back to the pool it came from.
+ *
+ * Once posted, a frame must be treated as read-only by everybody.
+ */
+template <typename T>
+class SampleFrame
+{
+public:
+	typedef std::shared_ptr<SampleFrame<T>> sptr;
+
+	/* Allocates a frame that does not belong to any pool */
+	static sptr make(size_t numChannels, size_t numPoints);
+
+	~SampleFrame();
+
+	size_t numChannels() const;
+	size_t numPoints() const;
+	size_t capacity() const;
+
+	T *channel(size_t idx);
+	const T *channel(size_t idx) const;
+	const std::vector<T *> &channels() const;
+
+private:
+	friend class SampleFramePool<T>;
+
+	SampleFrame(size_t numChannels, size_t numPoints);
+	SampleFrame(const SampleFrame &) = delete;
+	SampleFrame &operator=(const SampleFrame &) = delete;
+
+	bool fits(size_t numChannels, size_t numPoints) const;
+	void reshape(size_t numPoints);
+
+	std::vector<T *> d_channels;
+	size_t d_capacity;
+	size_t d_num_points;
+};
+
+/*
+ * Recycles the buffers of released frames so that posting a new frame does
+ * not hit the allocator in the steady state. A pool may outlive the sink
+ * that created it (frames still sitting in the event queue keep it alive),
+ * and frames released after the pool is gone are simply freed.
+ */
+template <typename T>
+class SampleFramePool : public std::enable_shared_from_this<SampleFramePool<T>>
+{
+public:
+	typedef std::shared_ptr<SampleFramePool<T>> sptr;
+
+	static sptr make(size_t maxFreeFrames = 4);
+
+	~SampleFramePool();
+
+	/* Returns a frame with room for at least numPoints per channel.
+	 * The contents of a recycled frame are unspecified. */
+	typename SampleFrame<T>::sptr acquire(size_t numChannels, size_t numPoints);
+
+	/* Drops all the frames waiting to be reused */
+	void clear();
+
+private:
+	explicit SampleFramePool(size_t maxFreeFrames);
+
+	static void recycle(std::weak_ptr<SampleFramePool<T>> pool,
+			    SampleFrame<T> *frame);
+
+	std::mutex d_mutex;
+	std::vector<SampleFrame<T> *> d_free;
+	size_t d_max_free;
+};
+
+}
+
+#endif /* SAMPLE_FRAME_H */
@@ -82,10 +82,6 @@ scope_sink_f_impl::scope_sink_f_impl(int size, double samp_rate,
 
 
 	for(int n = 0; n < d_nconnections; n++) {
-		d_buffers.push_back((double*)volk_malloc(d_buffer_size*sizeof(double),
-							 volk_get_alignment()));
-		memset(d_buffers[n], 0, d_buffer_size*sizeof(double));
-
 		d_fbuffers.push_back((float*)volk_malloc(d_buffer_size*sizeof(float),
 							 volk_get_alignment()));
 		memset(d_fbuffers[n], 0, d_buffer_size*sizeof(float));
@@ -101,6 +97,8 @@ scope_sink_f_impl::scope_sink_f_impl(int size, double samp_rate,
 
 	d_tags = std::vector< std::vector<gr::tag_t> >(d_nconnections);
 
+	d_frame_pool = SampleFramePool<float>::make();
+
 	initialize();
 	this->plot = plot;
 
@@ -118,7 +116,6 @@ scope_sink_f_impl::scope_sink_f_impl(int size, double samp_rate,
 scope_sink_f_impl::~scope_sink_f_impl()
 {
 	for(int n = 0; n < d_nconnections; n++) {
-		volk_free(d_buffers[n]);
 		volk_free(d_fbuffers[n]);
 	}
 }
@@ -181,11 +178,6 @@ scope_sink_f_impl::set_nsamps(const int newsize)
 
 		// Resize buffers and replace data
 		for(int n = 0; n < d_nconnections; n++) {
-			volk_free(d_buffers[n]);
-			d_buffers[n] = (double*)volk_malloc(d_buffer_size*sizeof(double),
-							    volk_get_alignment());
-			memset(d_buffers[n], 0, d_buffer_size*sizeof(double));
-
 			volk_free(d_fbuffers[n]);
 			d_fbuffers[n] = (float*)volk_malloc(d_buffer_size*sizeof(float),
 							    volk_get_alignment());
@@ -300,11 +292,6 @@ scope_sink_f_impl::clean_buffers()
 
 	// Resize buffers and replace data
 	for(int n = 0; n < d_nconnections; n++) {
-		volk_free(d_buffers[n]);
-		d_buffers[n] = (double*)volk_malloc(d_buffer_size*sizeof(double),
-						    volk_get_alignment());
-		memset(d_buffers[n], 0, d_buffer_size*sizeof(double));
-
 		volk_free(d_fbuffers[n]);
 		d_fbuffers[n] = (float*)volk_malloc(d_buffer_size*sizeof(float),
 						    volk_get_alignment());
@@ -346,8 +333,6 @@ scope_sink_f_impl::work(int noutput_items,
 	for(n = 0; n < d_nconnections; n++) {
 		in = (const float*)input_items[idx];
 		memcpy(&d_fbuffers[n][d_index], &in[0], nitems*sizeof(float));
-		volk_32f_convert_64f(&d_buffers[n][d_index],
-				     &in[1], nitems);
 
 		uint64_t nr = nitems_read(idx);
 		std::vector<gr::tag_t> tags;
@@ -363,20 +348,14 @@ scope_sink_f_impl::work(int noutput_items,
 	// If we've have a full d_size of items in the buffers, plot.
 	if((d_end != 0 && !d_displayOneBuffer) ||
 			((d_triggered) && (d_index == d_end) && d_end != 0 && d_displayOneBuffer)) {
-		// Copy data to be plotted to start of buffers.
-		for(n = 0; n < d_nconnections; n++) {
-			if (!d_displayOneBuffer) {
-				nItemsToSend = d_index;
-				if (nItemsToSend >= d_size) {
-					nItemsToSend = d_size;
-					d_cleanBuffers = false;
-				}
-				volk_32f_convert_64f(d_buffers[n], &d_fbuffers[n][d_start], nItemsToSend);
-			} else {
-				//memmove(d_buffers[n], &d_buffers[n][d_start], d_size*sizeof(double));
-				volk_32f_convert_64f(d_buffers[n], &d_fbuffers[n][d_start], d_size);
+		if (!d_displayOneBuffer) {
+			nItemsToSend = d_index;
+			if (nItemsToSend >= d_size) {
 				nItemsToSend = d_size;
+				d_cleanBuffers = false;
 			}
+		} else {
+			nItemsToSend = d_size;
 		}
 
 		// Plot if we are able to update
@@ -384,9 +363,19 @@ scope_sink_f_impl::work(int noutput_items,
 				|| !d_cleanBuffers) {
 			d_last_time = gr::high_res_timer_now();
 			if (d_qApplication) {
+				// Copy into a recycled frame which is then
+				// handed over to the plot as it is
+				SampleFrame<float>::sptr frame =
+						d_frame_pool->acquire(d_nconnections,
+								      nItemsToSend);
+				for(n = 0; n < d_nconnections; n++) {
+					memcpy(frame->channel(n),
+					       &d_fbuffers[n][d_start],
+					       nItemsToSend*sizeof(float));
+				}
+
 				d_qApplication->postEvent(this->plot,
-							  new IdentifiableTimeUpdateEvent(d_buffers,
-											  nItemsToSend,
+							  new IdentifiableTimeUpdateEvent(frame,
 											  d_tags,
 											  d_name));
 			}
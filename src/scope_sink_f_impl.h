@@ -47,6 +47,7 @@
 #include "scope_sink_f.h"
 #include "TimeDomainDisplayPlot.h"
 #include "FftDisplayPlot.h"
+#include "sample_frame.h"
 
 namespace adiscope {
 
@@ -62,7 +63,7 @@ namespace adiscope {
 
       int d_index, d_start, d_end;
       std::vector<float*> d_fbuffers;
-      std::vector<double*> d_buffers;
+      SampleFramePool<float>::sptr d_frame_pool;
       std::vector< std::vector<gr::tag_t> > d_tags;
 
       QObject *plot;
@@ -21,11 +21,13 @@
 #include "logging_categories.h"
 #include "gui/dynamicWidget.hpp"
 #include "signal_generator.hpp"
+#include "spectrumUpdateEvents.h"
 #include "gui/spinbox_a.hpp"
 #include "ui_signal_generator.h"
 #include "gui/channel_widget.hpp"
 
 #include <cmath>
+#include <memory>
 
 #include <QBrush>
 #include <QFileDialog>
@@ -34,6 +36,9 @@
 #include <QSharedPointer>
 #include <QElapsedTimer>
 #include <QDockWidget>
+#include <QDataStream>
+#include <QTimer>
+#include <QtConcurrentRun>
 
 #include <gnuradio/analog/sig_source.h>
 #include <gnuradio/analog/sig_source_waveform.h>
@@ -85,6 +90,9 @@
 #define MULTIPLY_CT	4
 #define FREQUENCY_CT	40
 
+#define PREVIEW_COALESCE_MS	15
+#define OUTPUT_SETTLE_MS	250
+
 
 using namespace adiscope;
 using namespace gr;
@@ -138,7 +146,9 @@ SignalGenerator::SignalGenerator(struct iio_context *_ctx, Filter *filt,
 	currentChannel(0), sample_rate(0),
 	settings_group(new QButtonGroup(this)),nb_points(NB_POINTS),
 	channels_group(new QButtonGroup(this)),
-	m_maxNbOfSamples(4 * 1024 * 1024)
+	m_maxNbOfSamples(4 * 1024 * 1024),
+	m_previewQueued(false),
+	m_previewLatency(0)
 {
 	zoomT1=0;
 	zoomT2=1;
@@ -148,6 +158,20 @@ SignalGenerator::SignalGenerator(struct iio_context *_ctx, Filter *filt,
 
 	this->m_plot = new CapturePlot(this, false, 10, 10 , new TimePrefixFormatter, new MetricPrefixFormatter);
 
+	/* Changes in a quick succession share a preview, and the output is
+	 * pushed again only once they stop coming */
+	m_previewTimer = new QTimer(this);
+	m_previewTimer->setSingleShot(true);
+	m_previewTimer->setInterval(PREVIEW_COALESCE_MS);
+	connect(m_previewTimer, SIGNAL(timeout()), this, SLOT(startPreview()));
+
+	m_outputTimer = new QTimer(this);
+	m_outputTimer->setSingleShot(true);
+	m_outputTimer->setInterval(OUTPUT_SETTLE_MS);
+	connect(m_outputTimer, SIGNAL(timeout()), this, SLOT(restartOutput()));
+
+	connect(&m_previewWatcher, SIGNAL(finished()), this, SLOT(previewFinished()));
+
 	QVector<struct iio_channel *> iio_channels;
 
 	for (size_t i = 0; i < m_m2k_analogout->getNbChannels(); i++) {
@@ -631,6 +655,9 @@ SignalGenerator::SignalGenerator(struct iio_context *_ctx, Filter *filt,
 SignalGenerator::~SignalGenerator()
 {
 	disconnect(prefPanel, &Preferences::notify, this, &SignalGenerator::readPreferences);
+	m_previewTimer->stop();
+	m_outputTimer->stop();
+	m_previewWatcher.waitForFinished();
 	ui->run_button->toggle(false);	
 	setDynamicProperty(runButton(), "disabled", false);
 	if (saveOnExit) {
@@ -1130,49 +1157,375 @@ void SignalGenerator::tabChanged(int index)
 	}
 }
 
+double SignalGenerator::previewLatency() const
+{
+	return m_previewLatency;
+}
+
 void SignalGenerator::updatePreview()
 {
-	static const float MAX_PREVIEW_RANGE = AMPLITUDE_VOLTS;
-	static const float MIN_PREVIEW_RANGE = -AMPLITUDE_VOLTS;
+	// The latency is counted from the first change the preview does not
+	// show yet
+	if (!m_changeTimer.isValid()) {
+		m_changeTimer.start();
+	}
+
+	if (!m_previewTimer->isActive()) {
+		m_previewTimer->start();
+	}
+
+	if (!ui->run_button->runButtonChecked()) {
+		return;
+	}
 
-	const int nb_points_correction = 16; // generate slightly more points to avoid incomplete scope_sink_f buffer
-	gr::top_block_sptr top = make_top_block("Signal Generator Update");
-	unsigned int i = 0;
 	bool enabled = false;
 
-	time_block_data->time_block->reset();
-	for (auto it = channels.begin(); it != channels.end(); ++it) {
-		basic_block_sptr source;
+	for (auto chn : channels) {
+		enabled = enabled || chn->enableButton()->isChecked();
+	}
 
-		if ((*it)->enableButton()->isChecked()) {
+	if (enabled) {
+		m_outputTimer->start();
+	} else {
+		m_outputTimer->stop();
+		ui->run_button->toggle(false);
+	}
+}
 
-			source = getSource((*it), sample_rate, top, true);
-			enabled = true;
-		} else {
-			source = blocks::nop::make(sizeof(float));
+void SignalGenerator::startPreview()
+{
+	// One preview is rendered at a time, the changes made in the meantime
+	// are shown by the next one
+	if (m_previewWatcher.isRunning()) {
+		m_previewQueued = true;
+		return;
+	}
+
+	const unsigned long nb_channels = time_block_data->nb_channels;
+	QVector<PreviewChannel> chns(nb_channels);
+	QByteArray window;
+
+	QDataStream(&window, QIODevice::WriteOnly) << zoomT1OnScreen
+		<< sample_rate << quint64(nb_points);
+
+	m_previewKeys.resize(nb_channels);
+
+	for (unsigned int i = 0; i < nb_channels; i++) {
+		PreviewChannel &chn = chns[i];
+
+		chn.rate = -1;
+		chn.samples_count = 0;
+
+		if (channels[i]->enableButton()->isChecked()) {
+			chn.rate = get_best_sample_rate(i);
 		}
 
-		auto head = blocks::head::make(sizeof(float), nb_points + nb_points_correction);
-		auto clamp = analog::rail_ff::make(MIN_PREVIEW_RANGE, MAX_PREVIEW_RANGE); // prevent plotting infinite values
-		top->connect(source, 0, clamp, 0);
-		top->connect(clamp, 0, head ,0);
-		top->connect(head, 0, time_block_data->time_block, i++);
+		if (chn.rate > 0) {
+			chn.samples_count = get_samples_count(i, chn.rate);
+			chn.key = cycleKey(i, chn.rate, chn.samples_count);
+		}
+
+		// A channel is drawn again only when it or the window changed
+		const QByteArray shown = window + chn.key;
+
+		chn.redraw = !m_previewFrame || m_previewKeys[i] != shown;
+		m_previewKeys[i] = shown;
+
+		if (!chn.redraw || chn.rate <= 0) {
+			continue;
+		}
+
+		chn.cycle = m_waveformCache.find(chn.key);
+
+		if (!chn.cycle) {
+			chn.data = QSharedPointer<signal_generator_data>::create(
+					*getData(channels[i]));
+		}
 	}
 
-	QElapsedTimer timer;
-	timer.start();
+	m_renderTimer = m_changeTimer;
+	m_changeTimer.invalidate();
 
-	top->run();
-	top->disconnect_all();
+	m_previewWatcher.setFuture(QtConcurrent::run(this,
+		&SignalGenerator::renderPreviewFrame, chns, m_previewFrame,
+		zoomT1OnScreen, sample_rate, nb_points));
+}
+
+SampleFrame<float>::sptr SignalGenerator::renderPreviewFrame(
+		QVector<PreviewChannel> chns, SampleFrame<float>::sptr previous,
+		double t1, double rate, unsigned long points)
+{
+	auto frame = SampleFrame<float>::make(chns.size(), points);
+
+	for (int i = 0; i < chns.size(); i++) {
+		PreviewChannel &chn = chns[i];
+		float *out = frame->channel(i);
+
+		if (!chn.redraw) {
+			const float *in = previous->channel(i);
+
+			std::copy(in, in + points, out);
+			continue;
+		}
+
+		if (chn.rate <= 0) {
+			std::fill(out, out + points, 0.0f);
+			continue;
+		}
+
+		if (!chn.cycle) {
+			chn.cycle = makeCycle(*chn.data, chn.rate, chn.samples_count);
+			m_waveformCache.insert(chn.key, chn.cycle);
+		}
+
+		renderPreview(*chn.cycle, t1, rate, points, out);
+	}
+
+	return frame;
+}
+
+void SignalGenerator::previewFinished()
+{
+	// The preview is drawn from the same cycles that are pushed to the
+	// DAC, so it shows the samples the channels play
+	m_previewFrame = m_previewWatcher.result();
+
+	QCoreApplication::postEvent(m_plot, new IdentifiableTimeUpdateEvent(
+		m_previewFrame,
+		std::vector<std::vector<gr::tag_t>>(m_previewFrame->numChannels()),
+		time_block_data->time_block->name()));
+
+	if (m_renderTimer.isValid()) {
+		m_previewLatency = m_renderTimer.nsecsElapsed() / 1e6;
+		m_renderTimer.invalidate();
+
+		qDebug(CAT_SIGNAL_GENERATOR) << "Preview updated" << m_previewLatency
+					     << "ms after the change";
+	}
+
+	if (m_previewQueued) {
+		m_previewQueued = false;
+		startPreview();
+	}
+}
+
+void SignalGenerator::restartOutput()
+{
+	if (!ui->run_button->runButtonChecked()) {
+		return;
+	}
+
+	// The output is made of the cycles the preview is still making
+	if (m_previewWatcher.isRunning() || m_previewQueued ||
+			m_previewTimer->isActive()) {
+		m_outputTimer->start();
+		return;
+	}
+
+	stop();
+	start();
+}
+
+void SignalGenerator::renderPreview(const SynthesizedCycle &cycle, double t1,
+				    double rate, unsigned long points, float *out)
+{
+	const size_t size = cycle.samples.size();
+
+	if (!size) {
+		std::fill(out, out + points, 0.0f);
+		return;
+	}
+
+	// The first point is at the left edge of the plot, which is that
+	// far into the cycle as it repeats
+	const double step = cycle.rate / rate;
+	double start = std::fmod(t1 * cycle.rate, (double)size);
+
+	if (start < 0) {
+		start += size;
+	}
+
+	for (unsigned long n = 0; n < points; n++) {
+		const double pos = std::fmod(start + n * step, (double)size);
+		const size_t idx = pos;
+		double value = cycle.samples[idx];
+
+		if (cycle.smooth) {
+			value += (pos - idx) * (cycle.samples[(idx + 1) % size] - value);
+		}
+
+		// prevent plotting infinite values
+		out[n] = std::max(-AMPLITUDE_VOLTS, std::min(AMPLITUDE_VOLTS, value));
+	}
+}
+
+QByteArray SignalGenerator::cycleKey(unsigned int chnIdx, double rate,
+				     size_t samples_count)
+{
+	auto ptr = getData(channels[chnIdx]);
+	QByteArray key;
+	QDataStream stream(&key, QIODevice::WriteOnly);
+
+	// The channel is part of the key so that each one has its own noise
+	stream << chnIdx << rate << quint64(samples_count) << ptr->load
+	       << int(ptr->type) << int(ptr->noiseType) << ptr->noiseAmplitude;
+
+	switch (ptr->type) {
+	case SIGNAL_TYPE_CONSTANT:
+		stream << ptr->constant;
+		break;
+
+	case SIGNAL_TYPE_WAVEFORM:
+		stream << int(ptr->waveform) << ptr->amplitude << ptr->offset
+		       << ptr->frequency << ptr->phase << ptr->dutycycle
+		       << ptr->rise << ptr->holdh << ptr->fall << ptr->holdl
+		       << ptr->steps_up << ptr->steps_down << ptr->stairphase;
+		break;
+
+	case SIGNAL_TYPE_BUFFER:
+		stream << ptr->file << int(ptr->file_type)
+		       << quint64(ptr->file_channel) << ptr->file_sr
+		       << ptr->file_amplitude << ptr->file_offset
+		       << quint64(ptr->file_phase) << quint64(ptr->file_data.size());
+		break;
+
+	case SIGNAL_TYPE_MATH:
+		stream << ptr->function << ptr->math_record_length << ptr->math_sr;
+		break;
+
+	default:
+		break;
+	}
+
+	return key;
+}
+
+WaveformCache::cycle_sptr SignalGenerator::getCycle(unsigned int chnIdx, double rate)
+{
+	const size_t samples_count = get_samples_count(chnIdx, rate);
+	const QByteArray key = cycleKey(chnIdx, rate, samples_count);
+
+	WaveformCache::cycle_sptr cycle = m_waveformCache.find(key);
+
+	if (!cycle) {
+		cycle = makeCycle(*getData(channels[chnIdx]), rate, samples_count);
+		m_waveformCache.insert(key, cycle);
+	}
+
+	return cycle;
+}
+
+WaveformCache::cycle_sptr SignalGenerator::makeCycle(signal_generator_data &data,
+						     double rate, size_t samples_count)
+{
+	auto made = std::make_shared<SynthesizedCycle>();
+
+	made->rate = rate;
+	made->smooth = data.type == SIGNAL_TYPE_WAVEFORM &&
+		data.waveform == SG_SIN_WAVE;
+	made->samples.resize(samples_count);
+
+	if (!synthesizeCycle(data, rate, made->samples)) {
+		made->samples = runSource(data, rate, samples_count);
+	}
+
+	auto load = data.load;
+	auto scaling_factor = ((load + ExternalLoadLineEdit::OUTPUT_AWG_RESISTANCE) / load);
+
+	made->output.resize(made->samples.size());
+	synth::scaleAndClamp(made->samples.data(), made->output.data(),
+			     made->samples.size(), scaling_factor, AMPLITUDE_VOLTS);
+
+	return made;
+}
+
+bool SignalGenerator::synthesizeCycle(const signal_generator_data &data,
+				      double rate, std::vector<double> &samples)
+{
+	switch (data.type) {
+	case SIGNAL_TYPE_CONSTANT:
+		std::fill(samples.begin(), samples.end(), data.constant);
+		break;
 
-	if (ui->run_button->runButtonChecked()) {
-		if (enabled) {
-			stop();
-			start();
+	case SIGNAL_TYPE_WAVEFORM:
+		if (data.waveform == SG_SIN_WAVE) {
+			double phase = data.phase < 0 ? data.phase + 360.0 : data.phase;
+
+			synth::sine(samples.data(), samples.size(),
+				    2.0 * M_PI * data.frequency / rate,
+				    phase * 0.01745329, data.amplitude / 2.0,
+				    data.offset);
+		} else if (data.waveform == SG_STAIR_WAVE) {
+			auto stair = get_stairstep(data.steps_up, data.steps_down,
+						   data.amplitude / 2.0, data.offset,
+						   data.stairphase);
+
+			synth::repeat(samples.data(), samples.size(), stair, 0, 1.0, 0.0);
 		} else {
-			ui->run_button->toggle(false);
+			// The trapezoidal waveforms come from their GNU Radio block
+			return false;
+		}
+		break;
+
+	case SIGNAL_TYPE_BUFFER:
+		// Only the files read into memory; the others are streamed
+		if (data.file_type != FORMAT_CSV || data.file_data.empty()) {
+			return false;
+		}
+
+		synth::repeat(samples.data(), samples.size(), data.file_data,
+			      data.file_phase, data.file_amplitude, data.file_offset);
+		break;
+
+	default:
+		return false;
+	}
+
+	if ((int)data.noiseType != 0) {
+		float amplitude = data.noiseAmplitude / 2;
+		double divider = 1;
+
+		// As in getNoise()
+		switch (data.noiseType) {
+		case analog::GR_IMPULSE:
+			amplitude = data.noiseAmplitude;
+			divider = 15;
+			break;
+		case analog::GR_GAUSSIAN:
+			divider = 7;
+			break;
+		case analog::GR_UNIFORM:
+			divider = 2;
+			break;
+		case analog::GR_LAPLACIAN:
+			divider = 14;
+			break;
+		default:
+			break;
 		}
+
+		synth::addNoise(samples.data(), samples.size(), data.noiseType,
+				data.noiseAmplitude / divider, amplitude, rand());
 	}
+
+	return true;
+}
+
+std::vector<double> SignalGenerator::runSource(signal_generator_data &data,
+					       double rate, size_t samples_count)
+{
+	gr::top_block_sptr top = gr::make_top_block("Signal Generator");
+	auto source = getSource(data, rate, top);
+	auto head = blocks::head::make(sizeof(float), samples_count);
+	auto vector = blocks::vector_sink_f::make();
+
+	top->connect(source, 0, head, 0);
+	top->connect(head, 0, vector, 0);
+	top->run();
+
+	const std::vector<float>& f_samples = vector->data();
+
+	return std::vector<double>(f_samples.begin(), f_samples.end());
 }
 
 enum sg_file_format SignalGenerator::getFileFormat(QString filePath)
@@ -1194,7 +1547,7 @@ enum sg_file_format SignalGenerator::getFileFormat(QString filePath)
 		return FORMAT_WAVE;
 	}
 
-	if (filePath.endsWith(".csv")||filePath.endsWith(".txt")) {
+	if (filePath.endsWith(".csv")||filePath.endsWith(".txt")||filePath.endsWith(".scb")) {
 		return FORMAT_CSV;
 	}
 
@@ -1381,6 +1734,11 @@ void SignalGenerator::reloadFileFromPath()
 void SignalGenerator::loadFileFromPath(QString filename){
     auto ptr = getCurrentData();
 
+    // The file may have changed since its cycles were made
+    m_previewWatcher.waitForFinished();
+    m_waveformCache.clear();
+    m_previewKeys.clear();
+
     ptr->file = filename;
     ui->label_path->setText(ptr->file);
     Util::setWidgetNrOfChars(ui->label_path,10,30);
@@ -1426,6 +1784,7 @@ void SignalGenerator::loadFile()
 	QString fileName = QFileDialog::getOpenFileName(this,
 	    tr("Open File"), "", tr("Comma-separated values files (*.csv);;"
 				    "Tab-delimited values files (*.txt);;"
+				    "Scopy binary files (*.scb);;"
 				    "Waveform Audio File Format (*.wav);;"
 				    "Matlab files (*.mat)"),
 	    nullptr, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
@@ -1472,39 +1831,18 @@ void SignalGenerator::start()
 			continue;
 		}
 
-		top_block = gr::make_top_block("Signal Generator");
 		double best_rate = get_best_sample_rate(i);
 
 		/* Do not generate anything if samplerate can't be determined */
 		if (best_rate <= 0) {
 			continue;
 		}
-		size_t samples_count = get_samples_count(i, best_rate);
 
 		calc_sampling_params(i, best_rate, final_rate,
 				     oversampling);
 
-		QWidget* w = channels[i];
-		auto source = getSource(w, best_rate, top_block);
-		auto head = blocks::head::make(sizeof(float), samples_count);
-		auto vector = blocks::vector_sink_f::make();
-
-		auto load = getData(w)->load;
-		auto scaling_factor = ((load + ExternalLoadLineEdit::OUTPUT_AWG_RESISTANCE) / load);
-		auto load_scaling = blocks::multiply_const_ff::make(scaling_factor);
-
-		auto clamp = analog::rail_ff::make(-AMPLITUDE_VOLTS, AMPLITUDE_VOLTS);
-
-		top_block->connect(source, 0, load_scaling, 0);
-		top_block->connect(load_scaling, 0,clamp,0);
-		top_block->connect(clamp,0, head,0);
-		top_block->connect(head, 0, vector, 0);
-		top_block->run();
-
-		const std::vector<float>& f_samples = vector->data();
-		std::vector<double> samples(f_samples.begin(), f_samples.end());
-
-		buffers.at(i) = samples;
+		/* Generated only when the parameters of the channel changed */
+		buffers.at(i) = getCycle(i, best_rate)->output;
 
 		m_m2k_analogout->setOversamplingRatio(i, oversampling);
 		m_m2k_analogout->setSampleRate(i, final_rate);
@@ -1705,9 +2043,10 @@ void SignalGenerator::loadFileChannelData(int chIdx)
 	}
 }
 
-gr::basic_block_sptr SignalGenerator::getNoise(QWidget *obj, gr::top_block_sptr top)
+gr::basic_block_sptr SignalGenerator::getNoise(const signal_generator_data &data,
+					       gr::top_block_sptr top)
 {
-	auto ptr = getData(obj);
+	auto ptr = &data;
 	auto noiseaAmpl = ptr->noiseAmplitude/2;
 	if((int)ptr->noiseType != 0)
 	{
@@ -1744,51 +2083,14 @@ gr::basic_block_sptr SignalGenerator::getNoise(QWidget *obj, gr::top_block_sptr
 	}
 }
 
-gr::basic_block_sptr SignalGenerator::displayResampler(double samp_rate,
-						       double freq,
-						       gr::top_block_sptr top,
-						       gr::basic_block_sptr generated_wave,
-						       gr::basic_block_sptr noiseSrc,
-						       gr::basic_block_sptr noiseAdd
-						       )
-{
-	auto ratio = samp_rate/freq;
-	long m,n;
-	bool ok=false;
-	for(auto precision = 128;precision > 8 ;precision>>=1)
-	{
-		reduceFraction(ratio,&m,&n,precision);
-		if(m!=0 && n!=0)
-		{
-			ok=true;
-			break;
-		}
-	}
-	ok = true;
-	if(!ok)
-	{
-		return blocks::nop::make(sizeof(float));
-	}
-
-
-	auto interp= blocks::repeat::make(sizeof(float),m);
-	auto decim=blocks::keep_one_in_n::make(sizeof(float),n);
-
-	top->connect(noiseSrc,0,noiseAdd,0);
-	top->connect(generated_wave,0,noiseAdd,1);
-	top->connect(noiseAdd,0,interp,0);
-	top->connect(interp,0,decim,0);
-	return decim;
-}
-
-gr::basic_block_sptr SignalGenerator::getSource(QWidget *obj,
-		double samp_rate, gr::top_block_sptr top, bool preview)
+gr::basic_block_sptr SignalGenerator::getSource(signal_generator_data &data,
+		double samp_rate, gr::top_block_sptr top)
 {
-	auto ptr = getData(obj);
+	auto ptr = &data;
 	enum SIGNAL_TYPE type = ptr->type;
 	double phase=0.0;
 
-	auto noiseSrc = getNoise(obj, top);
+	auto noiseSrc = getNoise(data, top);
 	auto noiseAdd = blocks::add_ff::make();
 	gr::basic_block_sptr generated_wave;
 
@@ -1800,26 +2102,7 @@ gr::basic_block_sptr SignalGenerator::getSource(QWidget *obj,
 		break;
 
 	case SIGNAL_TYPE_WAVEFORM:
-		if (preview) {
-			int full_periods=(int)((double)zoomT1OnScreen*ptr->frequency);
-			double phase_in_time = zoomT1OnScreen - full_periods/ptr->frequency;
-			phase = (phase_in_time*ptr->frequency) * 360.0;
-
-			generated_wave = getSignalSource(top, samp_rate, *ptr, phase);
-
-			if(ptr->waveform!=SG_STAIR_WAVE)
-				break;
-
-			// Only for STAIR wave
-			return displayResampler(sample_rate, (ptr->frequency * (ptr->steps_up + ptr->steps_down)),
-						       top, generated_wave, noiseSrc, noiseAdd);
-
-
-		}
-		else
-		{
-			generated_wave = getSignalSource(top, samp_rate, *ptr, phase);
-		}
+		generated_wave = getSignalSource(top, samp_rate, *ptr, phase);
 		break;
 
 	case SIGNAL_TYPE_BUFFER:
@@ -1873,24 +2156,7 @@ gr::basic_block_sptr SignalGenerator::getSource(QWidget *obj,
 			auto phase_skip = blocks::skiphead::make(sizeof(float),ptr->file_phase);
 			top->connect(add,0,phase_skip,0);
 
-			if (preview) {
-				auto resamp = displayResampler(sample_rate, (ptr->file_sr),
-							       top, phase_skip, noiseSrc, noiseAdd);
-				double buffer_freq = 1;
-				if (ptr->file_nr_of_samples.size() > 0) {
-					buffer_freq = ptr->file_sr/(double)
-				                   ptr->file_nr_of_samples[ptr->file_channel];
-				}
-				int full_periods=(int)((double)zoomT1OnScreen * buffer_freq);
-				double phase_in_time = zoomT1OnScreen - (full_periods/buffer_freq);
-				unsigned long samples_to_skip = phase_in_time * samp_rate;
-				auto skip = blocks::skiphead::make(sizeof(float),samples_to_skip);
-				top->connect(resamp,0,skip,0);
-				// return before readding the noise.
-				return skip;
-			} else {
-				generated_wave = phase_skip;
-			}
+			generated_wave = phase_skip;
 		}
 		else {
 			generated_wave = blocks::nop::make(sizeof(float));
@@ -1900,32 +2166,8 @@ gr::basic_block_sptr SignalGenerator::getSource(QWidget *obj,
 	case SIGNAL_TYPE_MATH:
 		if (!ptr->function.isEmpty()) {
 			auto str = ptr->function.toStdString();
-			double math_record_freq = (1.0/ptr->math_record_length);
-
-			if (preview) {
 
-				int full_periods=(int)((double)zoomT1OnScreen * math_record_freq);
-				double phase_in_time = zoomT1OnScreen - full_periods/math_record_freq;
-				phase = (phase_in_time*math_record_freq) * 360.0;
-				uint64_t to_skip = samp_rate * phase / (math_record_freq * 360.0);
-				auto skip_head = blocks::skiphead::make(sizeof(float),(uint64_t)to_skip);
-
-				if(ptr->math_sr < samp_rate)
-				{
-					auto src = gr::scopy::iio_math_gen::make(ptr->math_sr, str, (uint64_t)ptr->math_sr * ptr->math_record_length);
-					auto resamp = displayResampler(samp_rate, ptr->math_sr, top, src, noiseSrc, noiseAdd);
-					top->connect(resamp, 0, skip_head, 0);
-					return skip_head;
-				}
-				else
-				{
-					auto src = gr::scopy::iio_math_gen::make(samp_rate, str, (uint64_t)samp_rate * ptr->math_record_length);
-					top->connect(src, 0, skip_head, 0);
-					generated_wave = skip_head;
-				}
-			} else {
-				generated_wave = gr::scopy::iio_math_gen::make(samp_rate, str, (uint64_t)samp_rate * ptr->math_record_length);
-			}
+			generated_wave = gr::scopy::iio_math_gen::make(samp_rate, str, (uint64_t)samp_rate * ptr->math_record_length);
 			break;
 		}
 
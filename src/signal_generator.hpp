@@ -26,6 +26,8 @@
 #include <gnuradio/top_block.h>
 
 #include <QButtonGroup>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QPushButton>
 #include <QTreeWidgetItem>
 #include <QSharedPointer>
@@ -39,6 +41,8 @@
 #include "scope_sink_f.h"
 #include "tool.hpp"
 #include "filemanager.h"
+#include "waveform_synth.h"
+#include "sample_frame.h"
 
 #include "gnuradio/analog/noise_type.h"
 
@@ -58,6 +62,7 @@ class SignalGenerator;
 }
 
 class QJSEngine;
+class QTimer;
 
 namespace adiscope {
 struct signal_generator_data;
@@ -145,15 +150,39 @@ public:
 
 	void settingsLoaded();
 
+	/* Time the last preview took to show the changes it was made for, in ms */
+	double previewLatency() const;
+
 private:
+	/* What the preview of one channel is drawn from, taken on the GUI
+	 * thread so that the preview can be rendered on a worker thread */
+	struct PreviewChannel {
+		QByteArray key;
+		double rate;
+		size_t samples_count;
+		WaveformCache::cycle_sptr cycle;
+		QSharedPointer<signal_generator_data> data;
+		bool redraw;
+	};
+
 	const size_t m_maxNbOfSamples;
 	libm2k::context::M2k* m_m2k_context;
 	libm2k::analog::M2kAnalogOut* m_m2k_analogout;
 
 	Ui::SignalGenerator *ui;
 	CapturePlot *m_plot;
-	gr::top_block_sptr top_block;
 	struct time_block_data *time_block_data;
+	WaveformCache m_waveformCache;
+
+	QTimer *m_previewTimer;
+	QTimer *m_outputTimer;
+	QFutureWatcher<SampleFrame<float>::sptr> m_previewWatcher;
+	QElapsedTimer m_changeTimer;
+	QElapsedTimer m_renderTimer;
+	bool m_previewQueued;
+	double m_previewLatency;
+	SampleFrame<float>::sptr m_previewFrame;
+	QVector<QByteArray> m_previewKeys;
 
 	PhaseSpinButton *phase;
 	PositionSpinButton  *filePhase, *stairPhase;
@@ -188,7 +217,14 @@ private:
 	void start();	
 	void resetZoom();
 
+	/* Schedules a new preview and, when running, a new output buffer */
 	void updatePreview();
+	SampleFrame<float>::sptr renderPreviewFrame(QVector<PreviewChannel> chns,
+						    SampleFrame<float>::sptr previous,
+						    double t1, double rate,
+						    unsigned long points);
+	static void renderPreview(const SynthesizedCycle &cycle, double t1,
+				  double rate, unsigned long points, float *out);
 	void updateRightMenuForChn(int chIdx);
 	void updateAndToggleMenu(int chIdx, bool open);
 	void triggerRightMenuToggle(int chIdx, bool checked);
@@ -200,16 +236,22 @@ private:
 		double sample_rate,
 	        struct signal_generator_data& data, double phase_correction=0.0);
 
-	gr::basic_block_sptr getNoise(QWidget *obj,gr::top_block_sptr top);
-	gr::basic_block_sptr getSource(QWidget *obj,
+	gr::basic_block_sptr getNoise(const signal_generator_data &data,
+				      gr::top_block_sptr top);
+	gr::basic_block_sptr getSource(signal_generator_data &data,
 				       double sample_rate,
-	                               gr::top_block_sptr top, bool     phase_correction=false);
-	gr::basic_block_sptr displayResampler(double samp_rate,
-					      double freq,
-					      gr::top_block_sptr top,
-					      gr::basic_block_sptr generated_wave,
-					      gr::basic_block_sptr noiseSrc,
-					      gr::basic_block_sptr noiseAdd);
+	                               gr::top_block_sptr top);
+
+	/* The cycle a channel plays at the given rate, made only when it is
+	 * not in the cache yet */
+	WaveformCache::cycle_sptr getCycle(unsigned int chnIdx, double rate);
+	QByteArray cycleKey(unsigned int chnIdx, double rate, size_t samples_count);
+	WaveformCache::cycle_sptr makeCycle(signal_generator_data &data,
+					    double rate, size_t samples_count);
+	bool synthesizeCycle(const signal_generator_data &data, double rate,
+			     std::vector<double> &samples);
+	std::vector<double> runSource(signal_generator_data &data, double rate,
+				      size_t samples_count);
 
 	static void reduceFraction(double input,long *numerator, long *denominator, long precision=1000000);
 	static size_t gcd(size_t a, size_t b);
@@ -286,6 +328,9 @@ private Q_SLOTS:
 	void rightMenuFinished(bool opened);
 	void loadFile();
 	void rescale();
+	void startPreview();
+	void previewFinished();
+	void restartOutput();
 
 	void startStop(bool start);
 	void setFunction(const QString& function);
@@ -38,6 +38,11 @@ void SignalGenerator_API::run(bool en)
 	gen->ui->run_button->toggle(en);
 }
 
+double SignalGenerator_API::getPreviewLatency() const
+{
+	return gen->previewLatency();
+}
+
 QList<int> SignalGenerator_API::getMode() const
 {
 	QList<int> list;
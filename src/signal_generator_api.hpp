@@ -95,12 +95,15 @@ class SignalGenerator_API : public ApiObject
 
 	Q_PROPERTY(bool autoscale READ getAutoscale WRITE setAutoscale);
 	Q_PROPERTY(QList<double> load READ getLoad WRITE setLoad);
+	Q_PROPERTY(double preview_latency READ getPreviewLatency STORED false);
 
 
 public:
 	bool running() const;
 	void run(bool en);
 
+	double getPreviewLatency() const;
+
 	QList<int> getMode() const;
 	void setMode(const QList<int>& list);
 
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * Four doubles processed at once, written with the GCC vector extensions
+ * (also understood by clang). The compiler maps them onto whatever vector
+ * unit the target has: two SSE2 registers, one AVX register or NEON pairs.
+ *
+ * Comparisons give a v4di mask with all bits set in the lanes where they
+ * hold; NaN compares false.
+ */
+
+namespace adiscope {
+namespace simd {
+
+typedef double v4df __attribute__((vector_size(4 * sizeof(double))));
+typedef int64_t v4di __attribute__((vector_size(4 * sizeof(int64_t))));
+
+static const unsigned int LANES = 4;
+
+inline v4df load(const double *src)
+{
+	v4df v;
+	std::memcpy(&v, src, sizeof(v));
+	return v;
+}
+
+inline void store(double *dst, v4df v)
+{
+	std::memcpy(dst, &v, sizeof(v));
+}
+
+inline v4df broadcast(double value)
+{
+	v4df v = { value, value, value, value };
+	return v;
+}
+
+/* Lanes of a where the mask is set, lanes of b elsewhere */
+inline v4df select(v4di mask, v4df a, v4df b)
+{
+	return (v4df)(((v4di)a & mask) | ((v4di)b & ~mask));
+}
+
+inline v4df max(v4df a, v4df b)
+{
+	return select((v4di)(a > b), a, b);
+}
+
+inline v4df min(v4df a, v4df b)
+{
+	return select((v4di)(a < b), a, b);
+}
+
+inline v4df sqrt(v4df v)
+{
+	v4df r = { std::sqrt(v[0]), std::sqrt(v[1]), std::sqrt(v[2]), std::sqrt(v[3]) };
+	return r;
+}
+
+/* Scalar versions, so that kernels can be written once for both */
+inline double max(double a, double b)
+{
+	return (a > b) ? a : b;
+}
+
+inline double min(double a, double b)
+{
+	return (a < b) ? a : b;
+}
+
+inline double sqrt(double v)
+{
+	return std::sqrt(v);
+}
+
+inline bool any(v4di mask)
+{
+	return (mask[0] | mask[1] | mask[2] | mask[3]) != 0;
+}
+
+/*
+ * Base 10 logarithm, within 4 ulp of std::log10. The exponent is taken
+ * from the bits and the logarithm of the mantissa, centred on 1, from the
+ * atanh series. Zero, negative, subnormal, infinite and NaN lanes are
+ * left to std::log10.
+ */
+inline v4df log10(v4df x)
+{
+	const v4di bits = (v4di)x;
+	v4di exponent = ((bits >> 52) & 0x7ff) - 1023;
+	v4df m = (v4df)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+
+	// Mantissa in [sqrt(1/2), sqrt(2)); the mask is -1 where it is moved
+	const v4di high = (v4di)(m > M_SQRT2);
+	m = select(high, m * 0.5, m);
+	exponent -= high;
+
+	// ln(m) = 2 * atanh(s), |s| <= 0.172
+	const v4df s = (m - 1.0) / (m + 1.0);
+	const v4df s2 = s * s;
+	v4df p = broadcast(1.0 / 21);
+
+	p = p * s2 + 1.0 / 19;
+	p = p * s2 + 1.0 / 17;
+	p = p * s2 + 1.0 / 15;
+	p = p * s2 + 1.0 / 13;
+	p = p * s2 + 1.0 / 11;
+	p = p * s2 + 1.0 / 9;
+	p = p * s2 + 1.0 / 7;
+	p = p * s2 + 1.0 / 5;
+	p = p * s2 + 1.0 / 3;
+
+	const v4df e = { double(exponent[0]), double(exponent[1]),
+			 double(exponent[2]), double(exponent[3]) };
+	const v4df ln_m = s * 2.0 + s * 2.0 * s2 * p;
+
+	// log10(2) in two parts, the first exact when multiplied by the
+	// exponent, so that little is lost where the two terms cancel
+	const double log10_2_hi = 3.01029995663611771306e-01;
+	const double log10_2_lo = 3.69423907715893078616e-13;
+	v4df r = e * log10_2_hi + (e * log10_2_lo + ln_m * M_LOG10E);
+
+	const v4di special = (v4di)(!(x >= DBL_MIN)) | (v4di)(x > DBL_MAX);
+
+	if (any(special)) {
+		for (unsigned int i = 0; i < LANES; i++) {
+			if (special[i])
+				r[i] = std::log10(x[i]);
+		}
+	}
+
+	return r;
+}
+
+inline double log10(double v)
+{
+	return std::log10(v);
+}
+
+} // namespace simd
+} // namespace adiscope
+
+#endif // SIMD_H
@@ -23,6 +23,21 @@
 
 #include "spectrumUpdateEvents.h"
 
+using namespace adiscope;
+
+static SampleFrame<double>::sptr copyToFrame(const std::vector<double*> &points,
+					     const uint64_t numPoints)
+{
+  SampleFrame<double>::sptr frame = SampleFrame<double>::make(points.size(),
+							      numPoints);
+
+  for(size_t i = 0; i < points.size(); i++) {
+    memcpy(frame->channel(i), points[i], numPoints*sizeof(double));
+  }
+
+  return frame;
+}
+
 SpectrumUpdateEvent::SpectrumUpdateEvent(const float* fftPoints,
 					 const uint64_t numFFTDataPoints,
 					 const double* realTimeDomainPoints,
@@ -201,25 +216,16 @@ SpectrumFrequencyRangeEvent::GetStopFrequency() const
 /***************************************************************************/
 
 
-TimeUpdateEvent::TimeUpdateEvent(const std::vector<double*> &timeDomainPoints,
-				 const uint64_t numTimeDomainDataPoints,
+TimeUpdateEvent::TimeUpdateEvent(const SampleFrame<float>::sptr &frame,
 				 const std::vector< std::vector<gr::tag_t> > &tags)
-  : QEvent(QEvent::Type(SpectrumUpdateEventType))
+  : QEvent(QEvent::Type(SpectrumUpdateEventType)),
+    _frame(frame)
 {
-  if(numTimeDomainDataPoints < 1) {
+  if(frame->numPoints() < 1) {
     _numTimeDomainDataPoints = 1;
   }
   else {
-    _numTimeDomainDataPoints = numTimeDomainDataPoints;
-  }
-
-  _nplots = timeDomainPoints.size();
-  for(size_t i = 0; i < _nplots; i++) {
-    _dataTimeDomainPoints.push_back(new double[_numTimeDomainDataPoints]);
-    if(numTimeDomainDataPoints > 0) {
-      memcpy(_dataTimeDomainPoints[i], timeDomainPoints[i],
-	     _numTimeDomainDataPoints*sizeof(double));
-    }
+    _numTimeDomainDataPoints = frame->numPoints();
   }
 
   _tags = tags;
@@ -227,15 +233,18 @@ TimeUpdateEvent::TimeUpdateEvent(const std::vector<double*> &timeDomainPoints,
 
 TimeUpdateEvent::~TimeUpdateEvent()
 {
-  for(size_t i = 0; i < _nplots; i++) {
-    delete[] _dataTimeDomainPoints[i];
-  }
 }
 
-const std::vector<double*>
+const std::vector<float*> &
 TimeUpdateEvent::getTimeDomainPoints() const
 {
-  return _dataTimeDomainPoints;
+  return _frame->channels();
+}
+
+const SampleFrame<float>::sptr &
+TimeUpdateEvent::getFrame() const
+{
+  return _frame;
 }
 
 uint64_t
@@ -253,11 +262,10 @@ TimeUpdateEvent::getTags() const
 /***************************************************************************/
 
 
-IdentifiableTimeUpdateEvent::IdentifiableTimeUpdateEvent(const std::vector<double*> &timeDomainPoints,
-				 const uint64_t numTimeDomainDataPoints,
+IdentifiableTimeUpdateEvent::IdentifiableTimeUpdateEvent(const SampleFrame<float>::sptr &frame,
 				 const std::vector< std::vector<gr::tag_t> > &tags,
 				 const std::string &senderName)
-  : TimeUpdateEvent(timeDomainPoints, numTimeDomainDataPoints, tags),
+  : TimeUpdateEvent(frame, tags),
     _senderName(senderName)
 {
 }
@@ -277,36 +285,36 @@ IdentifiableTimeUpdateEvent::IdentifiableTimeUpdateEvent(const std::vector<doubl
 
 FreqUpdateEvent::FreqUpdateEvent(const std::vector<double*> &dataPoints,
 				 const uint64_t numDataPoints)
-  : QEvent(QEvent::Type(SpectrumUpdateEventType))
+  : FreqUpdateEvent(copyToFrame(dataPoints, numDataPoints))
 {
-  if(numDataPoints < 1) {
+}
+
+FreqUpdateEvent::FreqUpdateEvent(const SampleFrame<double>::sptr &frame)
+  : QEvent(QEvent::Type(SpectrumUpdateEventType)),
+    _frame(frame)
+{
+  if(frame->numPoints() < 1) {
     _numDataPoints = 1;
   }
   else {
-    _numDataPoints = numDataPoints;
-  }
-
-  _nplots = dataPoints.size();
-  for(size_t i = 0; i < _nplots; i++) {
-    _dataPoints.push_back(new double[_numDataPoints]);
-    if(numDataPoints > 0) {
-      memcpy(_dataPoints[i], dataPoints[i],
-	     _numDataPoints*sizeof(double));
-    }
+    _numDataPoints = frame->numPoints();
   }
 }
 
 FreqUpdateEvent::~FreqUpdateEvent()
 {
-  for(size_t i = 0; i < _nplots; i++) {
-    delete[] _dataPoints[i];
-  }
 }
 
-const std::vector<double*>
+const std::vector<double*> &
 FreqUpdateEvent::getPoints() const
 {
-  return _dataPoints;
+  return _frame->channels();
+}
+
+const SampleFrame<double>::sptr &
+FreqUpdateEvent::getFrame() const
+{
+  return _frame;
 }
 
 uint64_t
@@ -345,49 +353,34 @@ SetFreqEvent::getBandwidth() const
 /***************************************************************************/
 
 
-ConstUpdateEvent::ConstUpdateEvent(const std::vector<double*> &realDataPoints,
-				   const std::vector<double*> &imagDataPoints,
-				   const uint64_t numDataPoints)
-  : QEvent(QEvent::Type(SpectrumUpdateEventType))
+ConstUpdateEvent::ConstUpdateEvent(const SampleFrame<float>::sptr &realFrame,
+				   const SampleFrame<float>::sptr &imagFrame)
+  : QEvent(QEvent::Type(SpectrumUpdateEventType)),
+    _realFrame(realFrame),
+    _imagFrame(imagFrame)
 {
-  if(numDataPoints < 1) {
+  if(realFrame->numPoints() < 1) {
     _numDataPoints = 1;
   }
   else {
-    _numDataPoints = numDataPoints;
-  }
-
-  _nplots = realDataPoints.size();
-  for(size_t i = 0; i < _nplots; i++) {
-    _realDataPoints.push_back(new double[_numDataPoints]);
-    _imagDataPoints.push_back(new double[_numDataPoints]);
-    if(numDataPoints > 0) {
-      memcpy(_realDataPoints[i], realDataPoints[i],
-	     _numDataPoints*sizeof(double));
-      memcpy(_imagDataPoints[i], imagDataPoints[i],
-	     _numDataPoints*sizeof(double));
-    }
+    _numDataPoints = realFrame->numPoints();
   }
 }
 
 ConstUpdateEvent::~ConstUpdateEvent()
 {
-  for(size_t i = 0; i < _nplots; i++) {
-    delete[] _realDataPoints[i];
-    delete[] _imagDataPoints[i];
-  }
 }
 
-const std::vector<double*>
+const std::vector<float*> &
 ConstUpdateEvent::getRealPoints() const
 {
-  return _realDataPoints;
+  return _realFrame->channels();
 }
 
-const std::vector<double*>
+const std::vector<float*> &
 ConstUpdateEvent::getImagPoints() const
 {
-  return _imagDataPoints;
+  return _imagFrame->channels();
 }
 
 uint64_t
@@ -400,23 +393,34 @@ ConstUpdateEvent::getNumDataPoints() const
 /***************************************************************************/
 
 
-WaterfallUpdateEvent::WaterfallUpdateEvent(const std::vector<volk::vector<double>> dataPoints,
+WaterfallUpdateEvent::WaterfallUpdateEvent(const std::vector<volk::vector<double>> &dataPoints,
 					   const uint64_t numDataPoints,
 					   const gr::high_res_timer_type dataTimestamp)
   : QEvent(QEvent::Type(SpectrumUpdateEventType))
 {
-if (numDataPoints < 1) {
+    _frame = SampleFrame<double>::make(dataPoints.size(), numDataPoints);
+    for (size_t i = 0; i < dataPoints.size(); i++) {
+	memcpy(_frame->channel(i), dataPoints[i].data(), numDataPoints * sizeof(double));
+    }
+
+    if (numDataPoints < 1) {
 	_numDataPoints = 1;
     } else {
 	_numDataPoints = numDataPoints;
     }
 
-    _nplots = dataPoints.size();
-    for (size_t i = 0; i < _nplots; i++) {
-	_dataPoints.push_back(new double[_numDataPoints]);
-	if (numDataPoints > 0) {
-	    memcpy(_dataPoints[i], dataPoints[i].data(), _numDataPoints * sizeof(double));
-	}
+    _dataTimestamp = dataTimestamp;
+}
+
+WaterfallUpdateEvent::WaterfallUpdateEvent(const SampleFrame<double>::sptr &frame,
+					   const gr::high_res_timer_type dataTimestamp)
+  : QEvent(QEvent::Type(SpectrumUpdateEventType)),
+    _frame(frame)
+{
+    if (frame->numPoints() < 1) {
+	_numDataPoints = 1;
+    } else {
+	_numDataPoints = frame->numPoints();
     }
 
     _dataTimestamp = dataTimestamp;
@@ -424,15 +428,18 @@ if (numDataPoints < 1) {
 
 WaterfallUpdateEvent::~WaterfallUpdateEvent()
 {
-  for(size_t i = 0; i < _nplots; i++) {
-    delete[] _dataPoints[i];
-  }
 }
 
-const std::vector<double*>
+const std::vector<double*> &
 WaterfallUpdateEvent::getPoints() const
 {
-  return _dataPoints;
+  return _frame->channels();
+}
+
+const SampleFrame<double>::sptr &
+WaterfallUpdateEvent::getFrame() const
+{
+  return _frame;
 }
 
 uint64_t
@@ -494,37 +501,32 @@ TimeRasterUpdateEvent::getNumDataPoints() const
 /***************************************************************************/
 
 
-HistogramUpdateEvent::HistogramUpdateEvent(const std::vector<double*> &points,
-                                           const uint64_t npoints)
-  : QEvent(QEvent::Type(SpectrumUpdateEventType))
+HistogramUpdateEvent::HistogramUpdateEvent(const SampleFrame<float>::sptr &frame)
+  : QEvent(QEvent::Type(SpectrumUpdateEventType)),
+    _frame(frame)
 {
-  if(npoints < 1) {
+  if(frame->numPoints() < 1) {
     _npoints = 1;
   }
   else {
-    _npoints = npoints;
-  }
-
-  _nplots = points.size();
-  for(size_t i = 0; i < _nplots; i++) {
-    _points.push_back(new double[_npoints]);
-    if(npoints > 0) {
-      memcpy(_points[i], points[i], _npoints*sizeof(double));
-    }
+    _npoints = frame->numPoints();
   }
 }
 
 HistogramUpdateEvent::~HistogramUpdateEvent()
 {
-  for(size_t i = 0; i < _nplots; i++) {
-    delete[] _points[i];
-  }
 }
 
-const std::vector<double*>
+const std::vector<float*> &
 HistogramUpdateEvent::getDataPoints() const
 {
-  return _points;
+  return _frame->channels();
+}
+
+const SampleFrame<float>::sptr &
+HistogramUpdateEvent::getFrame() const
+{
+  return _frame;
 }
 
 uint64_t
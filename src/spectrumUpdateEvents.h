@@ -30,6 +30,8 @@
 #include <gnuradio/tags.h>
 #include <volk/volk_alloc.hh>
 
+#include "sample_frame.h"
+
 static const int SpectrumUpdateEventType = 10005;
 static const int SpectrumWindowCaptionEventType = 10008;
 static const int SpectrumWindowResetEventType = 10009;
@@ -120,17 +122,18 @@ private:
 class TimeUpdateEvent: public QEvent
 {
 public:
-  TimeUpdateEvent(const std::vector<double*> &timeDomainPoints,
-		  const uint64_t numTimeDomainDataPoints,
+  TimeUpdateEvent(const adiscope::SampleFrame<float>::sptr &frame,
 		  const std::vector< std::vector<gr::tag_t> > &tags);
 
   ~TimeUpdateEvent();
 
   int which() const;
-  const std::vector<double*> getTimeDomainPoints() const;
+  const std::vector<float*> &getTimeDomainPoints() const;
   uint64_t getNumTimeDomainDataPoints() const;
   bool getRepeatDataFlag() const;
 
+  const adiscope::SampleFrame<float>::sptr &getFrame() const;
+
   const std::vector< std::vector<gr::tag_t> > getTags() const;
 
   static QEvent::Type Type()
@@ -139,8 +142,7 @@ public:
 protected:
 
 private:
-  size_t _nplots;
-  std::vector<double*> _dataTimeDomainPoints;
+  adiscope::SampleFrame<float>::sptr _frame;
   uint64_t _numTimeDomainDataPoints;
   std::vector< std::vector<gr::tag_t> > _tags;
 };
@@ -152,8 +154,7 @@ private:
 class IdentifiableTimeUpdateEvent: public TimeUpdateEvent
 {
 public:
-  IdentifiableTimeUpdateEvent(const std::vector<double*> &timeDomainPoints,
-		  const uint64_t numTimeDomainDataPoints,
+  IdentifiableTimeUpdateEvent(const adiscope::SampleFrame<float>::sptr &frame,
 		  const std::vector< std::vector<gr::tag_t> > &tags,
 		  const std::string &senderName);
 
@@ -177,21 +178,24 @@ public:
   FreqUpdateEvent(const std::vector<double*> &dataPoints,
 		  const uint64_t numDataPoints);
 
+  FreqUpdateEvent(const adiscope::SampleFrame<double>::sptr &frame);
+
   ~FreqUpdateEvent();
 
   int which() const;
-  const std::vector<double*> getPoints() const;
+  const std::vector<double*> &getPoints() const;
   uint64_t getNumDataPoints() const;
   bool getRepeatDataFlag() const;
 
+  const adiscope::SampleFrame<double>::sptr &getFrame() const;
+
   static QEvent::Type Type()
   { return QEvent::Type(SpectrumUpdateEventType); }
 
 protected:
 
 private:
-  size_t _nplots;
-  std::vector<double*> _dataPoints;
+  adiscope::SampleFrame<double>::sptr _frame;
   uint64_t _numDataPoints;
 };
 
@@ -216,15 +220,15 @@ private:
 class ConstUpdateEvent: public QEvent
 {
 public:
-  ConstUpdateEvent(const std::vector<double*> &realDataPoints,
-		   const std::vector<double*> &imagDataPoints,
-		   const uint64_t numDataPoints);
+  /* Both frames must have the same shape */
+  ConstUpdateEvent(const adiscope::SampleFrame<float>::sptr &realFrame,
+		   const adiscope::SampleFrame<float>::sptr &imagFrame);
 
   ~ConstUpdateEvent();
 
   int which() const;
-  const std::vector<double*> getRealPoints() const;
-  const std::vector<double*> getImagPoints() const;
+  const std::vector<float*> &getRealPoints() const;
+  const std::vector<float*> &getImagPoints() const;
   uint64_t getNumDataPoints() const;
   bool getRepeatDataFlag() const;
 
@@ -234,9 +238,8 @@ public:
 protected:
 
 private:
-  size_t _nplots;
-  std::vector<double*> _realDataPoints;
-  std::vector<double*> _imagDataPoints;
+  adiscope::SampleFrame<float>::sptr _realFrame;
+  adiscope::SampleFrame<float>::sptr _imagFrame;
   uint64_t _numDataPoints;
 };
 
@@ -247,25 +250,29 @@ private:
 class WaterfallUpdateEvent : public QEvent
 {
 public:
-    WaterfallUpdateEvent(const std::vector<volk::vector<double>> dataPoints,
+    WaterfallUpdateEvent(const std::vector<volk::vector<double>> &dataPoints,
 			 const uint64_t numDataPoints,
 			 const gr::high_res_timer_type dataTimestamp);
 
+    WaterfallUpdateEvent(const adiscope::SampleFrame<double>::sptr &frame,
+			 const gr::high_res_timer_type dataTimestamp);
+
     ~WaterfallUpdateEvent() override;
 
     int which() const;
-    const std::vector<double*> getPoints() const;
+    const std::vector<double*> &getPoints() const;
     uint64_t getNumDataPoints() const;
     bool getRepeatDataFlag() const;
 
+    const adiscope::SampleFrame<double>::sptr &getFrame() const;
+
     gr::high_res_timer_type getDataTimestamp() const;
 
     static QEvent::Type Type() { return QEvent::Type(SpectrumUpdateEventType); }
 
 protected:
 private:
-    size_t _nplots;
-    std::vector<double*> _dataPoints;
+    adiscope::SampleFrame<double>::sptr _frame;
     uint64_t _numDataPoints;
 
     gr::high_res_timer_type _dataTimestamp;
@@ -304,24 +311,24 @@ private:
 class HistogramUpdateEvent: public QEvent
 {
 public:
-  HistogramUpdateEvent(const std::vector<double*> &points,
-                       const uint64_t npoints);
+  HistogramUpdateEvent(const adiscope::SampleFrame<float>::sptr &frame);
 
   ~HistogramUpdateEvent();
 
   int which() const;
-  const std::vector<double*> getDataPoints() const;
+  const std::vector<float*> &getDataPoints() const;
   uint64_t getNumDataPoints() const;
   bool getRepeatDataFlag() const;
 
+  const adiscope::SampleFrame<float>::sptr &getFrame() const;
+
   static QEvent::Type Type()
   { return QEvent::Type(SpectrumUpdateEventType); }
 
 protected:
 
 private:
-  size_t _nplots;
-  std::vector<double*> _points;
+  adiscope::SampleFrame<float>::sptr _frame;
   uint64_t _npoints;
 };
 
@@ -742,6 +742,7 @@ SpectrumAnalyzer::SpectrumAnalyzer(struct iio_context *ctx, Filter *filt,
 			QStringList filter;
 			filter += QString(tr("Comma-separated values files (*.csv)"));
 			filter += QString(tr("Tab-delimited values files (*.txt)"));
+			filter += QString(tr("Scopy binary files (*.scb)"));
 			filter += QString(tr("All Files(*)"));
 
 			QString selectedFilter = filter[0];
@@ -891,6 +892,7 @@ void SpectrumAnalyzer::btnExportClicked()
 	QStringList filter;
 	filter += QString(tr("Comma-separated values files (*.csv)"));
 	filter += QString(tr("Tab-delimited values files (*.txt)"));
+	filter += QString(tr("Scopy binary files (*.scb)"));
 	filter += QString(tr("All Files(*)"));
 
 	QString selectedFilter = filter[0];
@@ -1545,7 +1547,8 @@ void SpectrumAnalyzer::on_btnBrowseFile_clicked()
 {
 	QString fileName = QFileDialog::getOpenFileName(this,
 	    tr("Export"), "", tr("Comma-separated values files (*.csv);;"
-				       "Tab-delimited values files (*.txt)"),
+				       "Tab-delimited values files (*.txt);;"
+				       "Scopy binary files (*.scb)"),
 	    nullptr, (m_useNativeDialogs ? QFileDialog::Options() : QFileDialog::DontUseNativeDialog));
 
 	FileManager fm("Spectrum Analyzer");
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spectrum_magnitude.h"
+#include "simd.h"
+
+#include <cmath>
+
+using namespace adiscope;
+
+namespace {
+	using simd::v4df;
+
+	/* out[i] = op(in[i]), four bins at a time while there are enough */
+	template <typename Op>
+	void convertBins(const double *in, double *out, uint64_t count,
+			 const Op &op)
+	{
+		uint64_t i = 0;
+
+		for (; i + simd::LANES <= count; i += simd::LANES) {
+			simd::store(out + i, op(simd::load(in + i)));
+		}
+		for (; i < count; i++) {
+			out[i] = op(in[i]);
+		}
+	}
+
+	/* state[i] = op(in[i], state[i]), four bins at a time */
+	template <typename Op>
+	void accumulateBins(const double *in, double *state, uint64_t count,
+			    const Op &op)
+	{
+		uint64_t i = 0;
+
+		for (; i + simd::LANES <= count; i += simd::LANES) {
+			simd::store(state + i, op(simd::load(in + i),
+						  simd::load(state + i)));
+		}
+		for (; i < count; i++) {
+			state[i] = op(in[i], state[i]);
+		}
+	}
+
+	/* Power to dB: 10 * log10(p) + offset */
+	struct LogOp {
+		double offset;
+
+		explicit LogOp(double offset) : offset(offset) {}
+
+		template <typename T> T operator()(T p) const
+		{
+			return simd::log10(p) * 10.0 + offset;
+		}
+	};
+
+	/* Power to amplitude: sqrt(p) * scale */
+	struct SqrtOp {
+		double scale;
+
+		explicit SqrtOp(double scale) : scale(scale) {}
+
+		template <typename T> T operator()(T p) const
+		{
+			return simd::sqrt(p) * scale;
+		}
+	};
+
+	struct ScaleOp {
+		double scale;
+
+		explicit ScaleOp(double scale) : scale(scale) {}
+
+		template <typename T> T operator()(T v) const { return v * scale; }
+	};
+
+	/* sqrt(s^2 + p * pScale) * outScale, the RMS sum of amplitudes
+	 * that are sqrt(p * pScale) */
+	struct RootSumSquareOp {
+		double pScale;
+		double outScale;
+
+		RootSumSquareOp(double pScale, double outScale) :
+			pScale(pScale), outScale(outScale) {}
+
+		template <typename T> T operator()(T p, T s) const
+		{
+			return simd::sqrt(s * s + p * pScale) * outScale;
+		}
+	};
+}
+
+SpectrumMagnitude::SpectrumMagnitude(Type type, uint64_t nb_points,
+				     double scale_factor) :
+	m_type(type),
+	m_nb_points(nb_points),
+	m_scale_factor(scale_factor),
+	m_sample_rate(1),
+	m_win_coefficient_sum(1),
+	m_win_coefficient_sum_sqr(1)
+{
+}
+
+void SpectrumMagnitude::setDensity(double sample_rate,
+				   double win_coefficient_sum,
+				   double win_coefficient_sum_sqr)
+{
+	m_sample_rate = sample_rate;
+	m_win_coefficient_sum = win_coefficient_sum;
+	m_win_coefficient_sum_sqr = win_coefficient_sum_sqr;
+}
+
+void SpectrumMagnitude::convert(const double *in, double *out, uint64_t count,
+				double *ps_avg, unsigned int buffer_idx,
+				unsigned int nb_overlapping) const
+{
+	const double n = m_nb_points;
+
+	switch (m_type) {
+	//dB Full-Scale
+	case DBFS:
+		convertBins(in, out, count, LogOp(-20 * log10(2048 * n)));
+		break;
+	case DBV:
+		convertBins(in, out, count, LogOp(20 * log10(m_scale_factor /
+			(n * M_SQRT2))));
+		break;
+	case DBU:
+		convertBins(in, out, count, LogOp(20 * log10(m_scale_factor /
+			(n * M_SQRT2 * 0.77459667))));
+		break;
+	case VPEAK:
+		convertBins(in, out, count, SqrtOp(m_scale_factor / n));
+		break;
+	case VRMS:
+		/* Another formula for this would be
+		 * sqrt(2 * (sqrt(in[k]) * sqrt(in[k])) /
+		 * (d_win_coefficient_sum * d_win_coefficient_sum));
+		 * This are equivalent (the only difference is the moment
+		 * when we apply the window compensation (before the FFT, or after.
+		 * With the current version, this is applied before (in calcCoherentPowerGain)
+		 */
+		convertBins(in, out, count, SqrtOp(m_scale_factor / M_SQRT2 / n));
+		break;
+	case VROOTHZ: {
+		const double ps_scale = m_scale_factor / M_SQRT2 / n;
+		const bool last = buffer_idx == (nb_overlapping - 1);
+
+		// The RMS of the overlapping buffers accumulates in ps_avg
+		// and is output, as a density, once the last of them is in
+		accumulateBins(in, ps_avg, count, RootSumSquareOp(ps_scale * ps_scale,
+			last ? 1 / sqrt(nb_overlapping) : 1));
+
+		if (last) {
+			const double enbw = m_sample_rate * m_win_coefficient_sum_sqr /
+				(m_win_coefficient_sum * m_win_coefficient_sum);
+
+			convertBins(ps_avg, out, count, ScaleOp(1 / sqrt(enbw)));
+		}
+		break;
+	}
+	};
+}
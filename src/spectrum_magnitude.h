@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPECTRUM_MAGNITUDE_H
+#define SPECTRUM_MAGNITUDE_H
+
+#include <cstdint>
+
+namespace adiscope {
+
+/*
+ * Conversion of the power of FFT bins, |X[k]|^2 of an FFT of nb_points
+ * ADC codes, to the magnitude units of the spectrum analyzer.
+ */
+class SpectrumMagnitude
+{
+public:
+	enum Type {
+		DBFS = 0,
+		DBV = 1,
+		DBU = 2,
+		VPEAK = 3,
+		VRMS = 4,
+		VROOTHZ = 5
+	};
+
+	SpectrumMagnitude(Type type, uint64_t nb_points, double scale_factor);
+
+	/* Window sums and sample rate, used by the VROOTHZ density */
+	void setDensity(double sample_rate, double win_coefficient_sum,
+			double win_coefficient_sum_sqr);
+
+	/*
+	 * Converts count bins. VROOTHZ takes the RMS of the nb_overlapping
+	 * buffers of an average: ps_avg holds it for these bins between the
+	 * calls and out is only written for the last buffer, buffer_idx
+	 * nb_overlapping - 1.
+	 */
+	void convert(const double *in, double *out, uint64_t count,
+		     double *ps_avg = nullptr, unsigned int buffer_idx = 0,
+		     unsigned int nb_overlapping = 1) const;
+
+private:
+	Type m_type;
+	double m_nb_points;
+	double m_scale_factor;
+	double m_sample_rate;
+	double m_win_coefficient_sum;
+	double m_win_coefficient_sum_sqr;
+};
+
+} // namespace adiscope
+
+#endif // SPECTRUM_MAGNITUDE_H
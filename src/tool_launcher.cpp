@@ -69,6 +69,7 @@
 #include "toolmenuitem.h"
 
 #include <libsigrokdecode/libsigrokdecode.h>
+#include "logicanalyzer/decoderengine.h"
 
 #include <libm2k/m2k.hpp>
 #include <libm2k/contextbuilder.hpp>
@@ -1448,19 +1449,11 @@ void adiscope::ToolLauncher::destroyContext()
 
 bool ToolLauncher::loadDecoders(QString path)
 {
-	static bool srd_loaded = false;
-
-	if (srd_loaded) {
-		srd_exit();
-	}
-
-	if (srd_init(path.toStdString().c_str()) != SRD_OK) {
+	/* Initializes libsigrokdecode and loads the protocol decoders */
+	if (!DecoderEngine::getInstance()->load(path.toStdString())) {
 		qDebug(CAT_TOOL_LAUNCHER) << "ERROR: libsigrokdecode init failed.";
 		return false;
 	} else {
-		srd_loaded = true;
-		/* Load the protocol decoders */
-		srd_decoder_load_all();
 		auto decoder = srd_decoder_get_by_id("parallel");
 
 		if (decoder == nullptr) {
@@ -34,6 +34,8 @@
 #include "qdebug.h"
 #include <float.h>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
 
 WaterfallData::WaterfallData(const double minimumFrequency,
 			     const double maximumFrequency,
@@ -50,6 +52,7 @@ WaterfallData::WaterfallData(const double minimumFrequency,
 	  _spectrumData(fftPoints * historyExtent),
 	  _fftPoints(fftPoints),
 	  _historyLength(historyExtent),
+	  _headRow(0),
 	  flow_direction(WaterfallFlowDirection::UP),
 	  _intensityRange(QwtDoubleInterval(-200.0, 0.0))
 {
@@ -68,6 +71,7 @@ void WaterfallData::reset()
 {
 	std::fill(std::begin(_spectrumData), std::end(_spectrumData), -DBL_MAX);
 
+	_headRow = 0;
 	_numLinesToUpdate = -1;
 }
 
@@ -89,6 +93,8 @@ void WaterfallData::copy(const WaterfallData* rhs)
 
 	reset();
 	setSpectrumDataBuffer(rhs->getSpectrumDataBuffer());
+	_headRow = rhs->getHeadRow();
+	flow_direction = rhs->flow_direction;
 	setNumLinesToUpdate(rhs->getNumLinesToUpdate());
 
 #if QWT_VERSION < 0x060000
@@ -112,8 +118,11 @@ void WaterfallData::resizeData(const double startFreq,
 
 		setBoundingRect(QwtDoubleRect(
 					startFreq, 0, stopFreq - startFreq, static_cast<double>(_historyLength)));
-		_fftPoints = fftPoints;
-		_spectrumData.resize(_fftPoints * _historyLength);
+		if (fftPoints != _fftPoints) {
+			_fftPoints = fftPoints;
+			_spectrumData.resize(_fftPoints * _historyLength);
+			reset();
+		}
 	}
 
 #else
@@ -121,19 +130,60 @@ void WaterfallData::resizeData(const double startFreq,
 			(interval(Qt::XAxis).width() != (stopFreq - startFreq)) ||
 			(interval(Qt::XAxis).minValue() != startFreq) ||
 			(_historyLength != history)) {
-		if (history > 0) {
-			_historyLength = history;
+		setInterval(Qt::XAxis, QwtInterval(startFreq, stopFreq));
+
+		if (fftPoints != _fftPoints) {
+			// Rows of a different width can't be kept
+			_fftPoints = fftPoints;
+			if (history > 0) {
+				_historyLength = history;
+			}
+			_spectrumData.resize(_fftPoints * _historyLength);
+			reset();
+		} else if (history > 0) {
+			resizeHistory(history);
 		}
 
-		setInterval(Qt::XAxis, QwtInterval(startFreq, stopFreq));
 		setInterval(Qt::YAxis, QwtInterval(0, _historyLength));
+	}
+#endif
+}
 
-		_fftPoints = fftPoints;
-		_spectrumData.resize(_fftPoints * _historyLength);
+void WaterfallData::resizeHistory(const uint64_t history)
+{
+	if (history == 0 || history == _historyLength) {
+		return;
+	}
+
+	// Unroll the ring into the new buffer, newest row first, keeping as many
+	// of the most recent rows as fit
+	std::vector<double> data(_fftPoints * history, -DBL_MAX);
+	const uint64_t keep = std::min(history, _historyLength);
+
+	for (uint64_t age = 0; age < keep; age++) {
+		const uint64_t src = (_headRow + _historyLength - age) % _historyLength;
+		const uint64_t dst = (keep - 1 - age);
+
+		memcpy(&data[dst * _fftPoints],
+		       &_spectrumData[src * _fftPoints],
+		       _fftPoints * sizeof(double));
 	}
+
+	_spectrumData.swap(data);
+	_historyLength = history;
+	_headRow = keep - 1;
+
+#if QWT_VERSION < 0x060000
+	QwtDoubleRect rect = boundingRect();
+	rect.setHeight(static_cast<double>(_historyLength));
+	setBoundingRect(rect);
+#else
+	setInterval(Qt::YAxis, QwtInterval(0, _historyLength));
 #endif
 }
 
+uint64_t WaterfallData::getHistoryLength() const { return _historyLength; }
+
 QwtRasterData* WaterfallData::copy() const
 {
 #if QWT_VERSION < 0x060000
@@ -190,15 +240,22 @@ double WaterfallData::value(double x, double y) const
 			static_cast<unsigned int>((((x - left) / (right - left)) * xlen) + 0.5);
 #endif
 
-	const int location = (intY * _fftPoints) + intX;
-	if ((location > -1) &&
-			(location < static_cast<int64_t>(_fftPoints * _historyLength))) {
-		returnValue = _spectrumData[location];
+	if (intY < _historyLength && intX < _fftPoints) {
+		returnValue = _spectrumData[storageRow(intY) * _fftPoints + intX];
 	}
 
 	return returnValue;
 }
 
+uint64_t WaterfallData::storageRow(uint64_t displayRow) const
+{
+	// UP: the newest row is drawn at the bottom, DOWN: at the top
+	const uint64_t age = flow_direction == WaterfallFlowDirection::UP
+			? _historyLength - 1 - displayRow : displayRow;
+
+	return (_headRow + _historyLength - age) % _historyLength;
+}
+
 uint64_t WaterfallData::getNumFFTPoints() const { return _fftPoints; }
 
 WaterfallFlowDirection WaterfallData::getFlowDirection()
@@ -215,44 +272,25 @@ void WaterfallData::addFFTData(const double* fftData,
 			       const uint64_t fftDataSize,
 			       const int droppedFrames)
 {
-	if (fftDataSize == _fftPoints) {
-		int64_t heightOffset = _historyLength - 1 - droppedFrames;
-		uint64_t drawingDroppedFrames = droppedFrames;
+	if (fftDataSize == _fftPoints && _historyLength > 0) {
+		uint64_t drawingDroppedFrames = droppedFrames > 0 ? droppedFrames : 0;
 
 		// Any valid data rolled off the display so just fill in zeros and write new data
-		if (heightOffset < 0) {
-			heightOffset = 0;
-			drawingDroppedFrames = static_cast<uint64_t>(_historyLength - 1);
+		if (drawingDroppedFrames > _historyLength - 1) {
+			drawingDroppedFrames = _historyLength - 1;
 		}
 
-		// Copy the old data over if any available
-		if (heightOffset > 0) {
-			switch (flow_direction) {
-			case WaterfallFlowDirection::UP:
-				memmove(_spectrumData.data(),
-					&_spectrumData[(drawingDroppedFrames + 1) * _fftPoints],
-						heightOffset * _fftPoints * sizeof(double));
-				break;
-			case WaterfallFlowDirection::DOWN:
-				memmove(&_spectrumData[(drawingDroppedFrames + 1) * _fftPoints],
-					_spectrumData.data(),
-						heightOffset * _fftPoints * sizeof(double));
-				break;
-			}
-
-		}
-
-		if (drawingDroppedFrames > 0) {
-			// Fill in zeros data for dropped data
-			memset(&_spectrumData[heightOffset * _fftPoints],
+		// Fill in zeros data for dropped data
+		for (uint64_t i = 0; i < drawingDroppedFrames; i++) {
+			_headRow = (_headRow + 1) % _historyLength;
+			memset(&_spectrumData[_headRow * _fftPoints],
 					0x00,
-					static_cast<int64_t>(drawingDroppedFrames) * _fftPoints *
-					sizeof(double));
+					_fftPoints * sizeof(double));
 		}
 
-		// add the new buffer
-		int index = flow_direction == WaterfallFlowDirection::UP ? _historyLength - 1 : 0;
-		memcpy(&_spectrumData[index * _fftPoints],
+		// add the new buffer over the oldest row
+		_headRow = (_headRow + 1) % _historyLength;
+		memcpy(&_spectrumData[_headRow * _fftPoints],
 				fftData,
 				_fftPoints * sizeof(double));
 	}
@@ -268,6 +306,8 @@ void WaterfallData::setSpectrumDataBuffer(const double* newData)
 	memcpy(_spectrumData.data(), newData, _fftPoints * _historyLength * sizeof(double));
 }
 
+uint64_t WaterfallData::getHeadRow() const { return _headRow; }
+
 int WaterfallData::getNumLinesToUpdate() const { return _numLinesToUpdate; }
 
 void WaterfallData::setNumLinesToUpdate(const int newNum) { _numLinesToUpdate = newNum; }
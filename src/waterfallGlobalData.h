@@ -56,6 +56,10 @@ public:
     virtual void
     resizeData(const double, const double, const uint64_t, const int history = 0);
 
+    // Changes the number of rows kept while preserving the most recent ones
+    virtual void resizeHistory(const uint64_t);
+    uint64_t getHistoryLength() const;
+
     virtual QwtRasterData* copy() const;
 
 #if QWT_VERSION < 0x060000
@@ -71,8 +75,10 @@ public:
     virtual uint64_t getNumFFTPoints() const;
     virtual void addFFTData(const double*, const uint64_t, const int);
 
+    // Raw ring storage; row getHeadRow() holds the most recent spectrum
     virtual const double* getSpectrumDataBuffer() const;
     virtual void setSpectrumDataBuffer(const double*);
+    uint64_t getHeadRow() const;
 
     virtual int getNumLinesToUpdate() const;
     virtual void setNumLinesToUpdate(const int);
@@ -80,10 +86,17 @@ public:
 
     void setFlowDirection(WaterfallFlowDirection direction);
     WaterfallFlowDirection getFlowDirection();
+
+    // Maps a display row (0 = top) to its row in the ring storage
+    uint64_t storageRow(uint64_t displayRow) const;
 protected:
+
+    // Rows are kept in a circular buffer: _headRow is the last row written,
+    // older rows follow it backwards. Adding a spectrum only touches one row.
     std::vector<double> _spectrumData;
     uint64_t _fftPoints;
     uint64_t _historyLength;
+    uint64_t _headRow;
     int _numLinesToUpdate;
     WaterfallFlowDirection flow_direction;
 
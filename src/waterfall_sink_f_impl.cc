@@ -88,6 +88,8 @@ waterfall_sink_f_impl::waterfall_sink_f_impl(int fftsize,
 	  d_fbuf(fftsize),
 	  d_main_gui(plot)
 {
+	d_frame_pool = SampleFramePool<double>::make();
+
 	resize_bufs(d_fftsize);
 
 	initialize();
@@ -323,6 +325,9 @@ int waterfall_sink_f_impl::work(int noutput_items,
 		if (datasize >= resid) {
 
 			if (gr::high_res_timer_now() - d_last_time > d_update_time) {
+				SampleFrame<double>::sptr frame =
+						d_frame_pool->acquire(d_nconnections, d_fftsize);
+
 				for (int n = 0; n < d_nconnections; n++) {
 					// Fill up residbuf with d_fftsize number of items
 					in = (const float*)input_items[n];
@@ -330,9 +335,11 @@ int waterfall_sink_f_impl::work(int noutput_items,
 								d_residbufs[n].data() + d_index, &in[j], sizeof(float) * resid);
 
 					fft(d_fbuf.data(), d_residbufs[n].data(), d_fftsize);
+					double *out = frame->channel(n);
 					for (int x = 0; x < d_fftsize; x++) {
 						d_magbufs[n][x] = (double)((1.0 - d_fftavg) * d_magbufs[n][x] +
 									   (d_fftavg)*d_fbuf[x]);
+						out[x] = d_magbufs[n][x];
 					}
 					//							     volk_32f_convert_64f(d_magbufs[n], d_fbuf, d_fftsize);
 				}
@@ -340,7 +347,7 @@ int waterfall_sink_f_impl::work(int noutput_items,
 				d_last_time = gr::high_res_timer_now();
 				d_qApplication->postEvent(
 							d_main_gui,
-							new WaterfallUpdateEvent(d_magbufs, d_fftsize, gr::high_res_timer_now() - d_last_time));
+							new WaterfallUpdateEvent(frame, gr::high_res_timer_now() - d_last_time));
 
 //								qDebug() << *std::max_element(d_magbufs[0].begin(), d_magbufs[0].end())
 //										<< *std::min_element(d_magbufs[0].begin(), d_magbufs[0].end()) << '\n';
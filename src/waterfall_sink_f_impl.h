@@ -32,6 +32,7 @@
 
 #include "WaterfallDisplayPlot.h"
 #include "waterfall_sink_f.h"
+#include "sample_frame.h"
 
 #include <gnuradio/fft/fft.h>
 #include <gnuradio/fft/fft_shift.h>
@@ -68,6 +69,7 @@ private:
     int d_index = 0;
     std::vector<volk::vector<float>> d_residbufs;
     std::vector<volk::vector<double>> d_magbufs;
+    SampleFramePool<double>::sptr d_frame_pool;
     double* d_pdu_magbuf;
     volk::vector<float> d_fbuf;
 
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2019 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "waterfall_spectrogram.h"
+#include "waterfallGlobalData.h"
+
+#include <qwt_color_map.h>
+#include <qwt_scale_map.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace adiscope;
+
+/* Number of colours precomputed for linear colour maps */
+#define WATERFALL_LUT_SIZE 1024
+
+WaterfallSpectrogram::WaterfallSpectrogram(WaterfallData *data, const QString &title)
+	: QwtPlotSpectrogram(title)
+	, d_waterfall(data)
+	, d_image_valid(false)
+	, d_outside_rgb(0)
+{
+	setData(data);
+}
+
+WaterfallSpectrogram::~WaterfallSpectrogram()
+{
+}
+
+void WaterfallSpectrogram::invalidateImage()
+{
+	d_image_valid = false;
+}
+
+bool WaterfallSpectrogram::imageIsCurrent() const
+{
+	return d_image_valid &&
+		static_cast<uint64_t>(d_image.width()) == d_waterfall->getNumFFTPoints() &&
+		static_cast<uint64_t>(d_image.height()) == d_waterfall->getHistoryLength() &&
+		d_image_interval == d_waterfall->interval(Qt::ZAxis);
+}
+
+void WaterfallSpectrogram::updateRows(unsigned int count)
+{
+	// A stale image gets rebuilt from scratch on the next repaint anyway
+	if (!imageIsCurrent()) {
+		return;
+	}
+
+	const uint64_t history = d_waterfall->getHistoryLength();
+	const uint64_t head = d_waterfall->getHeadRow();
+
+	if (count > history) {
+		count = history;
+	}
+
+	for (unsigned int i = 0; i < count; i++) {
+		mapRow((head + history - i) % history);
+	}
+}
+
+void WaterfallSpectrogram::rebuildImage() const
+{
+	const int width = d_waterfall->getNumFFTPoints();
+	const int height = d_waterfall->getHistoryLength();
+	const QwtColorMap *map = colorMap();
+
+	d_image_interval = d_waterfall->interval(Qt::ZAxis);
+
+	if (d_image.width() != width || d_image.height() != height) {
+		d_image = QImage(width, height, QImage::Format_ARGB32);
+	}
+
+	// Linear colour maps (ColorMap_DefaultDark and friends) are sampled
+	// once so that mapping a row is an index computation plus a lookup
+	d_lut.clear();
+	if (dynamic_cast<const QwtLinearColorMap *>(map) &&
+			d_image_interval.width() > 0) {
+		const double min = d_image_interval.minValue();
+		const double step = d_image_interval.width() / (WATERFALL_LUT_SIZE - 1);
+
+		d_lut.resize(WATERFALL_LUT_SIZE);
+		for (int i = 0; i < WATERFALL_LUT_SIZE; i++) {
+			d_lut[i] = map->rgb(d_image_interval, min + i * step);
+		}
+	}
+	d_lut_index.resize(width);
+
+	// WaterfallData::value() returns 0 outside of the data
+	d_outside_rgb = map->rgb(d_image_interval, 0.0);
+
+	for (int row = 0; row < height; row++) {
+		mapRow(row);
+	}
+
+	d_image_valid = true;
+}
+
+void WaterfallSpectrogram::mapRow(uint64_t row) const
+{
+	const uint64_t width = d_waterfall->getNumFFTPoints();
+	const double *src = d_waterfall->getSpectrumDataBuffer() + row * width;
+	QRgb *dst = reinterpret_cast<QRgb *>(d_image.scanLine(row));
+
+	if (d_lut.empty()) {
+		const QwtColorMap *map = colorMap();
+
+		for (uint64_t i = 0; i < width; i++) {
+			dst[i] = map->rgb(d_image_interval, src[i]);
+		}
+		return;
+	}
+
+	const double min = d_image_interval.minValue();
+	const double scale = (WATERFALL_LUT_SIZE - 1) / d_image_interval.width();
+	const double last = WATERFALL_LUT_SIZE - 1;
+	int *index = d_lut_index.data();
+
+	// Kept branch-free so that it gets vectorized; NaNs end up at 0
+	for (uint64_t i = 0; i < width; i++) {
+		double pos = (src[i] - min) * scale;
+		pos = pos > 0.0 ? pos : 0.0;
+		pos = pos < last ? pos : last;
+		index[i] = static_cast<int>(pos + 0.5);
+	}
+
+	const QRgb *lut = d_lut.data();
+	for (uint64_t i = 0; i < width; i++) {
+		dst[i] = lut[index[i]];
+	}
+}
+
+QImage WaterfallSpectrogram::renderImage(const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+					 const QRectF &area, const QSize &imageSize) const
+{
+	const uint64_t fftPoints = d_waterfall->getNumFFTPoints();
+	const uint64_t history = d_waterfall->getHistoryLength();
+
+	if (imageSize.isEmpty() || fftPoints == 0 || history == 0 || !colorMap()) {
+		return QImage();
+	}
+
+	if (!imageIsCurrent()) {
+		rebuildImage();
+	}
+
+	const QwtScaleMap xxMap = imageMap(Qt::Horizontal, xMap, area, imageSize, 0.0);
+	const QwtScaleMap yyMap = imageMap(Qt::Vertical, yMap, area, imageSize, 0.0);
+
+	// Same bin and row selection as WaterfallData::value()
+	const double left = d_waterfall->interval(Qt::XAxis).minValue();
+	const double right = d_waterfall->interval(Qt::XAxis).maxValue();
+	const double height = d_waterfall->interval(Qt::YAxis).maxValue();
+	const double xlen = static_cast<double>(fftPoints - 1);
+	const double ylen = static_cast<double>(history - 1);
+
+	std::vector<int> columns(imageSize.width());
+	for (int x = 0; x < imageSize.width(); x++) {
+		const double pos = (xxMap.invTransform(x) - left) / (right - left) * xlen + 0.5;
+
+		columns[x] = (pos >= 0.0 && pos < fftPoints) ? static_cast<int>(pos) : -1;
+	}
+
+	QImage image(imageSize, QImage::Format_ARGB32);
+
+	for (int y = 0; y < imageSize.height(); y++) {
+		const double pos = (1.0 - yyMap.invTransform(y) / height) * ylen;
+		QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+
+		if (!(pos >= 0.0 && pos < history)) {
+			std::fill(line, line + imageSize.width(), d_outside_rgb);
+			continue;
+		}
+
+		const uint64_t row = d_waterfall->storageRow(static_cast<uint64_t>(pos));
+		const QRgb *src = reinterpret_cast<const QRgb *>(d_image.constScanLine(row));
+
+		for (int x = 0; x < imageSize.width(); x++) {
+			line[x] = columns[x] < 0 ? d_outside_rgb : src[columns[x]];
+		}
+	}
+
+	return image;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2019 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WATERFALL_SPECTROGRAM_H
+#define WATERFALL_SPECTROGRAM_H
+
+#include <qwt_plot_spectrogram.h>
+#include <QImage>
+#include <vector>
+
+class WaterfallData;
+
+namespace adiscope {
+
+/*
+ * Spectrogram item that keeps a colour-mapped copy of the waterfall history.
+ * The image has one pixel per FFT bin and one line per row of the
+ * WaterfallData ring, so each new spectrum is colour-mapped exactly once
+ * and repainting only has to pick pixels out of the cached image instead of
+ * going through QwtRasterData::value() for every one of them.
+ */
+class WaterfallSpectrogram : public QwtPlotSpectrogram
+{
+public:
+	WaterfallSpectrogram(WaterfallData *data, const QString &title);
+	~WaterfallSpectrogram() override;
+
+	/* Colour-maps the most recently added rows of the waterfall data */
+	void updateRows(unsigned int count);
+
+	/* Forces a full rebuild of the image on the next repaint; call this
+	 * when the colour map or the data changes in any other way */
+	void invalidateImage();
+
+protected:
+	QImage renderImage(const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+			   const QRectF &area, const QSize &imageSize) const override;
+
+private:
+	bool imageIsCurrent() const;
+	void rebuildImage() const;
+	void mapRow(uint64_t row) const;
+
+	WaterfallData *d_waterfall;
+
+	mutable QImage d_image;
+	mutable QwtInterval d_image_interval;
+	mutable bool d_image_valid;
+
+	mutable std::vector<QRgb> d_lut;
+	mutable std::vector<int> d_lut_index;
+	mutable QRgb d_outside_rgb;
+};
+}
+
+#endif /* WATERFALL_SPECTROGRAM_H */
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "waveform_synth.h"
+#include "simd.h"
+
+#include <gnuradio/random.h>
+
+#include <algorithm>
+#include <cmath>
+
+/* The phasors are rotated from one group of samples to the next and
+ * computed again from scratch this often, so the error cannot build up */
+#define PHASOR_RESEED 1024
+
+using namespace adiscope;
+
+void synth::sine(double *out, size_t count, double w, double phase,
+		 double amplitude, double offset)
+{
+	using simd::v4df;
+
+	const v4df rot_re = simd::broadcast(std::cos(simd::LANES * w));
+	const v4df rot_im = simd::broadcast(std::sin(simd::LANES * w));
+	const v4df a = simd::broadcast(amplitude);
+	const v4df o = simd::broadcast(offset);
+
+	v4df c = {}, s = {};
+	size_t k = 0;
+
+	for (; k + simd::LANES <= count; k += simd::LANES) {
+		if (k % PHASOR_RESEED == 0) {
+			for (unsigned int j = 0; j < simd::LANES; j++) {
+				c[j] = std::cos(phase + w * (k + j));
+				s[j] = std::sin(phase + w * (k + j));
+			}
+		}
+
+		simd::store(out + k, a * s + o);
+
+		const v4df next_c = c * rot_re - s * rot_im;
+		s = s * rot_re + c * rot_im;
+		c = next_c;
+	}
+
+	for (; k < count; k++) {
+		out[k] = amplitude * std::sin(phase + w * k) + offset;
+	}
+}
+
+void synth::repeat(double *out, size_t count, const std::vector<float> &data,
+		   size_t start, double scale, double offset)
+{
+	if (data.empty()) {
+		std::fill(out, out + count, offset);
+		return;
+	}
+
+	size_t i = start % data.size();
+
+	for (size_t k = 0; k < count;) {
+		const size_t run = std::min(count - k, data.size() - i);
+
+		for (size_t j = 0; j < run; j++) {
+			out[k + j] = data[i + j] * scale + offset;
+		}
+
+		k += run;
+		i = 0;
+	}
+}
+
+void synth::addNoise(double *out, size_t count, gr::analog::noise_type_t type,
+		     float amplitude, float limit, unsigned int seed)
+{
+	gr::random rng(seed);
+
+	// Same draws as noise_source_f, followed by the rail of the flowgraph
+	for (size_t k = 0; k < count; k++) {
+		float value;
+
+		switch (type) {
+		case gr::analog::GR_UNIFORM:
+			value = amplitude * ((rng.ran1() * 2.0) - 1.0);
+			break;
+		case gr::analog::GR_GAUSSIAN:
+			value = amplitude * rng.gasdev();
+			break;
+		case gr::analog::GR_LAPLACIAN:
+			value = amplitude * rng.laplacian();
+			break;
+		case gr::analog::GR_IMPULSE:
+			value = amplitude * rng.impulse(9);
+			break;
+		default:
+			return;
+		}
+
+		out[k] += std::max(-limit, std::min(limit, value));
+	}
+}
+
+void synth::scaleAndClamp(const double *in, double *out, size_t count,
+			  double scale, double limit)
+{
+	const simd::v4df s = simd::broadcast(scale);
+	const simd::v4df hi = simd::broadcast(limit);
+	const simd::v4df lo = simd::broadcast(-limit);
+	size_t k = 0;
+
+	for (; k + simd::LANES <= count; k += simd::LANES) {
+		simd::store(out + k, simd::min(simd::max(simd::load(in + k) * s, lo), hi));
+	}
+	for (; k < count; k++) {
+		out[k] = std::max(-limit, std::min(limit, in[k] * scale));
+	}
+}
+
+WaveformCache::WaveformCache(int capacity) :
+	m_capacity(capacity)
+{
+}
+
+WaveformCache::cycle_sptr WaveformCache::find(const QByteArray &key)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	auto it = m_cycles.constFind(key);
+
+	if (it == m_cycles.constEnd()) {
+		return cycle_sptr();
+	}
+
+	// The most recently used cycle is kept at the back
+	m_order.removeOne(key);
+	m_order.append(key);
+
+	return it.value();
+}
+
+void WaveformCache::insert(const QByteArray &key, const cycle_sptr &cycle)
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	if (m_cycles.contains(key)) {
+		m_order.removeOne(key);
+	}
+
+	m_cycles.insert(key, cycle);
+	m_order.append(key);
+
+	while (m_order.size() > m_capacity) {
+		m_cycles.remove(m_order.takeFirst());
+	}
+}
+
+void WaveformCache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_lock);
+
+	m_order.clear();
+	m_cycles.clear();
+}
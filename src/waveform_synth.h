@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WAVEFORM_SYNTH_H
+#define WAVEFORM_SYNTH_H
+
+#include <gnuradio/analog/noise_type.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace adiscope {
+
+/*
+ * Generators for the cyclic buffers of the signal generator, which write
+ * straight into the buffer that is pushed to the DAC.
+ */
+namespace synth {
+
+/* out[n] = amplitude * sin(phase + w * n) + offset, angles in radians */
+void sine(double *out, size_t count, double w, double phase,
+	  double amplitude, double offset);
+
+/* out[n] = data[(start + n) % data.size()] * scale + offset */
+void repeat(double *out, size_t count, const std::vector<float> &data,
+	    size_t start, double scale, double offset);
+
+/*
+ * Adds the noise gr::analog::noise_source_f makes for the same type and
+ * amplitude, clamped to [-limit, limit]
+ */
+void addNoise(double *out, size_t count, gr::analog::noise_type_t type,
+	      float amplitude, float limit, unsigned int seed);
+
+/* out[n] = in[n] * scale, clamped to [-limit, limit] */
+void scaleAndClamp(const double *in, double *out, size_t count,
+		   double scale, double limit);
+}
+
+/*
+ * The buffer a channel plays, at the rate it is played at: as generated,
+ * which is what the preview shows, and as pushed to the DAC.
+ */
+struct SynthesizedCycle {
+	double rate;
+	bool smooth;
+	std::vector<double> samples;
+	std::vector<double> output;
+};
+
+/*
+ * The last few cycles generated, looked up by the parameters they were
+ * generated from. A cycle is never changed once it is in the cache, and
+ * the cache can be used from the preview thread and the GUI at once.
+ */
+class WaveformCache
+{
+public:
+	typedef std::shared_ptr<const SynthesizedCycle> cycle_sptr;
+
+	explicit WaveformCache(int capacity = 8);
+
+	cycle_sptr find(const QByteArray &key);
+	void insert(const QByteArray &key, const cycle_sptr &cycle);
+	void clear();
+
+private:
+	int m_capacity;
+	std::mutex m_lock;
+	QList<QByteArray> m_order;
+	QHash<QByteArray, cycle_sptr> m_cycles;
+};
+}
+
+#endif // WAVEFORM_SYNTH_H
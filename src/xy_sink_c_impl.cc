@@ -78,12 +78,12 @@ namespace adiscope {
     {
 
       for(int i = 0; i < d_nconnections; i++) {
-	d_residbufs_real.push_back((double*)volk_malloc(d_buffer_size*sizeof(double),
-                                                        volk_get_alignment()));
-	d_residbufs_imag.push_back((double*)volk_malloc(d_buffer_size*sizeof(double),
-                                                        volk_get_alignment()));
-	memset(d_residbufs_real[i], 0, d_buffer_size*sizeof(double));
-	memset(d_residbufs_imag[i], 0, d_buffer_size*sizeof(double));
+	d_residbufs_real.push_back((float*)volk_malloc(d_buffer_size*sizeof(float),
+                                                       volk_get_alignment()));
+	d_residbufs_imag.push_back((float*)volk_malloc(d_buffer_size*sizeof(float),
+                                                       volk_get_alignment()));
+	memset(d_residbufs_real[i], 0, d_buffer_size*sizeof(float));
+	memset(d_residbufs_imag[i], 0, d_buffer_size*sizeof(float));
       }
 
       // Set alignment properties for VOLK
@@ -91,6 +91,8 @@ namespace adiscope {
 	volk_get_alignment() / sizeof(gr_complex);
       set_alignment(std::max(1,alignment_multiple));
 
+      d_frame_pool = SampleFramePool<float>::make();
+
       initialize();
       this->plot = (ConstellationDisplayPlot*)plot;
    }
@@ -152,13 +154,13 @@ namespace adiscope {
 	for(int i = 0; i < d_nconnections; i++) {
 	  volk_free(d_residbufs_real[i]);
 	  volk_free(d_residbufs_imag[i]);
-	  d_residbufs_real[i] = (double*)volk_malloc(d_buffer_size*sizeof(double),
-                                                     volk_get_alignment());
-	  d_residbufs_imag[i] = (double*)volk_malloc(d_buffer_size*sizeof(double),
-                                                     volk_get_alignment());
+	  d_residbufs_real[i] = (float*)volk_malloc(d_buffer_size*sizeof(float),
+                                                    volk_get_alignment());
+	  d_residbufs_imag[i] = (float*)volk_malloc(d_buffer_size*sizeof(float),
+                                                    volk_get_alignment());
 
-	  memset(d_residbufs_real[i], 0, d_buffer_size*sizeof(double));
-	  memset(d_residbufs_imag[i], 0, d_buffer_size*sizeof(double));
+	  memset(d_residbufs_real[i], 0, d_buffer_size*sizeof(float));
+	  memset(d_residbufs_imag[i], 0, d_buffer_size*sizeof(float));
 	}
 
         _reset();
@@ -208,7 +210,7 @@ namespace adiscope {
       // Copy data into the buffers.
       for(n = 0; n < d_nconnections; n++) {
         in = (const gr_complex*)input_items[n];
-        volk_32fc_deinterleave_64f_x2(&d_residbufs_real[n][d_index],
+        volk_32fc_deinterleave_32f_x2(&d_residbufs_real[n][d_index],
                                       &d_residbufs_imag[n][d_index],
                                       &in[0], nitems);
       }
@@ -217,20 +219,23 @@ namespace adiscope {
 
       // If we have a full d_size of items in the buffers, plot.
       if((d_index == d_end) && d_end  != 0) {
-        // Copy data to be plotted to start of buffers.
-        for(n = 0; n < d_nconnections; n++) {
-          memmove(d_residbufs_real[n], &d_residbufs_real[n][d_start], d_size*sizeof(double));
-          memmove(d_residbufs_imag[n], &d_residbufs_imag[n][d_start], d_size*sizeof(double));
-        }
-
         // Plot if we are able to update
         if(gr::high_res_timer_now() - d_last_time > d_update_time) {
           d_last_time = gr::high_res_timer_now();
-          if (d_qApplication)
-		d_qApplication->postEvent(plot,
-                                    new ConstUpdateEvent(d_residbufs_real,
-							 d_residbufs_imag,
-							 d_size));
+          if (d_qApplication) {
+            // Copy data to be plotted straight into recycled frames
+            SampleFrame<float>::sptr real =
+                    d_frame_pool->acquire(d_nconnections, d_size);
+            SampleFrame<float>::sptr imag =
+                    d_frame_pool->acquire(d_nconnections, d_size);
+            for(n = 0; n < d_nconnections; n++) {
+              memcpy(real->channel(n), &d_residbufs_real[n][d_start], d_size*sizeof(float));
+              memcpy(imag->channel(n), &d_residbufs_imag[n][d_start], d_size*sizeof(float));
+            }
+
+            d_qApplication->postEvent(plot,
+                                      new ConstUpdateEvent(real, imag));
+          }
         }
 
         // We've plotting, so reset the state
@@ -46,6 +46,7 @@
 
 #include "xy_sink_c.h"
 #include "ConstellationDisplayPlot.h"
+#include "sample_frame.h"
 
 namespace adiscope {
 
@@ -59,8 +60,9 @@ namespace adiscope {
       int d_nconnections;
 
       int d_index, d_start, d_end;
-      std::vector<double*> d_residbufs_real;
-      std::vector<double*> d_residbufs_imag;
+      std::vector<float*> d_residbufs_real;
+      std::vector<float*> d_residbufs_imag;
+      SampleFramePool<float>::sptr d_frame_pool;
 
       ConstellationDisplayPlot *plot;
 
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * AdcConversion against libm2k's convertRawToVolts, for every 12 bit code
+ * on both channels in both ranges. The block used to output the libm2k
+ * result rounded to float; the affine path may only differ from that by
+ * the rounding of the last float bit.
+ *
+ *   adc_conversion_test [uri]
+ */
+
+#include "adc_conversion.hpp"
+
+#include <libm2k/m2k.hpp>
+#include <libm2k/contextbuilder.hpp>
+#include <libm2k/analog/m2kanalogin.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <vector>
+
+using namespace adiscope;
+using namespace libm2k::analog;
+
+static int checkChannel(M2kAnalogIn *adc, unsigned int chn, M2K_RANGE range)
+{
+	const int codes = 4096;
+	std::vector<float> raw(codes);
+	std::vector<float> volts(codes);
+	int inexact = 0;
+	int failures = 0;
+
+	adc->setRange(static_cast<ANALOG_IN_CHANNEL>(chn), range);
+
+	for (int i = 0; i < codes; i++) {
+		raw[i] = i - codes / 2;
+	}
+
+	AdcConversion::fromAdc(adc, chn).toVolts(raw.data(), volts.data(), codes);
+
+	for (int i = 0; i < codes; i++) {
+		const float expected = static_cast<float>(
+			adc->convertRawToVolts(chn, static_cast<short>(raw[i])));
+
+		if (volts[i] == expected) {
+			continue;
+		}
+
+		inexact++;
+
+		if (volts[i] != std::nextafter(expected, volts[i])) {
+			if (failures++ < 10) {
+				printf("channel %u, range %d, code %d: %.9g instead of %.9g\n",
+				       chn, range, int(raw[i]), volts[i], expected);
+			}
+		}
+	}
+
+	printf("channel %u, range %d: %d codes, %d off by one ulp, %d wrong\n",
+	       chn, range, codes, inexact - failures, failures);
+
+	return failures;
+}
+
+int main(int argc, char **argv)
+{
+	const char *uri = argc > 1 ? argv[1] : "ip:127.0.0.1";
+	libm2k::context::M2k *m2k = libm2k::context::m2kOpen(uri);
+
+	if (!m2k) {
+		printf("Can't open %s\n", uri);
+		return 1;
+	}
+
+	int failures = 0;
+
+	try {
+		M2kAnalogIn *adc = m2k->getAnalogIn();
+
+		for (M2K_RANGE range : { PLUS_MINUS_25V, PLUS_MINUS_2_5V }) {
+			for (unsigned int chn = 0; chn < 2; chn++) {
+				failures += checkChannel(adc, chn, range);
+			}
+		}
+	} catch (const std::exception &e) {
+		printf("%s\n", e.what());
+		failures++;
+	}
+
+	libm2k::context::contextClose(m2k);
+
+	return failures ? 1 : 0;
+}
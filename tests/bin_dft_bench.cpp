@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The time BinDft takes to analyse a network analyzer capture, against
+ * the flowgraph the network analyzer ran before: the capture copied into
+ * two vector sources, the frequency compensation filters, DC cancel,
+ * Goertzel, magnitude and phase, and the sinks of the buffer preview.
+ *
+ * The flowgraph is built once for each buffer size and only its runs are
+ * timed, which leaves out the reconnection the network analyzer did when
+ * the buffer size changed. Both give the gain and phase of the second
+ * channel against the first; the results must agree to within the float
+ * arithmetic of the flowgraph.
+ *
+ *   bin_dft_bench [captures per buffer size]
+ */
+
+#include "bin_dft.h"
+#include "frequency_compensation_filter.h"
+
+#include <gnuradio/blocks/complex_to_arg.h>
+#include <gnuradio/blocks/complex_to_mag_squared.h>
+#include <gnuradio/blocks/keep_one_in_n.h>
+#include <gnuradio/blocks/moving_average.h>
+#include <gnuradio/blocks/multiply_conjugate_cc.h>
+#include <gnuradio/blocks/multiply_const.h>
+#include <gnuradio/blocks/repeat.h>
+#include <gnuradio/blocks/short_to_float.h>
+#include <gnuradio/blocks/sub.h>
+#include <gnuradio/blocks/vector_sink.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/scopy/goertzel_scopy_fc.h>
+#include <gnuradio/top_block.h>
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace adiscope;
+
+static const float TC[2] = { 2.5, 0.6 };
+static const float GAIN[2] = { 0.03, -0.012 };
+
+struct Result {
+	double gain_db;
+	double phase;
+	double seconds;
+};
+
+/* A tone with a whole number of periods, as the network analyzer sets up */
+static std::vector<short> makeCapture(size_t length, double periods)
+{
+	std::mt19937 gen(length);
+	std::normal_distribution<double> noise(0, 2);
+	std::vector<short> capture(2 * length);
+
+	for (size_t n = 0; n < length; n++) {
+		const double phi = 2 * M_PI * periods * n / length;
+
+		capture[2 * n] = std::round(150 + 1800 * std::cos(phi + 0.3) +
+					    noise(gen));
+		capture[2 * n + 1] = std::round(-75 + 660 * std::cos(phi - 1.1) +
+						noise(gen));
+	}
+
+	return capture;
+}
+
+/* cancel_dc_offset_block, without its Qt signal */
+static gr::basic_block_sptr dcCancel(gr::top_block_sptr tb,
+				     gr::basic_block_sptr in, size_t length)
+{
+	auto avg = gr::blocks::moving_average_ff::make(length, 1.0 / length,
+							 length);
+	auto keep = gr::blocks::keep_one_in_n::make(sizeof(float), length);
+	auto repeat = gr::blocks::repeat::make(sizeof(float), length);
+	auto sub = gr::blocks::sub_ff::make();
+	auto dc = gr::blocks::vector_sink_f::make();
+
+	tb->connect(in, 0, avg, 0);
+	tb->connect(avg, 0, keep, 0);
+	tb->connect(keep, 0, dc, 0);
+	tb->connect(keep, 0, repeat, 0);
+	tb->connect(in, 0, sub, 0);
+	tb->connect(repeat, 0, sub, 1);
+
+	return sub;
+}
+
+static Result runFlowgraph(const std::vector<short> &capture, size_t length,
+			   double frequency, double sample_rate,
+			   unsigned int captures)
+{
+	auto tb = gr::make_top_block("Network capture processing");
+	gr::blocks::vector_source_s::sptr sources[2];
+	gr::blocks::vector_sink_f::sptr mag[2];
+	gr::basic_block_sptr goertzel[2];
+
+	for (unsigned int chn = 0; chn < 2; chn++) {
+		sources[chn] = gr::blocks::vector_source_s::make(
+			std::vector<short>(), false, 1);
+
+		gr::basic_block_sptr last = sources[chn];
+
+		for (unsigned int stage = 0; stage < 2; stage++) {
+			auto f = frequency_compensation_filter::make(
+				true, TC[stage], GAIN[stage], sample_rate);
+
+			tb->connect(last, 0, f, 0);
+			last = f;
+		}
+
+		auto s2f = gr::blocks::short_to_float::make();
+		tb->connect(last, 0, s2f, 0);
+
+		auto dc = dcCancel(tb, s2f, length);
+		auto g = gr::scopy::goertzel_scopy_fc::make(sample_rate, length,
+							   frequency);
+		auto c2m = gr::blocks::complex_to_mag_squared::make();
+		auto adc_conv = gr::blocks::multiply_const_ff::make(0.0122);
+		auto preview = gr::blocks::vector_sink_f::make();
+
+		mag[chn] = gr::blocks::vector_sink_f::make();
+		tb->connect(dc, 0, g, 0);
+		tb->connect(g, 0, c2m, 0);
+		tb->connect(c2m, 0, mag[chn], 0);
+		tb->connect(dc, 0, adc_conv, 0);
+		tb->connect(adc_conv, 0, preview, 0);
+		goertzel[chn] = g;
+	}
+
+	auto conj = gr::blocks::multiply_conjugate_cc::make();
+	auto c2a = gr::blocks::complex_to_arg::make();
+	auto phase = gr::blocks::vector_sink_f::make();
+
+	tb->connect(goertzel[0], 0, conj, 0);
+	tb->connect(goertzel[1], 0, conj, 1);
+	tb->connect(conj, 0, c2a, 0);
+	tb->connect(c2a, 0, phase, 0);
+
+	Result result = { 0, 0, 0 };
+	auto start = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0; i < captures; i++) {
+		// The capture was split into a vector per channel
+		std::vector<short> data[2];
+
+		for (size_t n = 0; n < length; n++) {
+			data[0].push_back(capture[2 * n]);
+			data[1].push_back(capture[2 * n + 1]);
+		}
+
+		for (unsigned int chn = 0; chn < 2; chn++) {
+			sources[chn]->rewind();
+			sources[chn]->set_data(data[chn]);
+			mag[chn]->reset();
+		}
+		phase->reset();
+
+		tb->run();
+	}
+
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+
+	result.seconds = elapsed.count() / captures;
+	if (!mag[0]->data().empty() && !mag[1]->data().empty() &&
+	    !phase->data().empty()) {
+		result.gain_db = 10 * std::log10(mag[1]->data().back() /
+						 mag[0]->data().back());
+		result.phase = phase->data().back();
+	} else {
+		result.gain_db = NAN;
+	}
+
+	return result;
+}
+
+static Result runBinDft(const std::vector<short> &capture, size_t length,
+			double frequency, double sample_rate,
+			unsigned int captures)
+{
+	BinDft dft(frequency, sample_rate, length);
+	std::vector<float> preview[2];
+
+	dft.setRemoveDc(true);
+	for (unsigned int chn = 0; chn < 2; chn++) {
+		for (unsigned int stage = 0; stage < 2; stage++) {
+			dft.setCompensation(chn, stage, true, TC[stage],
+					    GAIN[stage]);
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (unsigned int i = 0; i < captures; i++) {
+		dft.compute(capture.data());
+
+		// The network analyzer takes the preview of the last average
+		// only; with no averaging that is every capture
+		for (unsigned int chn = 0; chn < 2; chn++) {
+			dft.samples(capture.data(), chn, 0.0122, preview[chn]);
+		}
+	}
+
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+
+	const std::complex<double> b0 = dft.bin(0), b1 = dft.bin(1);
+	Result result;
+
+	result.seconds = elapsed.count() / captures;
+	result.gain_db = 10 * std::log10(std::norm(b1) / std::norm(b0));
+	result.phase = std::arg(b0 * std::conj(b1));
+
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	const unsigned int captures = argc > 1 ? strtoul(argv[1], nullptr, 0) : 50;
+	const size_t lengths[] = { 256, 1024, 4096, 16384, 65536 };
+	const double sample_rate = 1e6;
+	int failures = 0;
+
+	printf("%8s %14s %14s %8s %12s %12s\n", "samples", "flowgraph us",
+	       "BinDft us", "speedup", "gain diff dB", "phase diff");
+
+	for (size_t length : lengths) {
+		const double periods = 3;
+		const double frequency = periods * sample_rate / length;
+		const std::vector<short> capture = makeCapture(length, periods);
+
+		const Result flow = runFlowgraph(capture, length, frequency,
+						 sample_rate, captures);
+		const Result dft = runBinDft(capture, length, frequency,
+					     sample_rate, captures);
+		const double gain_diff = std::fabs(flow.gain_db - dft.gain_db);
+		const double phase_diff = std::fabs(std::remainder(
+			flow.phase - dft.phase, 2 * M_PI));
+
+		printf("%8zu %14.1f %14.1f %8.1f %12.3g %12.3g\n", length,
+		       flow.seconds * 1e6, dft.seconds * 1e6,
+		       flow.seconds / dft.seconds, gain_diff, phase_diff);
+
+		// The flowgraph works in float and truncates the compensated
+		// samples to whole codes; anything more than that is a fault
+		if (!(gain_diff < 0.05 && phase_diff < 0.05)) {
+			failures++;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * BinDft against a DFT and frequency compensation worked out in long
+ * double, on captures like the network analyzer's: one or several tones,
+ * an offset and noise, on buffers of many sizes, with and without DC
+ * removal and the compensation of the ADC front end.
+ */
+
+#include "bin_dft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace adiscope;
+
+typedef std::complex<long double> cld;
+
+struct Compensation {
+	bool enable;
+	float tc_us;
+	float gain;
+};
+
+struct Case {
+	std::vector<double> frequencies;
+	double sample_rate;
+	size_t length;
+	bool remove_dc;
+	Compensation stages[2][2];
+};
+
+/* The compensation as frequency_compensation_filter describes it */
+static std::vector<long double> referenceFilter(const short *interleaved,
+						unsigned int chn,
+						const Case &c)
+{
+	std::vector<long double> x(c.length);
+
+	for (size_t i = 0; i < c.length; i++) {
+		x[i] = interleaved[2 * i + chn];
+	}
+
+	for (unsigned int stage = 0; stage < 2; stage++) {
+		const Compensation &comp = c.stages[chn][stage];
+
+		if (!comp.enable) {
+			continue;
+		}
+
+		// The coefficient as the block computes it, in float
+		float delta = 1.0 / static_cast<float>(c.sample_rate);
+		float TC1 = comp.tc_us * float(1.0E-6);
+		const long double alpha = TC1 / (TC1 + delta);
+		long double y = 0;
+		long double x_prev = x[0];
+
+		for (size_t i = 0; i < c.length; i++) {
+			const long double in = x[i];
+
+			y = alpha * (y + (in - x_prev));
+			x_prev = in;
+			x[i] = in + y * comp.gain;
+		}
+	}
+
+	return x;
+}
+
+static cld referenceBin(const std::vector<long double> &x, double frequency,
+			double sample_rate, bool remove_dc)
+{
+	const long double w = 2.0 * M_PI * frequency / sample_rate;
+	long double mean = 0;
+	cld sum = 0;
+
+	if (remove_dc) {
+		for (long double v : x) {
+			mean += v;
+		}
+		mean /= x.size();
+	}
+
+	for (size_t n = 0; n < x.size(); n++) {
+		sum += (x[n] - mean) * cld(cosl(w * n), -sinl(w * n));
+	}
+
+	return sum / (long double)x.size();
+}
+
+/*
+ * Two channels of 12 bit codes: the tones with a gain and phase shift on
+ * the second channel, an offset and some noise.
+ */
+static std::vector<short> makeCapture(const Case &c, std::mt19937 &gen)
+{
+	std::normal_distribution<double> noise(0, 2);
+	std::vector<short> capture(2 * c.length);
+	const double amplitude = 1800.0 / c.frequencies.size();
+
+	for (size_t n = 0; n < c.length; n++) {
+		double v[2] = { 150, -75 };
+
+		for (double f : c.frequencies) {
+			const double phi = 2 * M_PI * f * n / c.sample_rate;
+
+			v[0] += amplitude * std::cos(phi + 0.3);
+			v[1] += amplitude * 0.37 * std::cos(phi - 1.1);
+		}
+
+		for (unsigned int chn = 0; chn < 2; chn++) {
+			capture[2 * n + chn] = std::max(-2048.0, std::min(2047.0,
+				std::round(v[chn] + noise(gen))));
+		}
+	}
+
+	return capture;
+}
+
+/*
+ * Largest errors over the cases: of the bins in dB and radians, of the mean
+ * relative to it and of the samples relative to full scale
+ */
+struct Errors {
+	double mag_db = 0;
+	double phase = 0;
+	double dc = 0;
+	double samples = 0;
+};
+
+static int checkCase(const Case &c, std::mt19937 &gen, Errors &worst,
+		     double tolerance)
+{
+	const std::vector<short> capture = makeCapture(c, gen);
+	BinDft dft(c.frequencies, c.sample_rate, c.length);
+	int failures = 0;
+
+	dft.setRemoveDc(c.remove_dc);
+	for (unsigned int chn = 0; chn < 2; chn++) {
+		for (unsigned int stage = 0; stage < 2; stage++) {
+			const Compensation &comp = c.stages[chn][stage];
+
+			dft.setCompensation(chn, stage, comp.enable, comp.tc_us,
+					    comp.gain);
+		}
+	}
+
+	dft.compute(capture.data());
+
+	for (unsigned int chn = 0; chn < 2; chn++) {
+		const std::vector<long double> x =
+			referenceFilter(capture.data(), chn, c);
+		long double mean = 0;
+
+		for (long double v : x) {
+			mean += v;
+		}
+		mean /= x.size();
+
+		const double dc_error = std::fabs(dft.dc(chn) - mean) /
+			std::max(1.0L, std::fabs(mean));
+
+		worst.dc = std::max(worst.dc, dc_error);
+		if (!(dc_error <= tolerance)) {
+			failures++;
+			printf("%zu samples, channel %u: dc %.17g instead of %.17Lg\n",
+			       c.length, chn, dft.dc(chn), mean);
+		}
+
+		for (size_t tone = 0; tone < c.frequencies.size(); tone++) {
+			const cld ref = referenceBin(x, c.frequencies[tone],
+						     c.sample_rate, c.remove_dc);
+			const cld bin(dft.bin(chn, tone).real(),
+				      dft.bin(chn, tone).imag());
+			const double mag_db = std::fabs(20 * log10l(std::abs(bin) /
+							std::abs(ref)));
+			const double phase = std::fabs(std::arg(bin * std::conj(ref)));
+
+			worst.mag_db = std::max(worst.mag_db, mag_db);
+			worst.phase = std::max(worst.phase, phase);
+
+			// Relative to the magnitude, the error is about the
+			// same as the dB and phase errors in natural units
+			if (!(mag_db / 8.686 <= tolerance && phase <= tolerance)) {
+				failures++;
+				printf("%zu samples, channel %u, %g Hz: %.3g dB, "
+				       "%.3g rad off\n", c.length, chn,
+				       c.frequencies[tone], mag_db, phase);
+			}
+		}
+
+		// The samples shown in the buffer preview
+		std::vector<float> samples;
+
+		dft.samples(capture.data(), chn, 1.0, samples);
+
+		for (size_t i = 0; i < c.length; i++) {
+			const long double expected = x[i] - (c.remove_dc ? mean : 0);
+			const double error = std::fabs(samples[i] - expected) / 2048;
+
+			worst.samples = std::max(worst.samples, error);
+		}
+	}
+
+	return failures;
+}
+
+int main()
+{
+	const Compensation off = { false, 0, 0 };
+	const Compensation stage1 = { true, 2.5, 0.03 };
+	const Compensation stage2 = { true, 0.6, -0.012 };
+	const size_t lengths[] = { 3, 64, 1021, 4096, 65536, 1 << 17 };
+	std::mt19937 gen(1);
+	int failures = 0;
+
+	for (bool compensated : { false, true }) {
+		// The compensation runs in float, as in the block, and the
+		// rest in double
+		const double tolerance = compensated ? 1e-6 : 1e-12;
+		Errors worst;
+
+		for (size_t length : lengths) {
+			for (bool remove_dc : { false, true }) {
+				const double rate = 1e6;
+				Case c;
+
+				c.sample_rate = rate;
+				c.length = length;
+				c.remove_dc = remove_dc;
+				c.stages[0][0] = compensated ? stage1 : off;
+				c.stages[0][1] = compensated ? stage2 : off;
+				c.stages[1][0] = compensated ? stage2 : off;
+				c.stages[1][1] = off;
+
+				// A single tone, in the network analyzer at the
+				// frequency that fits the buffer, and anywhere
+				for (double periods : { 1.0, 7.0, 0.37 * length }) {
+					c.frequencies = { periods * rate / length };
+					failures += checkCase(c, gen, worst, tolerance);
+				}
+
+				// A multisine: whole numbers of periods, more
+				// tones than lanes
+				c.frequencies.clear();
+				for (size_t k = 1; k <= 7 && k < length / 2; k++) {
+					c.frequencies.push_back(k * k * rate / length);
+				}
+				if (!c.frequencies.empty()) {
+					failures += checkCase(c, gen, worst, tolerance);
+				}
+			}
+		}
+
+		printf("%s: worst error %.3g dB, %.3g rad, dc %.3g, samples "
+		       "%.3g of full scale\n",
+		       compensated ? "compensated" : "not compensated",
+		       worst.mag_db, worst.phase, worst.dc, worst.samples);
+
+		// The samples go out as float, and are compensated in float
+		if (worst.samples > 1e-6) {
+			failures++;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
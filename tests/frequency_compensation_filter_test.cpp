@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * frequency_compensation_filter against the block it replaced, and its
+ * output when the stream is split over many work() calls against the
+ * output of a single call. Also times both blocks.
+ *
+ *   frequency_compensation_filter_test [samples]
+ */
+
+#include "frequency_compensation_filter_impl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace adiscope;
+
+static const float TC = 2.5;
+static const float GAIN = 0.3;
+static const float SAMPLE_RATE = 100e6;
+
+/*
+ * The work() of the previous block. It restarted the filter on every call
+ * from the difference of the first two inputs.
+ */
+static int oldWork(int noutput_items, const short *in, short *out)
+{
+	float *out_f = new float[noutput_items];
+
+	float delta = 1.0 / SAMPLE_RATE;
+	float TC1 = TC * float(1.0E-6);
+	float Alpha = TC1/(TC1+delta);
+	out_f[0]=(in[1]-in[0]);
+	int i = 1;
+
+	for (i = 1; i < noutput_items; i++) {
+		out_f[i]=(Alpha*(out_f[i-1]+(float)(in[i]-in[i-1])));
+	}
+
+	for (i = 0; i < noutput_items; i++) {
+		out[i]=in[i]+(short)((out_f[i])*GAIN);
+	}
+
+	delete []out_f;
+	return noutput_items;
+}
+
+static void newWork(frequency_compensation_filter_impl &filter,
+		    const short *in, short *out, size_t count, size_t chunk)
+{
+	gr_vector_const_void_star input_items(1);
+	gr_vector_void_star output_items(1);
+
+	filter.start();
+
+	for (size_t done = 0; done < count; ) {
+		size_t n = std::min(chunk, count - done);
+
+		input_items[0] = in + done;
+		output_items[0] = out + done;
+		done += filter.work(n, input_items, output_items);
+	}
+}
+
+/*
+ * A 12 bit square wave with noise, the kind of signal the filter
+ * compensates. The first two samples are equal so both blocks start the
+ * filter from rest.
+ */
+static std::vector<short> makeInput(size_t count)
+{
+	std::mt19937 gen(1);
+	std::uniform_int_distribution<int> noise(-20, 20);
+	std::vector<short> in(count);
+
+	for (size_t i = 0; i < count; i++) {
+		in[i] = ((i / 5000) % 2 ? 1500 : -1500) + noise(gen);
+	}
+
+	in[1] = in[0];
+
+	return in;
+}
+
+static size_t countDifferences(const std::vector<short> &a,
+			       const std::vector<short> &b, const char *what)
+{
+	size_t diffs = 0;
+
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i] != b[i] && diffs++ < 10) {
+			printf("%s, sample %zu: %d instead of %d\n",
+			       what, i, b[i], a[i]);
+		}
+	}
+
+	printf("%s: %zu of %zu samples differ\n", what, diffs, a.size());
+
+	return diffs;
+}
+
+template <typename F>
+static double samplesPerSecond(size_t count, F run)
+{
+	auto start = std::chrono::steady_clock::now();
+	run();
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+
+	return count / elapsed.count();
+}
+
+int main(int argc, char **argv)
+{
+	const size_t count = argc > 1 ? strtoul(argv[1], nullptr, 0) : 1 << 22;
+	const std::vector<short> in = makeInput(count);
+	std::vector<short> reference(count), out(count);
+	size_t failures = 0;
+
+	frequency_compensation_filter_impl filter(true, TC, GAIN, SAMPLE_RATE);
+
+	// In a single call the new block computes what the old one did
+	oldWork(count, in.data(), reference.data());
+	newWork(filter, in.data(), out.data(), count, count);
+	failures += countDifferences(reference, out, "single call vs old block");
+
+	// Split over calls of any size, the output is that of a single call
+	reference = out;
+
+	for (size_t chunk : { 1, 2, 3, 7, 64, 1000, 4096, 8191 }) {
+		char what[64];
+
+		std::fill(out.begin(), out.end(), 0);
+		newWork(filter, in.data(), out.data(), count, chunk);
+		snprintf(what, sizeof(what), "calls of %zu vs single call", chunk);
+		failures += countDifferences(reference, out, what);
+	}
+
+	// Disabled, the block passes the input through
+	filter.set_enable(false, 2);
+	newWork(filter, in.data(), out.data(), count, 4096);
+	failures += countDifferences(in, out, "disabled vs input");
+	filter.set_enable(true, 2);
+
+	// Throughput, in the buffer sizes the scheduler usually hands out
+	const size_t chunk = 8192;
+
+	double oldRate = samplesPerSecond(count, [&]() {
+		for (size_t done = 0; done + chunk <= count; done += chunk) {
+			oldWork(chunk, &in[done], &reference[done]);
+		}
+	});
+	double newRate = samplesPerSecond(count, [&]() {
+		newWork(filter, in.data(), out.data(), count, chunk);
+	});
+
+	printf("old block: %.1f Msps, new block: %.1f Msps (x%.2f)\n",
+	       oldRate / 1e6, newRate / 1e6, newRate / oldRate);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2020 Analog Devices Inc.
+ *
+ * This file is part of Scopy
+ * (see http://www.github.com/analogdevicesinc/scopy).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SpectrumMagnitude against the per bin formulas the spectrum analyzer
+ * used before, for all the magnitude types, and simd::log10 against
+ * std::log10, including the lanes it hands over to std::log10.
+ */
+
+#include "spectrum_magnitude.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace adiscope;
+
+/* Bins converted in one go by FftDisplayPlot */
+static const uint64_t BLOCK_BINS = 2048;
+
+static const char *typeName(SpectrumMagnitude::Type type)
+{
+	static const char *names[] = { "dBFS", "dBV", "dBu", "Vpeak", "Vrms",
+				       "V/sqrt(Hz)" };
+
+	return names[type];
+}
+
+/*
+ * The conversion as FftDisplayPlot did it, a bin at a time, for the
+ * buffer buffer_idx of nb_overlapping.
+ */
+static void referenceConvert(SpectrumMagnitude::Type type, const double *in,
+			     double *out, std::vector<double> &ps_avg,
+			     int nb_points, double scale_factor,
+			     double sampl_rate, double win_sum,
+			     double win_sum_sqr, unsigned int buffer_idx,
+			     unsigned int nb_overlapping)
+{
+	for (int s = 0; s < nb_points; s++) {
+		switch (type) {
+		case SpectrumMagnitude::DBFS:
+			out[s] = 10 * log10((in[s] / (2048 * 2048)) /
+				(nb_points * nb_points));
+			break;
+		case SpectrumMagnitude::DBV:
+			out[s] = 10 * log10(in[s]) +
+				20 * log10(scale_factor) -
+				20 * log10(nb_points) -
+				20 * log10(sqrt(2));
+			break;
+		case SpectrumMagnitude::DBU:
+			out[s] = 10 * log10(in[s]) +
+				20 * log10(scale_factor) -
+				20 * log10(nb_points) -
+				20 * log10(sqrt(2) * 0.77459667);
+			break;
+		case SpectrumMagnitude::VPEAK:
+			out[s] = sqrt(in[s]) * scale_factor / nb_points;
+			break;
+		case SpectrumMagnitude::VRMS:
+			out[s] = sqrt(in[s]) * scale_factor / sqrt(2) / nb_points;
+			break;
+		case SpectrumMagnitude::VROOTHZ:
+			auto ps_rms = sqrt(in[s]) * scale_factor / sqrt(2) / nb_points;
+			ps_avg[s] = sqrt((ps_avg[s] * ps_avg[s]) + (ps_rms * ps_rms));
+
+			if (buffer_idx == (nb_overlapping - 1)) {
+				ps_avg[s] = ps_avg[s] / sqrt(nb_overlapping);
+				auto ls_rms = ps_avg[s];
+				auto enbw = sampl_rate * win_sum_sqr /
+						(win_sum * win_sum);
+				auto ls_d_rms = ls_rms / sqrt(enbw);
+				out[s] = ls_d_rms;
+			}
+			break;
+		};
+	}
+}
+
+/* Distance in units in the last place, for finite values of one sign */
+static double ulps(double value, double expected)
+{
+	if (value == expected || (std::isnan(value) && std::isnan(expected))) {
+		return 0;
+	}
+	if (!std::isfinite(value) || !std::isfinite(expected)) {
+		return std::numeric_limits<double>::infinity();
+	}
+
+	const double ulp = std::nextafter(std::fabs(expected), INFINITY) -
+		std::fabs(expected);
+
+	return std::fabs(value - expected) / ulp;
+}
+
+/*
+ * Bin powers of an FFT of 12 bit codes: from full scale down to well below
+ * the noise floor of any window, with some empty bins.
+ */
+static std::vector<double> makePowers(std::mt19937 &gen, int nb_points)
+{
+	std::uniform_real_distribution<double> exponent(-30, 0);
+	std::vector<double> power(nb_points);
+	const double full_scale = 2048.0 * nb_points;
+
+	for (int s = 0; s < nb_points; s++) {
+		power[s] = s % 97 ? full_scale * full_scale *
+			std::pow(10.0, exponent(gen)) : 0.0;
+	}
+
+	return power;
+}
+
+static int checkType(SpectrumMagnitude::Type type, int nb_points)
+{
+	const double scale_factor = 2 * 25.0 / 4096 * 1.013;
+	const double sampl_rate = 100e6 / 16;
+	const double win_sum = 0.3635819 * nb_points;
+	const double win_sum_sqr = 0.2557236 * nb_points;
+	const unsigned int nb_overlapping =
+		type == SpectrumMagnitude::VROOTHZ ? 3 : 1;
+
+	/*
+	 * dB values are compared absolutely: the old formula divides before
+	 * taking the logarithm and rounds differently. Amplitudes are within
+	 * a few ulp of the old value.
+	 */
+	const bool db = type <= SpectrumMagnitude::DBU;
+	const double tolerance = db ? 1e-12 : 8;
+
+	std::mt19937 gen(type);
+	std::vector<double> out(nb_points), expected(nb_points);
+	std::vector<double> ps_avg(nb_points), ref_ps_avg(nb_points);
+
+	SpectrumMagnitude magnitude(type, nb_points, scale_factor);
+	magnitude.setDensity(sampl_rate, win_sum, win_sum_sqr);
+
+	for (unsigned int buffer = 0; buffer < nb_overlapping; buffer++) {
+		const std::vector<double> power = makePowers(gen, nb_points);
+
+		for (uint64_t first = 0; first < uint64_t(nb_points);
+		     first += BLOCK_BINS) {
+			const uint64_t count = std::min<uint64_t>(
+				nb_points - first, BLOCK_BINS);
+
+			magnitude.convert(power.data() + first, out.data() + first,
+					  count, ps_avg.data() + first, buffer,
+					  nb_overlapping);
+		}
+
+		referenceConvert(type, power.data(), expected.data(), ref_ps_avg,
+				 nb_points, scale_factor, sampl_rate, win_sum,
+				 win_sum_sqr, buffer, nb_overlapping);
+	}
+
+	double worst = 0;
+	int failures = 0;
+
+	for (int s = 0; s < nb_points; s++) {
+		double error = db ? std::fabs(out[s] - expected[s]) :
+			ulps(out[s], expected[s]);
+
+		if (db && out[s] == expected[s]) {
+			error = 0;
+		}
+		if (std::isnan(error) || error > tolerance) {
+			if (failures++ < 10) {
+				printf("%s, %d points, bin %d: %.17g instead of %.17g\n",
+				       typeName(type), nb_points, s, out[s],
+				       expected[s]);
+			}
+			continue;
+		}
+
+		worst = std::max(worst, error);
+	}
+
+	printf("%s, %d points: worst error %.3g %s, %d wrong\n",
+	       typeName(type), nb_points, worst, db ? "dB" : "ulp", failures);
+
+	return failures;
+}
+
+/*
+ * Every special value in every lane, next to ordinary values in the
+ * others, and then ordinary values over the whole range of exponents. The
+ * result may be 4 ulp off.
+ */
+static int checkLog10()
+{
+	const double specials[] = {
+		0.0, -0.0, -1.0, -DBL_MAX, -INFINITY,
+		std::numeric_limits<double>::denorm_min(),
+		DBL_MIN / 2, std::nextafter(DBL_MIN, 0.0),
+		INFINITY, std::numeric_limits<double>::quiet_NaN(),
+		-std::numeric_limits<double>::quiet_NaN(),
+		DBL_MIN, DBL_MAX,
+	};
+	const double ordinary[simd::LANES] = { 1.0, 0.1, 3.7e-200, 42e150 };
+
+	std::mt19937 gen(1);
+	std::uniform_real_distribution<double> mantissa(1, 2);
+	std::uniform_int_distribution<int> exponent(DBL_MIN_EXP - 1,
+						    DBL_MAX_EXP - 1);
+	double worst = 0;
+	int failures = 0;
+
+	auto check = [&](const simd::v4df &x) {
+		const simd::v4df r = simd::log10(x);
+
+		for (unsigned int l = 0; l < simd::LANES; l++) {
+			const double expected = std::log10(x[l]);
+			const double error = ulps(r[l], expected);
+
+			if (error > 4) {
+				if (failures++ < 10) {
+					printf("log10(%.17g): %.17g instead of %.17g\n",
+					       x[l], r[l], expected);
+				}
+				continue;
+			}
+
+			worst = std::max(worst, error);
+		}
+	};
+
+	for (double special : specials) {
+		for (unsigned int lane = 0; lane < simd::LANES; lane++) {
+			simd::v4df x = simd::load(ordinary);
+
+			x[lane] = special;
+			check(x);
+		}
+
+		check(simd::broadcast(special));
+	}
+
+	// Around 1 the result is small and the terms for the exponent and
+	// the mantissa cancel, so it gets as many values as the rest
+	for (int i = 0; i < 1000000; i++) {
+		simd::v4df x;
+
+		for (unsigned int l = 0; l < simd::LANES; l++) {
+			x[l] = std::ldexp(mantissa(gen),
+					  i % 2 ? exponent(gen) : int(l % 2) - 1);
+		}
+
+		check(x);
+	}
+
+	printf("simd::log10: worst error %.3g ulp, %d wrong\n", worst, failures);
+
+	return failures;
+}
+
+int main()
+{
+	int failures = 0;
+
+	for (int type = SpectrumMagnitude::DBFS;
+	     type <= SpectrumMagnitude::VROOTHZ; type++) {
+		// A whole number of blocks, and a last block that is not a
+		// multiple of the SIMD width
+		for (int nb_points : { 8192, 5003 }) {
+			failures += checkType(
+				static_cast<SpectrumMagnitude::Type>(type),
+				nb_points);
+		}
+	}
+
+	failures += checkLog10();
+
+	return failures ? 1 : 0;
+}
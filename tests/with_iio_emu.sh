@@ -0,0 +1,22 @@
+#!/bin/sh
+#
+# Runs a test against an ADALM2000 emulated by iio-emu:
+#   with_iio_emu.sh <iio-emu> <test> [args...]
+# Exits with 77 (skipped) when the emulator is not available.
+
+emu="$1"
+shift
+
+if [ ! -x "$emu" ]; then
+	echo "iio-emu not found, skipping"
+	exit 77
+fi
+
+"$emu" adalm2000 >/dev/null 2>&1 &
+pid=$!
+trap 'kill $pid 2>/dev/null' EXIT
+
+# Give the emulator time to start listening
+sleep 1
+
+"$@"